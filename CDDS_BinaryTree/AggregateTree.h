@@ -0,0 +1,235 @@
+#pragma once
+#include <limits>
+#include "BinaryTree.h"
+#include "TreeNode.h"
+
+/// <summary>
+/// Adds values together. An empty range sums to zero
+/// </summary>
+template<typename T>
+struct SumMonoid
+{
+	typedef T Type;
+	static T identity() { return T(); }
+	static T combine(const T& lhs, const T& rhs) { return lhs + rhs; }
+};
+
+/// <summary>
+/// Keeps the smallest value. An empty range gives the largest possible value
+/// </summary>
+template<typename T>
+struct MinMonoid
+{
+	typedef T Type;
+	static T identity() { return std::numeric_limits<T>::max(); }
+	static T combine(const T& lhs, const T& rhs) { return rhs < lhs ? rhs : lhs; }
+};
+
+/// <summary>
+/// Keeps the largest value. An empty range gives the smallest possible value
+/// </summary>
+template<typename T>
+struct MaxMonoid
+{
+	typedef T Type;
+	static T identity() { return std::numeric_limits<T>::lowest(); }
+	static T combine(const T& lhs, const T& rhs) { return lhs < rhs ? rhs : lhs; }
+};
+
+/// <summary>
+/// A value and the combined aggregate of every value in the subtree of the node storing it.
+/// Entries are ordered by their value only
+/// </summary>
+template<typename T, typename A>
+struct AggregateEntry
+{
+	AggregateEntry(T entryValue) : value(entryValue), aggregate() {}
+
+	T value;
+	//Not part of the order, so the tree refreshes it in place while the entry sits in a node
+	mutable A aggregate;
+};
+
+template<typename T, typename A>
+inline bool operator<(const AggregateEntry<T, A>& lhs, const AggregateEntry<T, A>& rhs) { return lhs.value < rhs.value; }
+template<typename T, typename A>
+inline bool operator>(const AggregateEntry<T, A>& lhs, const AggregateEntry<T, A>& rhs) { return rhs.value < lhs.value; }
+template<typename T, typename A>
+inline bool operator==(const AggregateEntry<T, A>& lhs, const AggregateEntry<T, A>& rhs) { return !(lhs < rhs) && !(rhs < lhs); }
+template<typename T, typename A>
+inline bool operator!=(const AggregateEntry<T, A>& lhs, const AggregateEntry<T, A>& rhs) { return !(lhs == rhs); }
+
+/// <summary>
+/// A tree that keeps the aggregate of every subtree so ranges can be reduced without visiting every node.
+/// The monoid provides the aggregate Type, an identity() and an associative combine(lhs, rhs).
+/// Each value adds Type(value) to the aggregate
+/// </summary>
+template<typename T, typename Monoid>
+class AggregateTree : public BinaryTree<AggregateEntry<T, typename Monoid::Type>>
+{
+public:
+	typedef typename Monoid::Type Aggregate;
+	typedef AggregateEntry<T, Aggregate> Entry;
+
+	/// <summary>
+	/// Creates a tree that either ignores duplicate values or counts them
+	/// </summary>
+	/// <param name="isMultiset">Whether inserting a value that is already in the tree should add another copy of it</param>
+	explicit AggregateTree(bool isMultiset = false);
+	/// <summary>
+	/// Creates a separate copy of every node in the tree, along with the aggregate kept for each subtree
+	/// </summary>
+	/// <returns>A new aggregate tree with the same shape and values, without a log or find cache</returns>
+	AggregateTree<T, Monoid> clone() const;
+
+	/// <summary>
+	/// Adds the value to the tree
+	/// </summary>
+	/// <param name="value">The new value to add to the tree</param>
+	void insert(T value);
+	/// <summary>
+	/// Removes the value from the tree
+	/// </summary>
+	/// <param name="value">The value to remove from the tree</param>
+	void remove(T value);
+
+	/// <summary>
+	/// Returns the aggregate of every value in the tree
+	/// </summary>
+	Aggregate aggregate() const;
+	/// <summary>
+	/// Returns the aggregate of every value between the given ends, including the ends.
+	/// Only the two paths leading to the ends are visited
+	/// </summary>
+	/// <param name="low">The smallest value to include</param>
+	/// <param name="high">The largest value to include</param>
+	Aggregate rangeAggregate(T low, T high) const;
+
+protected:
+	/// <summary>
+	/// Recalculates the aggregate of the node's subtree from its children
+	/// </summary>
+	void updateNode(TreeNode<Entry>* node) override;
+
+private:
+	/// <summary>
+	/// Returns the aggregate of the subtree under the node, or the identity if there is no node
+	/// </summary>
+	static Aggregate subtreeAggregate(TreeNode<Entry>* node);
+	/// <summary>
+	/// Returns the aggregate of every copy of the node's value
+	/// </summary>
+	static Aggregate nodeAggregate(TreeNode<Entry>* node);
+};
+
+template<typename T, typename Monoid>
+inline AggregateTree<T, Monoid>::AggregateTree(bool isMultiset) : BinaryTree<Entry>(isMultiset)
+{
+	this->m_isAugmented = true;
+}
+
+template<typename T, typename Monoid>
+inline AggregateTree<T, Monoid> AggregateTree<T, Monoid>::clone() const
+{
+	AggregateTree<T, Monoid> copy(this->isMultiset());
+	this->cloneInto(copy);
+	return copy;
+}
+
+template<typename T, typename Monoid>
+inline void AggregateTree<T, Monoid>::insert(T value)
+{
+	BinaryTree<Entry>::insert(Entry(value));
+}
+
+template<typename T, typename Monoid>
+inline void AggregateTree<T, Monoid>::remove(T value)
+{
+	BinaryTree<Entry>::remove(Entry(value));
+}
+
+template<typename T, typename Monoid>
+inline typename AggregateTree<T, Monoid>::Aggregate AggregateTree<T, Monoid>::aggregate() const
+{
+	return subtreeAggregate(this->getRoot());
+}
+
+template<typename T, typename Monoid>
+inline typename AggregateTree<T, Monoid>::Aggregate AggregateTree<T, Monoid>::rangeAggregate(T low, T high) const
+{
+	//Finds the highest node inside the range, where the paths to both ends split apart
+	TreeNode<Entry>* splitNode = this->getRoot();
+	while (splitNode)
+	{
+		if (splitNode->getData().value < low)
+			splitNode = splitNode->getRight();
+		else if (high < splitNode->getData().value)
+			splitNode = splitNode->getLeft();
+		else
+			break;
+	}
+
+	//Return the identity if no value is in the range
+	if (!splitNode)
+		return Monoid::identity();
+
+	//Walks toward the low end, adding every node in the range and everything to its right.
+	//Each of those is smaller than what was already added, so it is combined on the left
+	Aggregate lowSide = Monoid::identity();
+	TreeNode<Entry>* currentNode = splitNode->getLeft();
+	while (currentNode)
+	{
+		if (currentNode->getData().value < low)
+			currentNode = currentNode->getRight();
+		else
+		{
+			lowSide = Monoid::combine(Monoid::combine(nodeAggregate(currentNode), subtreeAggregate(currentNode->getRight())), lowSide);
+			currentNode = currentNode->getLeft();
+		}
+	}
+
+	//Walks toward the high end, adding every node in the range and everything to its left
+	Aggregate highSide = Monoid::identity();
+	currentNode = splitNode->getRight();
+	while (currentNode)
+	{
+		if (high < currentNode->getData().value)
+			currentNode = currentNode->getLeft();
+		else
+		{
+			highSide = Monoid::combine(highSide, Monoid::combine(subtreeAggregate(currentNode->getLeft()), nodeAggregate(currentNode)));
+			currentNode = currentNode->getRight();
+		}
+	}
+
+	return Monoid::combine(lowSide, Monoid::combine(nodeAggregate(splitNode), highSide));
+}
+
+template<typename T, typename Monoid>
+inline void AggregateTree<T, Monoid>::updateNode(TreeNode<Entry>* node)
+{
+	node->getData().aggregate = Monoid::combine(Monoid::combine(subtreeAggregate(node->getLeft()), nodeAggregate(node)), subtreeAggregate(node->getRight()));
+}
+
+template<typename T, typename Monoid>
+inline typename AggregateTree<T, Monoid>::Aggregate AggregateTree<T, Monoid>::subtreeAggregate(TreeNode<Entry>* node)
+{
+	return node ? node->getData().aggregate : Monoid::identity();
+}
+
+template<typename T, typename Monoid>
+inline typename AggregateTree<T, Monoid>::Aggregate AggregateTree<T, Monoid>::nodeAggregate(TreeNode<Entry>* node)
+{
+	//Combines the value with itself once per copy, doubling each step so large counts stay cheap
+	Aggregate result = Monoid::identity();
+	Aggregate power = Aggregate(node->getData().value);
+	unsigned int count = node->getCount();
+	while (count > 0)
+	{
+		if (count & 1)
+			result = Monoid::combine(result, power);
+		power = Monoid::combine(power, power);
+		count >>= 1;
+	}
+	return result;
+}
@@ -0,0 +1,385 @@
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+static_assert(std::is_trivially_copyable<BenchmarkMeasurements>::value, "Measurements are copied between processes as bytes");
+
+volatile uint64_t BenchmarkSink::s_value = 0;
+
+std::string BenchmarkResult::getName() const
+{
+	return operation + "/" + container + "/" + valueType + "/" + distribution + "/" + std::to_string(size);
+}
+
+CacheMissCounter::CacheMissCounter()
+{
+#ifdef __linux__
+	perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+	attributes.disabled = 1;
+	//Only the benchmark's own code is counted, which is also all that unprivileged processes are usually allowed
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	m_descriptor = (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+}
+
+CacheMissCounter::~CacheMissCounter()
+{
+#ifdef __linux__
+	if (m_descriptor >= 0)
+		close(m_descriptor);
+#endif
+}
+
+bool CacheMissCounter::isAvailable() const
+{
+	return m_descriptor >= 0;
+}
+
+void CacheMissCounter::start()
+{
+#ifdef __linux__
+	if (m_descriptor >= 0)
+		ioctl(m_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+void CacheMissCounter::stop()
+{
+#ifdef __linux__
+	if (m_descriptor >= 0)
+		ioctl(m_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
+
+uint64_t CacheMissCounter::read() const
+{
+	uint64_t count = 0;
+#ifdef __linux__
+	if (m_descriptor >= 0 && ::read(m_descriptor, &count, sizeof(count)) != (ssize_t)sizeof(count))
+		count = 0;
+#endif
+	return count;
+}
+
+BenchmarkTimer::BenchmarkTimer(double minimumSeconds, double limitSeconds) : m_minimumSeconds(minimumSeconds), m_limitSeconds(limitSeconds)
+{
+	m_clockOverhead = measureClockOverhead();
+}
+
+bool BenchmarkTimer::needsAnotherPass() const
+{
+	return !m_isTruncated && m_realSeconds < m_minimumSeconds;
+}
+
+void BenchmarkTimer::startPass()
+{
+	m_passOperations = 0;
+	m_passCpuStart = std::clock();
+	m_cacheMisses.start();
+	m_passStart = std::chrono::steady_clock::now();
+}
+
+bool BenchmarkTimer::countOperation()
+{
+	m_passOperations++;
+	if (m_passOperations % CLOCK_CHECK_INTERVAL != 0)
+		return false;
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_passStart;
+	if (elapsed.count() < m_limitSeconds)
+		return false;
+
+	m_isTruncated = true;
+	return true;
+}
+
+void BenchmarkTimer::countOperations(uint64_t count)
+{
+	m_passOperations += count;
+}
+
+void BenchmarkTimer::stopPass()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_passStart;
+	m_cacheMisses.stop();
+	m_realSeconds += elapsed.count();
+	m_cpuSeconds += (double)(std::clock() - m_passCpuStart) / CLOCKS_PER_SEC;
+	m_operations += m_passOperations;
+}
+
+BenchmarkMeasurements BenchmarkTimer::getMeasurements() const
+{
+	BenchmarkMeasurements measurements;
+	measurements.operations = m_operations;
+	measurements.realSeconds = m_realSeconds;
+	measurements.cpuSeconds = m_cpuSeconds;
+	measurements.isTruncated = m_isTruncated;
+
+	if (!m_samples.empty())
+	{
+		//Only two ranks are needed, so the samples are partitioned rather than sorted
+		std::vector<uint32_t> samples = m_samples;
+		size_t p50Rank = (samples.size() - 1) / 2;
+		size_t p99Rank = (samples.size() - 1) * 99 / 100;
+		std::nth_element(samples.begin(), samples.begin() + p99Rank, samples.end());
+		measurements.p99Nanoseconds = samples[p99Rank];
+		std::nth_element(samples.begin(), samples.begin() + p50Rank, samples.begin() + p99Rank);
+		measurements.p50Nanoseconds = samples[p50Rank];
+		measurements.hasLatency = true;
+	}
+
+	if (m_cacheMisses.isAvailable())
+	{
+		measurements.cacheMisses = m_cacheMisses.read();
+		measurements.hasCacheMisses = true;
+	}
+
+	return measurements;
+}
+
+void BenchmarkTimer::addSample(std::chrono::steady_clock::duration elapsed)
+{
+	if (m_samples.size() >= MAX_SAMPLES)
+		return;
+
+	if (m_samples.empty())
+		m_samples.reserve(MAX_SAMPLES);
+
+	elapsed = elapsed > m_clockOverhead ? elapsed - m_clockOverhead : std::chrono::steady_clock::duration::zero();
+	uint64_t nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	m_samples.push_back(nanoseconds > UINT32_MAX ? UINT32_MAX : (uint32_t)nanoseconds);
+}
+
+std::chrono::steady_clock::duration BenchmarkTimer::measureClockOverhead()
+{
+	//The shortest of many tries is the cost of the clock itself, without any interruptions
+	std::chrono::steady_clock::duration shortest = std::chrono::steady_clock::duration::max();
+	for (int i = 0; i < 1000; i++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+		shortest = std::min(shortest, elapsed);
+	}
+	return shortest;
+}
+
+bool BenchmarkIsolation::run(const std::function<BenchmarkMeasurements()>& runCase, BenchmarkMeasurements& measurements)
+{
+#ifdef _WIN32
+	measurements = runCase();
+	return true;
+#else
+	//Anything still buffered would otherwise be written by both processes
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(nullptr);
+
+	int pipeEnds[2];
+	if (pipe(pipeEnds) != 0)
+	{
+		measurements = runCase();
+		return true;
+	}
+
+	pid_t child = fork();
+	if (child < 0)
+	{
+		close(pipeEnds[0]);
+		close(pipeEnds[1]);
+		measurements = runCase();
+		return true;
+	}
+
+	if (child == 0)
+	{
+		close(pipeEnds[0]);
+		BenchmarkMeasurements childMeasurements = runCase();
+
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0)
+		{
+#ifdef __APPLE__
+			childMeasurements.peakRssBytes = (uint64_t)usage.ru_maxrss;
+#else
+			childMeasurements.peakRssBytes = (uint64_t)usage.ru_maxrss * 1024;
+#endif
+			childMeasurements.hasPeakRss = true;
+		}
+
+		const char* bytes = (const char*)&childMeasurements;
+		size_t written = 0;
+		while (written < sizeof(childMeasurements))
+		{
+			ssize_t count = write(pipeEnds[1], bytes + written, sizeof(childMeasurements) - written);
+			if (count <= 0)
+				_exit(1);
+			written += (size_t)count;
+		}
+		//Exits without running destructors or flushing streams, which belong to the parent
+		_exit(0);
+	}
+
+	close(pipeEnds[1]);
+	char* bytes = (char*)&measurements;
+	size_t bytesRead = 0;
+	while (bytesRead < sizeof(measurements))
+	{
+		ssize_t count = read(pipeEnds[0], bytes + bytesRead, sizeof(measurements) - bytesRead);
+		if (count <= 0)
+			break;
+		bytesRead += (size_t)count;
+	}
+	close(pipeEnds[0]);
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	return bytesRead == sizeof(measurements) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+void BenchmarkSink::consume(uint64_t value)
+{
+	s_value = s_value + value;
+}
+
+void BenchmarkReport::add(const BenchmarkResult& result)
+{
+	m_results.push_back(result);
+}
+
+const std::vector<BenchmarkResult>& BenchmarkReport::getResults() const
+{
+	return m_results;
+}
+
+void BenchmarkReport::write(std::ostream& stream, const std::string& executable) const
+{
+	//Describes the machine, since results from different machines can't be compared
+	char date[64] = "";
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	char hostName[256] = "";
+	gethostname(hostName, sizeof(hostName) - 1);
+
+#ifdef NDEBUG
+	const char* buildType = "release";
+#else
+	const char* buildType = "debug";
+#endif
+
+	stream << "{\n";
+	stream << "  \"context\": {\n";
+	stream << "    \"date\": \"" << date << "\",\n";
+	stream << "    \"host_name\": \"" << escape(hostName) << "\",\n";
+	stream << "    \"executable\": \"" << escape(executable) << "\",\n";
+	stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+	stream << "    \"library_build_type\": \"" << buildType << "\"\n";
+	stream << "  },\n";
+	stream << "  \"benchmarks\": [";
+
+	for (size_t i = 0; i < m_results.size(); i++)
+	{
+		const BenchmarkResult& result = m_results[i];
+		const BenchmarkMeasurements& measured = result.measurements;
+		double operations = measured.operations > 0 ? (double)measured.operations : 1.0;
+		double itemsPerSecond = measured.realSeconds > 0.0 ? (double)measured.operations / measured.realSeconds : 0.0;
+
+		stream << (i == 0 ? "\n" : ",\n");
+		stream << "    {\n";
+		stream << "      \"name\": \"" << escape(result.getName()) << "\",\n";
+		stream << "      \"run_name\": \"" << escape(result.getName()) << "\",\n";
+		stream << "      \"run_type\": \"iteration\",\n";
+		stream << "      \"repetitions\": 1,\n";
+		stream << "      \"repetition_index\": 0,\n";
+		stream << "      \"threads\": 1,\n";
+		stream << "      \"iterations\": " << measured.operations << ",\n";
+		stream << "      \"real_time\": " << measured.realSeconds * 1e9 / operations << ",\n";
+		stream << "      \"cpu_time\": " << measured.cpuSeconds * 1e9 / operations << ",\n";
+		stream << "      \"time_unit\": \"ns\",\n";
+		stream << "      \"items_per_second\": " << itemsPerSecond << ",\n";
+		stream << "      \"operation\": \"" << escape(result.operation) << "\",\n";
+		stream << "      \"container\": \"" << escape(result.container) << "\",\n";
+		stream << "      \"value_type\": \"" << escape(result.valueType) << "\",\n";
+		stream << "      \"distribution\": \"" << escape(result.distribution) << "\",\n";
+		stream << "      \"size\": " << result.size << ",\n";
+		//Measurements that couldn't be taken are written as null rather than left out, so every entry has the same fields
+		stream << "      \"p50_ns\": ";
+		writeOptional(stream, measured.hasLatency, measured.p50Nanoseconds);
+		stream << ",\n      \"p99_ns\": ";
+		writeOptional(stream, measured.hasLatency, measured.p99Nanoseconds);
+		stream << ",\n      \"peak_rss_bytes\": ";
+		writeOptional(stream, measured.hasPeakRss, measured.peakRssBytes);
+		stream << ",\n      \"cache_misses\": ";
+		writeOptional(stream, measured.hasCacheMisses, measured.cacheMisses);
+		stream << ",\n      \"cache_misses_per_item\": ";
+		writeOptional(stream, measured.hasCacheMisses, (double)measured.cacheMisses / operations);
+		stream << ",\n";
+		stream << "      \"truncated\": " << (measured.isTruncated ? "true" : "false") << "\n";
+		stream << "    }";
+	}
+
+	stream << "\n  ]\n";
+	stream << "}\n";
+}
+
+void BenchmarkReport::writeOptional(std::ostream& stream, bool hasValue, double value)
+{
+	if (hasValue)
+		stream << value;
+	else
+		stream << "null";
+}
+
+void BenchmarkReport::writeOptional(std::ostream& stream, bool hasValue, uint64_t value)
+{
+	if (hasValue)
+		stream << value;
+	else
+		stream << "null";
+}
+
+std::string BenchmarkReport::escape(const std::string& text)
+{
+	std::string escaped;
+	for (char character : text)
+	{
+		if (character == '"' || character == '\\')
+		{
+			escaped += '\\';
+			escaped += character;
+		}
+		else if ((unsigned char)character < 0x20)
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)(unsigned char)character);
+			escaped += buffer;
+		}
+		else
+			escaped += character;
+	}
+	return escaped;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// What was measured while running one benchmark case. Everything here is plain data so it can be
+/// copied back from the process the case ran in
+/// </summary>
+struct BenchmarkMeasurements
+{
+	//The number of operations that were timed, over every pass
+	uint64_t operations = 0;
+	double realSeconds = 0.0;
+	double cpuSeconds = 0.0;
+	//Whether or not the case ran out of time before finishing a pass, which degenerate trees do at large sizes
+	bool isTruncated = false;
+
+	//Percentiles of the operations that were timed one at a time, if the case timed any
+	bool hasLatency = false;
+	double p50Nanoseconds = 0.0;
+	double p99Nanoseconds = 0.0;
+
+	//The most memory the case's process had resident, if the case ran in a process of its own
+	bool hasPeakRss = false;
+	uint64_t peakRssBytes = 0;
+
+	//Last level cache misses during the timed passes, if the hardware counters could be opened
+	bool hasCacheMisses = false;
+	uint64_t cacheMisses = 0;
+};
+
+/// <summary>
+/// One benchmark case and its measurements
+/// </summary>
+struct BenchmarkResult
+{
+	std::string operation;
+	std::string container;
+	std::string valueType;
+	std::string distribution;
+	uint64_t size = 0;
+	BenchmarkMeasurements measurements;
+
+	/// <summary>
+	/// Returns the name of the case, such as insert/binary_tree/int/uniform/1000
+	/// </summary>
+	std::string getName() const;
+};
+
+/// <summary>
+/// Counts the last level cache misses of this process with perf_event_open. Where the counter can't be
+/// opened, such as on other systems or when perf events are restricted, it stays unavailable and counts nothing
+/// </summary>
+class CacheMissCounter
+{
+public:
+	CacheMissCounter();
+	~CacheMissCounter();
+	CacheMissCounter(const CacheMissCounter&) = delete;
+	CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+	/// <summary>
+	/// Returns whether or not the counter could be opened
+	/// </summary>
+	bool isAvailable() const;
+	/// <summary>
+	/// Starts counting, adding to what was counted before
+	/// </summary>
+	void start();
+	/// <summary>
+	/// Stops counting
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// Returns the number of misses counted while the counter was running
+	/// </summary>
+	uint64_t read() const;
+
+private:
+	int m_descriptor = -1;
+};
+
+/// <summary>
+/// Times passes of a benchmark, excluding the setup before each pass, until enough time has been measured
+/// or a pass runs out of time. Passes check the clock every few hundred operations, so a pass over a
+/// degenerate tree can be stopped long before it would finish
+/// </summary>
+class BenchmarkTimer
+{
+public:
+	/// <summary>
+	/// Creates a timer for one case
+	/// </summary>
+	/// <param name="minimumSeconds">Passes are repeated until at least this much time has been measured</param>
+	/// <param name="limitSeconds">A pass that takes longer than this is stopped and the case is marked as truncated</param>
+	BenchmarkTimer(double minimumSeconds, double limitSeconds);
+
+	/// <summary>
+	/// Returns whether or not another pass should be run
+	/// </summary>
+	bool needsAnotherPass() const;
+	/// <summary>
+	/// Starts timing a pass. Anything done before this isn't measured
+	/// </summary>
+	void startPass();
+	/// <summary>
+	/// Runs and counts one operation. Every few operations the operation is also timed on its own,
+	/// which is where the latency percentiles come from
+	/// </summary>
+	/// <returns>Whether or not the pass has run out of time and should stop</returns>
+	template<typename Operation>
+	bool run(Operation operation);
+	/// <summary>
+	/// Counts an operation, and returns whether or not the pass has run out of time and should stop
+	/// </summary>
+	bool countOperation();
+	/// <summary>
+	/// Counts a number of operations that were done all at once
+	/// </summary>
+	void countOperations(uint64_t count);
+	/// <summary>
+	/// Stops timing the pass
+	/// </summary>
+	void stopPass();
+
+	/// <summary>
+	/// Returns what was measured over every pass
+	/// </summary>
+	BenchmarkMeasurements getMeasurements() const;
+
+private:
+	//How many operations pass between looks at the clock
+	static constexpr uint64_t CLOCK_CHECK_INTERVAL = 256;
+	//One operation in this many is timed on its own
+	static constexpr uint64_t SAMPLE_INTERVAL = 32;
+	//The most latency samples kept, so a long case doesn't grow the memory being measured
+	static constexpr size_t MAX_SAMPLES = (size_t)1 << 18;
+
+	/// <summary>
+	/// Keeps the time one operation took, less the time reading the clock takes
+	/// </summary>
+	void addSample(std::chrono::steady_clock::duration elapsed);
+	/// <summary>
+	/// Returns the shortest time two back to back reads of the clock take
+	/// </summary>
+	static std::chrono::steady_clock::duration measureClockOverhead();
+
+	double m_minimumSeconds;
+	double m_limitSeconds;
+	std::chrono::steady_clock::time_point m_passStart;
+	std::clock_t m_passCpuStart = 0;
+	uint64_t m_passOperations = 0;
+	uint64_t m_operations = 0;
+	double m_realSeconds = 0.0;
+	double m_cpuSeconds = 0.0;
+	bool m_isTruncated = false;
+	std::vector<uint32_t> m_samples;
+	std::chrono::steady_clock::duration m_clockOverhead;
+	CacheMissCounter m_cacheMisses;
+};
+
+/// <summary>
+/// Runs each case in a process of its own where the system allows it, so its peak memory isn't mixed up
+/// with the cases before it and a case that crashes doesn't take the rest of the run with it
+/// </summary>
+class BenchmarkIsolation
+{
+public:
+	/// <summary>
+	/// Runs the case and returns its measurements, with the peak memory filled in when it ran on its own
+	/// </summary>
+	/// <param name="runCase">The case to run</param>
+	/// <param name="measurements">Where the measurements are written</param>
+	/// <returns>Whether or not the case finished</returns>
+	static bool run(const std::function<BenchmarkMeasurements()>& runCase, BenchmarkMeasurements& measurements);
+};
+
+/// <summary>
+/// Keeps values that a benchmark computes so the compiler can't leave out the work that made them
+/// </summary>
+class BenchmarkSink
+{
+public:
+	static void consume(uint64_t value);
+
+private:
+	static volatile uint64_t s_value;
+};
+
+/// <summary>
+/// Collects results and writes them as JSON in the layout Google Benchmark uses, so the same tools can compare runs
+/// </summary>
+class BenchmarkReport
+{
+public:
+	/// <summary>
+	/// Adds the result of a case
+	/// </summary>
+	void add(const BenchmarkResult& result);
+	/// <summary>
+	/// Returns every result added so far
+	/// </summary>
+	const std::vector<BenchmarkResult>& getResults() const;
+	/// <summary>
+	/// Writes every result along with a description of the machine that ran them
+	/// </summary>
+	/// <param name="stream">The stream to write to</param>
+	/// <param name="executable">The path the benchmark was run from</param>
+	void write(std::ostream& stream, const std::string& executable) const;
+
+private:
+	/// <summary>
+	/// Returns the text with the characters JSON doesn't allow in strings escaped
+	/// </summary>
+	static std::string escape(const std::string& text);
+	/// <summary>
+	/// Writes the value, or null if it wasn't measured
+	/// </summary>
+	static void writeOptional(std::ostream& stream, bool hasValue, double value);
+	static void writeOptional(std::ostream& stream, bool hasValue, uint64_t value);
+
+	std::vector<BenchmarkResult> m_results;
+};
+
+template<typename Operation>
+inline bool BenchmarkTimer::run(Operation operation)
+{
+	if (m_passOperations % SAMPLE_INTERVAL != 0)
+	{
+		operation();
+		return countOperation();
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	operation();
+	addSample(std::chrono::steady_clock::now() - start);
+	return countOperation();
+}
@@ -0,0 +1,315 @@
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BenchmarkHarness.h"
+#include "ContainerBenchmark.h"
+#include "KeyGenerator.h"
+
+/// <summary>
+/// The cases chosen on the command line
+/// </summary>
+struct BenchmarkOptions
+{
+	std::vector<uint64_t> sizes = { 1000, 10000, 100000, 1000000 };
+	std::vector<std::string> types = { "int", "string", "record64" };
+	std::vector<std::string> containers = { "binary_tree", "std_set", "std_map", "sorted_vector", "hash_set" };
+	std::vector<KeyDistribution> distributions = { KeyDistribution::Sequential, KeyDistribution::Uniform, KeyDistribution::Zipfian, KeyDistribution::Adversarial };
+	std::vector<std::string> operations = { "insert", "find", "remove", "iterate", "bulkload" };
+	BenchmarkSettings settings;
+	std::string outputPath;
+};
+
+//The largest tree that can be asked for, which still fits in memory as ints
+static const uint64_t MAX_SIZE = 100000000;
+
+/// <summary>
+/// Splits a comma separated list
+/// </summary>
+static std::vector<std::string> splitList(const std::string& text)
+{
+	std::vector<std::string> items;
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	return items;
+}
+
+/// <summary>
+/// Reads a size such as 1000, 10K or 1M
+/// </summary>
+/// <returns>Whether or not the text was a valid size</returns>
+static bool parseSize(const std::string& text, uint64_t& size)
+{
+	char* end = nullptr;
+	unsigned long long number = std::strtoull(text.c_str(), &end, 10);
+	if (end == text.c_str())
+		return false;
+
+	std::string suffix(end);
+	if (suffix == "K" || suffix == "k")
+		number *= 1000;
+	else if (suffix == "M" || suffix == "m")
+		number *= 1000000;
+	else if (!suffix.empty())
+		return false;
+
+	if (number == 0 || number > MAX_SIZE)
+		return false;
+	size = number;
+	return true;
+}
+
+/// <summary>
+/// Returns whether or not the name is in the list of allowed names
+/// </summary>
+static bool isOneOf(const std::string& name, const std::vector<std::string>& allowed)
+{
+	for (const std::string& candidate : allowed)
+	{
+		if (name == candidate)
+			return true;
+	}
+	return false;
+}
+
+static void printUsage(const char* executable)
+{
+	std::cerr << "Usage: " << executable << " [options]\n"
+		<< "  --sizes=1K,10K,100K,1M         Tree sizes, with optional K or M suffixes, up to 100M\n"
+		<< "  --types=int,string,record64    Value types\n"
+		<< "  --containers=binary_tree,std_set,std_map,sorted_vector,hash_set\n"
+		<< "  --distributions=sequential,uniform,zipfian,adversarial\n"
+		<< "  --operations=insert,find,remove,iterate,bulkload\n"
+		<< "  --min-time=0.2                 Seconds to measure each case for\n"
+		<< "  --time-limit=5                 Seconds before a single pass is stopped and marked as truncated\n"
+		<< "  --seed=1                       Seed for the random distributions\n"
+		<< "  --out=path                     Writes the JSON to a file instead of standard output\n";
+}
+
+/// <summary>
+/// Reads the command line into the options
+/// </summary>
+/// <returns>Whether or not every argument was understood</returns>
+static bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		size_t equals = argument.find('=');
+		std::string name = argument.substr(0, equals);
+		std::string value = equals == std::string::npos ? "" : argument.substr(equals + 1);
+
+		if (name == "--sizes")
+		{
+			options.sizes.clear();
+			for (const std::string& item : splitList(value))
+			{
+				uint64_t size = 0;
+				if (!parseSize(item, size))
+				{
+					std::cerr << "Invalid size: " << item << "\n";
+					return false;
+				}
+				options.sizes.push_back(size);
+			}
+		}
+		else if (name == "--types")
+		{
+			options.types = splitList(value);
+			for (const std::string& type : options.types)
+			{
+				if (!isOneOf(type, { "int", "string", "record64" }))
+				{
+					std::cerr << "Unknown type: " << type << "\n";
+					return false;
+				}
+			}
+		}
+		else if (name == "--containers")
+		{
+			options.containers = splitList(value);
+			for (const std::string& container : options.containers)
+			{
+				if (!isOneOf(container, { "binary_tree", "std_set", "std_map", "sorted_vector", "hash_set" }))
+				{
+					std::cerr << "Unknown container: " << container << "\n";
+					return false;
+				}
+			}
+		}
+		else if (name == "--distributions")
+		{
+			options.distributions.clear();
+			for (const std::string& item : splitList(value))
+			{
+				KeyDistribution distribution;
+				if (!KeyGenerator::parse(item, distribution))
+				{
+					std::cerr << "Unknown distribution: " << item << "\n";
+					return false;
+				}
+				options.distributions.push_back(distribution);
+			}
+		}
+		else if (name == "--operations")
+		{
+			options.operations = splitList(value);
+			for (const std::string& operation : options.operations)
+			{
+				if (!isOneOf(operation, { "insert", "find", "remove", "iterate", "bulkload" }))
+				{
+					std::cerr << "Unknown operation: " << operation << "\n";
+					return false;
+				}
+			}
+		}
+		else if (name == "--min-time")
+			options.settings.minimumSeconds = std::atof(value.c_str());
+		else if (name == "--time-limit")
+			options.settings.limitSeconds = std::atof(value.c_str());
+		else if (name == "--seed")
+			options.settings.seed = (uint32_t)std::strtoul(value.c_str(), nullptr, 10);
+		else if (name == "--out")
+			options.outputPath = value;
+		else
+		{
+			std::cerr << "Unknown option: " << argument << "\n";
+			return false;
+		}
+	}
+
+	if (options.settings.limitSeconds <= 0.0)
+	{
+		std::cerr << "The time limit must be positive\n";
+		return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Runs one case on its own and adds its result to the report
+/// </summary>
+template<typename Container>
+static void runCase(const std::string& operation, const char* distribution, uint64_t size,
+	const std::function<BenchmarkMeasurements()>& runOperation, BenchmarkReport& report)
+{
+	BenchmarkResult result;
+	result.operation = operation;
+	result.container = Container::getName();
+	result.valueType = ValueMaker<typename Container::ValueType>::getName();
+	result.distribution = distribution;
+	result.size = size;
+
+	//Progress goes to the error stream so the JSON can be piped
+	if (!BenchmarkIsolation::run(runOperation, result.measurements))
+	{
+		std::cerr << result.getName() << " (failed)\n";
+		return;
+	}
+
+	report.add(result);
+	std::cerr << result.getName() << (result.measurements.isTruncated ? " (truncated)" : "") << "\n";
+}
+
+/// <summary>
+/// Runs every chosen case for one container
+/// </summary>
+template<typename Container>
+static void runCases(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	using Benchmark = ContainerBenchmark<Container>;
+	const BenchmarkSettings& settings = options.settings;
+
+	for (uint64_t size : options.sizes)
+	{
+		for (const std::string& operation : options.operations)
+		{
+			//Bulk loading always starts from sorted values, so it only runs once per size
+			if (operation == "bulkload")
+			{
+				runCase<Container>(operation, "sorted", size, [&] { return Benchmark::runBulkLoad(size, settings); }, report);
+				continue;
+			}
+
+			for (KeyDistribution distribution : options.distributions)
+			{
+				std::function<BenchmarkMeasurements()> runOperation;
+				if (operation == "insert")
+					runOperation = [&] { return Benchmark::runInsert(distribution, size, settings); };
+				else if (operation == "find")
+					runOperation = [&] { return Benchmark::runFind(distribution, size, settings); };
+				else if (operation == "remove")
+					runOperation = [&] { return Benchmark::runRemove(distribution, size, settings); };
+				else
+					runOperation = [&] { return Benchmark::runIterate(distribution, size, settings); };
+
+				runCase<Container>(operation, KeyGenerator::getName(distribution), size, runOperation, report);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Runs every chosen container for one value type
+/// </summary>
+template<typename T>
+static void runContainers(const BenchmarkOptions& options, BenchmarkReport& report)
+{
+	for (const std::string& container : options.containers)
+	{
+		if (container == BinaryTreeAdapter<T>::getName())
+			runCases<BinaryTreeAdapter<T>>(options, report);
+		else if (container == StdSetAdapter<T>::getName())
+			runCases<StdSetAdapter<T>>(options, report);
+		else if (container == StdMapAdapter<T>::getName())
+			runCases<StdMapAdapter<T>>(options, report);
+		else if (container == SortedVectorAdapter<T>::getName())
+			runCases<SortedVectorAdapter<T>>(options, report);
+		else
+			runCases<HashSetAdapter<T>>(options, report);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	BenchmarkReport report;
+	for (const std::string& type : options.types)
+	{
+		if (type == "int")
+			runContainers<int>(options, report);
+		else if (type == "string")
+			runContainers<std::string>(options, report);
+		else
+			runContainers<Record64>(options, report);
+	}
+
+	if (options.outputPath.empty())
+		report.write(std::cout, argv[0]);
+	else
+	{
+		std::ofstream file(options.outputPath);
+		if (!file)
+		{
+			std::cerr << "Couldn't open " << options.outputPath << "\n";
+			return 1;
+		}
+		report.write(file, argv[0]);
+	}
+
+	return 0;
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "KeyGenerator.h"
+#include "OpenHashSet.h"
+#include "../BinaryTree.h"
+#include "../TreeNode.h"
+
+//Every adapter gives a container the same small interface, so each workload is written once and runs unchanged on all of them:
+//	using ValueType = T
+//	static const char* getName()
+//	void build(const std::vector<T>& values)            Fills the container before a pass. Not timed, and may be given duplicates
+//	void insert(const T& value)
+//	bool contains(const T& value)
+//	void remove(const T& value)
+//	void forEach(Visitor visitor)                       Calls visitor(value) until it returns false
+//	void bulkLoad(const std::vector<T>& sortedValues)  Fills an empty container from sorted values without duplicates
+
+/// <summary>
+/// The hash the hash set uses. Records are hashed by their key, since that is all they are compared by
+/// </summary>
+template<typename T>
+struct BenchmarkHash
+{
+	size_t operator()(const T& value) const { return std::hash<T>()(value); }
+};
+
+template<>
+struct BenchmarkHash<Record64>
+{
+	size_t operator()(const Record64& value) const { return std::hash<uint64_t>()(value.key); }
+};
+
+/// <summary>
+/// The tree being measured
+/// </summary>
+template<typename T>
+class BinaryTreeAdapter
+{
+public:
+	using ValueType = T;
+
+	static const char* getName() { return "binary_tree"; }
+
+	void build(const std::vector<T>& values)
+	{
+		//A new value always ends up in the same place however it is inserted, so using the previous node as a
+		//hint gives the shape plain inserts would, but places sequential and adversarial keys in O(1)
+		TreeNode<T>* hint = nullptr;
+		for (const T& value : values)
+			hint = m_tree.insert(hint, value);
+	}
+	void insert(const T& value) { m_tree.insert(value); }
+	bool contains(const T& value) { return m_tree.find(value) != nullptr; }
+	void remove(const T& value) { m_tree.remove(value); }
+	template<typename Visitor>
+	void forEach(Visitor visitor)
+	{
+		for (const T& value : m_tree)
+		{
+			if (!visitor(value))
+				return;
+		}
+	}
+	void bulkLoad(const std::vector<T>& sortedValues) { m_tree.bulkLoad(sortedValues); }
+
+private:
+	BinaryTree<T> m_tree;
+};
+
+/// <summary>
+/// The standard library's balanced tree
+/// </summary>
+template<typename T>
+class StdSetAdapter
+{
+public:
+	using ValueType = T;
+
+	static const char* getName() { return "std_set"; }
+
+	void build(const std::vector<T>& values) { m_set.insert(values.begin(), values.end()); }
+	void insert(const T& value) { m_set.insert(value); }
+	bool contains(const T& value) { return m_set.find(value) != m_set.end(); }
+	void remove(const T& value) { m_set.erase(value); }
+	template<typename Visitor>
+	void forEach(Visitor visitor)
+	{
+		for (const T& value : m_set)
+		{
+			if (!visitor(value))
+				return;
+		}
+	}
+	//Inserting sorted values at the end is amortised O(1) each, the same as building the tree from sorted values
+	void bulkLoad(const std::vector<T>& sortedValues) { m_set.insert(sortedValues.begin(), sortedValues.end()); }
+
+private:
+	std::set<T> m_set;
+};
+
+/// <summary>
+/// The standard library's balanced tree with a 64 bit value beside each key, which shows what the larger node costs
+/// </summary>
+template<typename T>
+class StdMapAdapter
+{
+public:
+	using ValueType = T;
+
+	static const char* getName() { return "std_map"; }
+
+	void build(const std::vector<T>& values)
+	{
+		for (const T& value : values)
+			m_map.emplace(value, 0);
+	}
+	void insert(const T& value) { m_map.emplace(value, 0); }
+	bool contains(const T& value) { return m_map.find(value) != m_map.end(); }
+	void remove(const T& value) { m_map.erase(value); }
+	template<typename Visitor>
+	void forEach(Visitor visitor)
+	{
+		for (const std::pair<const T, uint64_t>& entry : m_map)
+		{
+			if (!visitor(entry.first))
+				return;
+		}
+	}
+	void bulkLoad(const std::vector<T>& sortedValues)
+	{
+		for (const T& value : sortedValues)
+			m_map.emplace_hint(m_map.end(), value, 0);
+	}
+
+private:
+	std::map<T, uint64_t> m_map;
+};
+
+/// <summary>
+/// A sorted array searched by bisection. Lookups and iteration are as cache friendly as it gets, while
+/// inserting or removing anywhere but the end moves everything after it
+/// </summary>
+template<typename T>
+class SortedVectorAdapter
+{
+public:
+	using ValueType = T;
+
+	static const char* getName() { return "sorted_vector"; }
+
+	void build(const std::vector<T>& values)
+	{
+		m_values = values;
+		std::sort(m_values.begin(), m_values.end());
+		m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+	}
+	void insert(const T& value)
+	{
+		typename std::vector<T>::iterator position = std::lower_bound(m_values.begin(), m_values.end(), value);
+		if (position == m_values.end() || value < *position)
+			m_values.insert(position, value);
+	}
+	bool contains(const T& value) { return std::binary_search(m_values.begin(), m_values.end(), value); }
+	void remove(const T& value)
+	{
+		typename std::vector<T>::iterator position = std::lower_bound(m_values.begin(), m_values.end(), value);
+		if (position != m_values.end() && !(value < *position))
+			m_values.erase(position);
+	}
+	template<typename Visitor>
+	void forEach(Visitor visitor)
+	{
+		for (const T& value : m_values)
+		{
+			if (!visitor(value))
+				return;
+		}
+	}
+	void bulkLoad(const std::vector<T>& sortedValues) { m_values.assign(sortedValues.begin(), sortedValues.end()); }
+
+private:
+	std::vector<T> m_values;
+};
+
+/// <summary>
+/// An open addressing hash set, the usual choice when nothing needs the values in order.
+/// Iterating visits the values in the order they are stored rather than sorted
+/// </summary>
+template<typename T>
+class HashSetAdapter
+{
+public:
+	using ValueType = T;
+
+	static const char* getName() { return "hash_set"; }
+
+	void build(const std::vector<T>& values)
+	{
+		m_set.reserve(values.size());
+		for (const T& value : values)
+			m_set.insert(value);
+	}
+	void insert(const T& value) { m_set.insert(value); }
+	bool contains(const T& value) { return m_set.contains(value); }
+	void remove(const T& value) { m_set.remove(value); }
+	template<typename Visitor>
+	void forEach(Visitor visitor) { m_set.forEach(visitor); }
+	//The size is known up front, which is the hash set's equivalent of building from sorted values
+	void bulkLoad(const std::vector<T>& sortedValues)
+	{
+		m_set.reserve(sortedValues.size());
+		for (const T& value : sortedValues)
+			m_set.insert(value);
+	}
+
+private:
+	OpenHashSet<T, BenchmarkHash<T>> m_set;
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BenchmarkHarness.h"
+#include "ContainerAdapters.h"
+#include "KeyGenerator.h"
+
+/// <summary>
+/// The settings shared by every benchmark case
+/// </summary>
+struct BenchmarkSettings
+{
+	double minimumSeconds = 0.2;
+	double limitSeconds = 5.0;
+	uint32_t seed = 1;
+};
+
+/// <summary>
+/// Measures the operations of one container through its adapter. Every container is given the same keys in
+/// the same order, every timed pass starts from a freshly built container, and building it isn't timed
+/// </summary>
+template<typename Container>
+class ContainerBenchmark
+{
+public:
+	using T = typename Container::ValueType;
+
+	/// <summary>
+	/// Times inserting every key into an empty container
+	/// </summary>
+	static BenchmarkMeasurements runInsert(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings);
+	/// <summary>
+	/// Times looking keys up in a container that holds every key
+	/// </summary>
+	static BenchmarkMeasurements runFind(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings);
+	/// <summary>
+	/// Times removing every key from a container that holds them, in the order they were inserted
+	/// </summary>
+	static BenchmarkMeasurements runRemove(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings);
+	/// <summary>
+	/// Times visiting every value in the container. Each step is too quick to time on its own, so there are no latency percentiles
+	/// </summary>
+	static BenchmarkMeasurements runIterate(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings);
+	/// <summary>
+	/// Times filling the container from sorted values. The distribution doesn't apply, since the values are sorted
+	/// </summary>
+	static BenchmarkMeasurements runBulkLoad(uint64_t size, const BenchmarkSettings& settings);
+
+private:
+	/// <summary>
+	/// Turns keys into values of the type being measured
+	/// </summary>
+	static std::vector<T> makeValues(const std::vector<uint64_t>& keys);
+};
+
+template<typename Container>
+inline BenchmarkMeasurements ContainerBenchmark<Container>::runInsert(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings)
+{
+	std::vector<T> values = makeValues(KeyGenerator::makeInsertKeys(distribution, size, settings.seed));
+
+	BenchmarkTimer timer(settings.minimumSeconds, settings.limitSeconds);
+	while (timer.needsAnotherPass())
+	{
+		Container container;
+		timer.startPass();
+		for (const T& value : values)
+		{
+			if (timer.run([&] { container.insert(value); }))
+				break;
+		}
+		timer.stopPass();
+	}
+
+	return timer.getMeasurements();
+}
+
+template<typename Container>
+inline BenchmarkMeasurements ContainerBenchmark<Container>::runFind(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings)
+{
+	std::vector<T> values = makeValues(KeyGenerator::makeInsertKeys(distribution, size, settings.seed));
+	std::vector<T> findValues = makeValues(KeyGenerator::makeFindKeys(distribution, size, settings.seed));
+
+	//Lookups don't change the container, so one container serves every pass
+	Container container;
+	container.build(values);
+
+	BenchmarkTimer timer(settings.minimumSeconds, settings.limitSeconds);
+	while (timer.needsAnotherPass())
+	{
+		uint64_t found = 0;
+		timer.startPass();
+		for (const T& value : findValues)
+		{
+			if (timer.run([&] { found += container.contains(value); }))
+				break;
+		}
+		timer.stopPass();
+		BenchmarkSink::consume(found);
+	}
+
+	return timer.getMeasurements();
+}
+
+template<typename Container>
+inline BenchmarkMeasurements ContainerBenchmark<Container>::runRemove(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings)
+{
+	std::vector<T> values = makeValues(KeyGenerator::makeInsertKeys(distribution, size, settings.seed));
+
+	BenchmarkTimer timer(settings.minimumSeconds, settings.limitSeconds);
+	while (timer.needsAnotherPass())
+	{
+		Container container;
+		container.build(values);
+
+		timer.startPass();
+		for (const T& value : values)
+		{
+			if (timer.run([&] { container.remove(value); }))
+				break;
+		}
+		timer.stopPass();
+	}
+
+	return timer.getMeasurements();
+}
+
+template<typename Container>
+inline BenchmarkMeasurements ContainerBenchmark<Container>::runIterate(KeyDistribution distribution, uint64_t size, const BenchmarkSettings& settings)
+{
+	std::vector<T> values = makeValues(KeyGenerator::makeInsertKeys(distribution, size, settings.seed));
+
+	Container container;
+	container.build(values);
+
+	BenchmarkTimer timer(settings.minimumSeconds, settings.limitSeconds);
+	while (timer.needsAnotherPass())
+	{
+		uint64_t total = 0;
+		timer.startPass();
+		container.forEach([&](const T& value)
+		{
+			total += ValueMaker<T>::digest(value);
+			return !timer.countOperation();
+		});
+		timer.stopPass();
+		BenchmarkSink::consume(total);
+	}
+
+	return timer.getMeasurements();
+}
+
+template<typename Container>
+inline BenchmarkMeasurements ContainerBenchmark<Container>::runBulkLoad(uint64_t size, const BenchmarkSettings& settings)
+{
+	std::vector<T> values = makeValues(KeyGenerator::makeInsertKeys(KeyDistribution::Sequential, size, settings.seed));
+
+	BenchmarkTimer timer(settings.minimumSeconds, settings.limitSeconds);
+	while (timer.needsAnotherPass())
+	{
+		Container container;
+		timer.startPass();
+		container.bulkLoad(values);
+		timer.countOperations(values.size());
+		timer.stopPass();
+	}
+
+	return timer.getMeasurements();
+}
+
+template<typename Container>
+inline std::vector<typename ContainerBenchmark<Container>::T> ContainerBenchmark<Container>::makeValues(const std::vector<uint64_t>& keys)
+{
+	std::vector<T> values;
+	values.reserve(keys.size());
+	for (uint64_t key : keys)
+		values.push_back(ValueMaker<T>::make(key));
+	return values;
+}
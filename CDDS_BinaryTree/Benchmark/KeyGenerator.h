@@ -0,0 +1,332 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// The orders in which keys are inserted and looked up
+/// </summary>
+enum class KeyDistribution
+{
+	//0, 1, 2, ... which an unbalanced tree turns into a list
+	Sequential,
+	//Every key once in a random order, then random keys for lookups
+	Uniform,
+	//A few keys are used far more often than the rest, like the popular items of a real workload
+	Zipfian,
+	//0, n-1, 1, n-2, ... which zigzags down a single path and defeats the largest node shortcut
+	Adversarial
+};
+
+/// <summary>
+/// A 64 byte value ordered by its key, standing in for records that are expensive to copy
+/// </summary>
+struct Record64
+{
+	uint64_t key = 0;
+	char payload[56] = {};
+
+	bool operator<(const Record64& other) const { return key < other.key; }
+	bool operator>(const Record64& other) const { return key > other.key; }
+	bool operator==(const Record64& other) const { return key == other.key; }
+	bool operator!=(const Record64& other) const { return key != other.key; }
+};
+
+static_assert(sizeof(Record64) == 64, "Record64 should fill a cache line");
+
+/// <summary>
+/// Draws ranks from 0 to n - 1 where rank k is drawn in proportion to 1 / (k + 1)^exponent.
+/// Uses rejection-inversion sampling, so it takes O(1) memory and time however many ranks there are
+/// </summary>
+class ZipfGenerator
+{
+public:
+	/// <summary>
+	/// Creates a generator over the given number of ranks
+	/// </summary>
+	/// <param name="rankCount">The number of ranks to draw from</param>
+	/// <param name="exponent">How strongly the small ranks are favoured, 0.99 being typical of real workloads</param>
+	ZipfGenerator(uint64_t rankCount, double exponent);
+
+	/// <summary>
+	/// Draws the next rank
+	/// </summary>
+	template<typename Random>
+	uint64_t next(Random& random);
+
+private:
+	double h(double x) const;
+	double hIntegral(double x) const;
+	double hIntegralInverse(double x) const;
+	static double helper1(double x);
+	static double helper2(double x);
+
+	uint64_t m_rankCount;
+	double m_exponent;
+	double m_hIntegralX1;
+	double m_hIntegralRankCount;
+	double m_s;
+};
+
+/// <summary>
+/// Creates the keys a benchmark uses, as numbers from 0 to the key count that are turned into values later
+/// </summary>
+class KeyGenerator
+{
+public:
+	/// <summary>
+	/// Returns the name used for the distribution in results
+	/// </summary>
+	static const char* getName(KeyDistribution distribution);
+	/// <summary>
+	/// Finds the distribution with the given name
+	/// </summary>
+	/// <returns>Whether or not the name was recognised</returns>
+	static bool parse(const std::string& name, KeyDistribution& distribution);
+
+	/// <summary>
+	/// Returns the keys in the order they are inserted. Every distribution but Zipfian uses each key once
+	/// </summary>
+	/// <param name="distribution">The order to create the keys in</param>
+	/// <param name="keyCount">The number of keys</param>
+	/// <param name="seed">The seed for the random distributions</param>
+	static std::vector<uint64_t> makeInsertKeys(KeyDistribution distribution, uint64_t keyCount, uint32_t seed);
+	/// <summary>
+	/// Returns the keys looked up after all of the insert keys have been inserted
+	/// </summary>
+	/// <param name="distribution">The order to create the keys in</param>
+	/// <param name="keyCount">The number of keys in the tree, which is also the number of lookups</param>
+	/// <param name="seed">The seed for the random distributions</param>
+	static std::vector<uint64_t> makeFindKeys(KeyDistribution distribution, uint64_t keyCount, uint32_t seed);
+
+private:
+	/// <summary>
+	/// Spreads Zipfian ranks over the keys so the popular keys aren't all at one end of the tree.
+	/// Multiplying by a prime larger than any key count is a bijection modulo the key count
+	/// </summary>
+	static uint64_t scatterRank(uint64_t rank, uint64_t keyCount);
+
+	/// <summary>
+	/// Zipfian keys drawn from the same generator for both inserts and lookups
+	/// </summary>
+	static std::vector<uint64_t> makeZipfianKeys(uint64_t keyCount, uint32_t seed);
+};
+
+/// <summary>
+/// Turns a key into a value of the type being measured, and a value into a number for the benchmark sink.
+/// Keys keep their order as values
+/// </summary>
+template<typename T>
+struct ValueMaker;
+
+template<>
+struct ValueMaker<int>
+{
+	static const char* getName() { return "int"; }
+	static int make(uint64_t key) { return (int)key; }
+	static uint64_t digest(int value) { return (uint64_t)value; }
+};
+
+template<>
+struct ValueMaker<std::string>
+{
+	static const char* getName() { return "string"; }
+	static std::string make(uint64_t key)
+	{
+		//Zero padding keeps the strings in the same order as the keys, and 16 characters is too long to be stored inline
+		char buffer[24];
+		snprintf(buffer, sizeof(buffer), "%016llu", (unsigned long long)key);
+		return std::string(buffer);
+	}
+	static uint64_t digest(const std::string& value) { return value.size() + (unsigned char)value.back(); }
+};
+
+template<>
+struct ValueMaker<Record64>
+{
+	static const char* getName() { return "record64"; }
+	static Record64 make(uint64_t key)
+	{
+		Record64 record;
+		record.key = key;
+		record.payload[0] = (char)key;
+		return record;
+	}
+	static uint64_t digest(const Record64& value) { return value.key; }
+};
+
+inline ZipfGenerator::ZipfGenerator(uint64_t rankCount, double exponent) : m_rankCount(rankCount), m_exponent(exponent)
+{
+	m_hIntegralX1 = hIntegral(1.5) - 1.0;
+	m_hIntegralRankCount = hIntegral((double)m_rankCount + 0.5);
+	m_s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+}
+
+template<typename Random>
+inline uint64_t ZipfGenerator::next(Random& random)
+{
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	while (true)
+	{
+		//Picks a point under the curve of the integral, then keeps it if it lands inside the bar of its rank
+		double u = m_hIntegralRankCount + uniform(random) * (m_hIntegralX1 - m_hIntegralRankCount);
+		double x = hIntegralInverse(u);
+		double k = std::floor(x + 0.5);
+		if (k < 1.0)
+			k = 1.0;
+		else if (k > (double)m_rankCount)
+			k = (double)m_rankCount;
+
+		if (k - x <= m_s || u >= hIntegral(k + 0.5) - h(k))
+			return (uint64_t)k - 1;
+	}
+}
+
+inline double ZipfGenerator::h(double x) const
+{
+	return std::exp(-m_exponent * std::log(x));
+}
+
+inline double ZipfGenerator::hIntegral(double x) const
+{
+	double logX = std::log(x);
+	return helper2((1.0 - m_exponent) * logX) * logX;
+}
+
+inline double ZipfGenerator::hIntegralInverse(double x) const
+{
+	double t = x * (1.0 - m_exponent);
+	if (t < -1.0)
+		t = -1.0;
+	return std::exp(helper1(t) * x);
+}
+
+inline double ZipfGenerator::helper1(double x)
+{
+	//log(1 + x) / x, which loses precision near 0 unless it is expanded
+	if (std::fabs(x) > 1e-8)
+		return std::log1p(x) / x;
+	return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+inline double ZipfGenerator::helper2(double x)
+{
+	//(e^x - 1) / x, expanded near 0 for the same reason
+	if (std::fabs(x) > 1e-8)
+		return std::expm1(x) / x;
+	return 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+}
+
+inline const char* KeyGenerator::getName(KeyDistribution distribution)
+{
+	switch (distribution)
+	{
+	case KeyDistribution::Sequential:
+		return "sequential";
+	case KeyDistribution::Uniform:
+		return "uniform";
+	case KeyDistribution::Zipfian:
+		return "zipfian";
+	case KeyDistribution::Adversarial:
+		return "adversarial";
+	}
+	return "unknown";
+}
+
+inline bool KeyGenerator::parse(const std::string& name, KeyDistribution& distribution)
+{
+	const KeyDistribution distributions[] = { KeyDistribution::Sequential, KeyDistribution::Uniform, KeyDistribution::Zipfian, KeyDistribution::Adversarial };
+	for (KeyDistribution candidate : distributions)
+	{
+		if (name == getName(candidate))
+		{
+			distribution = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+inline std::vector<uint64_t> KeyGenerator::makeInsertKeys(KeyDistribution distribution, uint64_t keyCount, uint32_t seed)
+{
+	std::vector<uint64_t> keys;
+	keys.reserve(keyCount);
+
+	switch (distribution)
+	{
+	case KeyDistribution::Sequential:
+		for (uint64_t key = 0; key < keyCount; key++)
+			keys.push_back(key);
+		break;
+
+	case KeyDistribution::Uniform:
+	{
+		for (uint64_t key = 0; key < keyCount; key++)
+			keys.push_back(key);
+		std::mt19937_64 random(seed);
+		std::shuffle(keys.begin(), keys.end(), random);
+		break;
+	}
+
+	case KeyDistribution::Zipfian:
+		keys = makeZipfianKeys(keyCount, seed);
+		break;
+
+	case KeyDistribution::Adversarial:
+		//Takes the smallest and largest keys left in turn
+		for (uint64_t i = 0; i < keyCount; i++)
+			keys.push_back(i % 2 == 0 ? i / 2 : keyCount - 1 - i / 2);
+		break;
+	}
+
+	return keys;
+}
+
+inline std::vector<uint64_t> KeyGenerator::makeFindKeys(KeyDistribution distribution, uint64_t keyCount, uint32_t seed)
+{
+	switch (distribution)
+	{
+	//Random keys that are in the tree, drawn with replacement
+	case KeyDistribution::Uniform:
+	{
+		std::vector<uint64_t> keys;
+		keys.reserve(keyCount);
+		std::mt19937_64 random(seed + 1);
+		std::uniform_int_distribution<uint64_t> pick(0, keyCount == 0 ? 0 : keyCount - 1);
+		for (uint64_t i = 0; i < keyCount; i++)
+			keys.push_back(pick(random));
+		return keys;
+	}
+
+	case KeyDistribution::Zipfian:
+		return makeZipfianKeys(keyCount, seed + 1);
+
+	//The other distributions look keys up in the order they were inserted
+	default:
+		return makeInsertKeys(distribution, keyCount, seed);
+	}
+}
+
+inline uint64_t KeyGenerator::scatterRank(uint64_t rank, uint64_t keyCount)
+{
+	const uint64_t prime = 2654435761u;
+	return (rank % keyCount) * prime % keyCount;
+}
+
+inline std::vector<uint64_t> KeyGenerator::makeZipfianKeys(uint64_t keyCount, uint32_t seed)
+{
+	std::vector<uint64_t> keys;
+	keys.reserve(keyCount);
+	if (keyCount == 0)
+		return keys;
+
+	std::mt19937_64 random(seed);
+	ZipfGenerator zipf(keyCount, 0.99);
+	for (uint64_t i = 0; i < keyCount; i++)
+		keys.push_back(scatterRank(zipf.next(random), keyCount));
+	return keys;
+}
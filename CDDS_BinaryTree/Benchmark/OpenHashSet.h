@@ -0,0 +1,193 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// A set stored in one flat array using open addressing with linear probing. Removing a value shifts the
+/// values after it back instead of leaving a marker, so lookups never have to step over removed slots.
+/// The values aren't kept in any order
+/// </summary>
+template<typename T, typename Hash = std::hash<T>>
+class OpenHashSet
+{
+public:
+	/// <summary>
+	/// Adds the value if it isn't already in the set
+	/// </summary>
+	/// <returns>Whether or not the value was added</returns>
+	bool insert(const T& value);
+	/// <summary>
+	/// Returns whether or not the value is in the set
+	/// </summary>
+	bool contains(const T& value) const;
+	/// <summary>
+	/// Removes the value if it is in the set
+	/// </summary>
+	/// <returns>Whether or not the value was removed</returns>
+	bool remove(const T& value);
+	/// <summary>
+	/// Makes room for the given number of values, so adding them doesn't have to grow the table
+	/// </summary>
+	void reserve(size_t count);
+	/// <summary>
+	/// Returns the number of values in the set
+	/// </summary>
+	size_t size() const { return m_size; }
+
+	/// <summary>
+	/// Calls the visitor with every value in the order they are stored, until it returns false
+	/// </summary>
+	template<typename Visitor>
+	void forEach(Visitor visitor) const;
+
+private:
+	//The table grows once it is this full, as a fraction of MAX_LOAD_DIVISOR
+	static constexpr size_t MAX_LOAD = 3;
+	static constexpr size_t MAX_LOAD_DIVISOR = 4;
+	static constexpr size_t MIN_CAPACITY = 16;
+
+	/// <summary>
+	/// Returns the slot the value would be in if nothing had collided with it.
+	/// The hash is mixed first, so hashes that are just the value still spread over the table
+	/// </summary>
+	size_t getHome(const T& value) const;
+	/// <summary>
+	/// Returns the slot holding the value, or the empty slot where it would go
+	/// </summary>
+	size_t findSlot(const T& value) const;
+	/// <summary>
+	/// Moves every value into a new table with the given number of slots, which is a power of two
+	/// </summary>
+	void rehash(size_t capacity);
+
+	std::vector<T> m_slots;
+	//One byte per slot rather than packed bits, which would make every probe mask and shift
+	std::vector<uint8_t> m_isUsed;
+	size_t m_size = 0;
+	//Shifting the mixed hash right by this leaves an index into the table
+	unsigned int m_shift = 64;
+	Hash m_hash;
+};
+
+template<typename T, typename Hash>
+inline bool OpenHashSet<T, Hash>::insert(const T& value)
+{
+	if ((m_size + 1) * MAX_LOAD_DIVISOR > m_slots.size() * MAX_LOAD)
+		rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+
+	size_t slot = findSlot(value);
+	if (m_isUsed[slot])
+		return false;
+
+	m_slots[slot] = value;
+	m_isUsed[slot] = 1;
+	m_size++;
+	return true;
+}
+
+template<typename T, typename Hash>
+inline bool OpenHashSet<T, Hash>::contains(const T& value) const
+{
+	if (m_size == 0)
+		return false;
+	return m_isUsed[findSlot(value)] != 0;
+}
+
+template<typename T, typename Hash>
+inline bool OpenHashSet<T, Hash>::remove(const T& value)
+{
+	if (m_size == 0)
+		return false;
+
+	size_t hole = findSlot(value);
+	if (!m_isUsed[hole])
+		return false;
+
+	//Pulls back each following value that is allowed to sit in the hole, until an empty slot ends the run
+	size_t mask = m_slots.size() - 1;
+	size_t slot = hole;
+	while (true)
+	{
+		slot = (slot + 1) & mask;
+		if (!m_isUsed[slot])
+			break;
+
+		//The value can move back if the hole is no further along than where it would rather be
+		size_t home = getHome(m_slots[slot]);
+		if (((slot - home) & mask) >= ((slot - hole) & mask))
+		{
+			m_slots[hole] = std::move(m_slots[slot]);
+			hole = slot;
+		}
+	}
+
+	m_slots[hole] = T();
+	m_isUsed[hole] = 0;
+	m_size--;
+	return true;
+}
+
+template<typename T, typename Hash>
+inline void OpenHashSet<T, Hash>::reserve(size_t count)
+{
+	size_t capacity = m_slots.empty() ? MIN_CAPACITY : m_slots.size();
+	while (count * MAX_LOAD_DIVISOR > capacity * MAX_LOAD)
+		capacity *= 2;
+
+	if (capacity > m_slots.size())
+		rehash(capacity);
+}
+
+template<typename T, typename Hash>
+template<typename Visitor>
+inline void OpenHashSet<T, Hash>::forEach(Visitor visitor) const
+{
+	for (size_t slot = 0; slot < m_slots.size(); slot++)
+	{
+		if (m_isUsed[slot] && !visitor(m_slots[slot]))
+			return;
+	}
+}
+
+template<typename T, typename Hash>
+inline size_t OpenHashSet<T, Hash>::getHome(const T& value) const
+{
+	//Fibonacci hashing keeps the top bits, which multiplying by the golden ratio mixes the most
+	return (size_t)(((uint64_t)m_hash(value) * 0x9E3779B97F4A7C15ull) >> m_shift);
+}
+
+template<typename T, typename Hash>
+inline size_t OpenHashSet<T, Hash>::findSlot(const T& value) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t slot = getHome(value);
+	while (m_isUsed[slot] && !(m_slots[slot] == value))
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+template<typename T, typename Hash>
+inline void OpenHashSet<T, Hash>::rehash(size_t capacity)
+{
+	std::vector<T> oldSlots(capacity);
+	std::vector<uint8_t> oldIsUsed(capacity, 0);
+	oldSlots.swap(m_slots);
+	oldIsUsed.swap(m_isUsed);
+
+	m_shift = 64;
+	for (size_t power = capacity; power > 1; power >>= 1)
+		m_shift--;
+
+	for (size_t slot = 0; slot < oldSlots.size(); slot++)
+	{
+		if (!oldIsUsed[slot])
+			continue;
+
+		size_t newSlot = findSlot(oldSlots[slot]);
+		m_slots[newSlot] = std::move(oldSlots[slot]);
+		m_isUsed[newSlot] = 1;
+	}
+}
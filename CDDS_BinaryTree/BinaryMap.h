@@ -0,0 +1,123 @@
+#pragma once
+#include <utility>
+#include "BinaryTree.h"
+#include "TreeNode.h"
+
+/// <summary>
+/// A key and the value stored with it. Entries are ordered by their key only
+/// </summary>
+template<typename K, typename V>
+struct MapEntry
+{
+	/// <summary>
+	/// Builds the value in place from the arguments that follow the key
+	/// </summary>
+	template<typename... Args>
+	explicit MapEntry(const K& entryKey, Args&&... valueArgs) : key(entryKey), value(std::forward<Args>(valueArgs)...) {}
+
+	/// <summary>
+	/// Returns the value, which can be changed while the entry is in a tree since entries are ordered by their key only
+	/// </summary>
+	V& getValue() const { return value; }
+
+	K key;
+
+private:
+	mutable V value;
+};
+
+template<typename K, typename V>
+inline bool operator<(const MapEntry<K, V>& lhs, const MapEntry<K, V>& rhs) { return lhs.key < rhs.key; }
+template<typename K, typename V>
+inline bool operator>(const MapEntry<K, V>& lhs, const MapEntry<K, V>& rhs) { return rhs.key < lhs.key; }
+template<typename K, typename V>
+inline bool operator==(const MapEntry<K, V>& lhs, const MapEntry<K, V>& rhs) { return !(lhs.key < rhs.key) && !(rhs.key < lhs.key); }
+template<typename K, typename V>
+inline bool operator!=(const MapEntry<K, V>& lhs, const MapEntry<K, V>& rhs) { return !(lhs == rhs); }
+template<typename K, typename V>
+inline bool operator<(const MapEntry<K, V>& lhs, const K& rhs) { return lhs.key < rhs; }
+template<typename K, typename V>
+inline bool operator<(const K& lhs, const MapEntry<K, V>& rhs) { return lhs < rhs.key; }
+
+template<typename K, typename V>
+class BinaryMap
+{
+public:
+
+	/// <summary>
+	/// Returns whether or not there are any entries in the map
+	/// </summary>
+	bool isEmpty() const;
+	/// <summary>
+	/// Returns the number of entries in the map
+	/// </summary>
+	size_t size() const;
+	/// <summary>
+	/// Returns the value stored with the given key, adding a default value if the key isn't in the map
+	/// </summary>
+	/// <param name="key">The key of the value to return</param>
+	V& operator[](const K& key);
+	/// <summary>
+	/// Adds a value built from the given arguments if the key isn't in the map.
+	/// The value is only built when it is added, and is built in place so it doesn't have to be copyable
+	/// </summary>
+	/// <param name="key">The key to store the value with</param>
+	/// <param name="args">The arguments used to build the value</param>
+	/// <returns>The value stored with the key and whether or not it was just added</returns>
+	template<typename... Args>
+	std::pair<V&, bool> tryEmplace(const K& key, Args&&... args);
+	/// <summary>
+	/// Returns a pointer to the value stored with the given key, or nullptr if the key isn't in the map.
+	/// The value can be changed in place through the pointer
+	/// </summary>
+	/// <param name="key">The key of the value to search for</param>
+	V* find(const K& key);
+	/// <summary>
+	/// Removes the entry with the given key from the map
+	/// </summary>
+	/// <param name="key">The key of the entry to remove</param>
+	void remove(const K& key);
+
+private:
+	BinaryTree<MapEntry<K, V>> m_tree;
+};
+
+template<typename K, typename V>
+inline bool BinaryMap<K, V>::isEmpty() const
+{
+	return m_tree.isEmpty();
+}
+
+template<typename K, typename V>
+inline size_t BinaryMap<K, V>::size() const
+{
+	return m_tree.size();
+}
+
+template<typename K, typename V>
+inline V& BinaryMap<K, V>::operator[](const K& key)
+{
+	return tryEmplace(key).first;
+}
+
+template<typename K, typename V>
+template<typename... Args>
+inline std::pair<V&, bool> BinaryMap<K, V>::tryEmplace(const K& key, Args&&... args)
+{
+	//The entry is built inside its node only if the key isn't in the map yet
+	std::pair<TreeNode<MapEntry<K, V>>*, bool> result = m_tree.tryEmplace(key, key, std::forward<Args>(args)...);
+	return std::pair<V&, bool>(result.first->getData().getValue(), result.second);
+}
+
+template<typename K, typename V>
+inline V* BinaryMap<K, V>::find(const K& key)
+{
+	TreeNode<MapEntry<K, V>>* node = m_tree.findKey(key);
+	return node ? &node->getData().getValue() : nullptr;
+}
+
+template<typename K, typename V>
+inline void BinaryMap<K, V>::remove(const K& key)
+{
+	m_tree.erase(m_tree.findKey(key));
+}
@@ -2,295 +2,2088 @@
 #define _BINARYTREE_H_
 
 #pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "FindCache.h"
+#include "NodeArena.h"
+#include "NodeHandle.h"
+#include "TreeLog.h"
+#include "TreeStats.h"
+#include "TreeTraversal.h"
+
 template<typename T>
 class TreeNode;
 
 template<typename T>
-class BinaryTree
+class BinaryTree
+{
+public:
+	/// <summary>
+	/// Steps through the nodes of a tree from the smallest value to the largest.
+	/// In a multiset each node is visited once, however many copies it stands for
+	/// </summary>
+	class Iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		Iterator() {}
+		Iterator(TreeNode<T>* node, const BinaryTree<T>* tree);
+
+		/// <summary>
+		/// Returns the value the iterator is at. It can't be changed in place, since that could break the tree's order
+		/// </summary>
+		const T& operator*() const;
+		const T* operator->() const;
+		Iterator& operator++();
+		Iterator operator++(int);
+		Iterator& operator--();
+		Iterator operator--(int);
+		bool operator==(const Iterator& other) const;
+		bool operator!=(const Iterator& other) const;
+
+		/// <summary>
+		/// Returns the node the iterator is at, or nullptr if it is past the end
+		/// </summary>
+		TreeNode<T>* getNode() const;
+
+	private:
+		TreeNode<T>* m_node = nullptr;
+		const BinaryTree<T>* m_tree = nullptr;
+	};
+
+	BinaryTree();
+	/// <summary>
+	/// Creates a tree that either ignores duplicate values or counts them
+	/// </summary>
+	/// <param name="isMultiset">Whether inserting a value that is already in the tree should add another copy of it</param>
+	explicit BinaryTree(bool isMultiset);
+	/// <summary>
+	/// Deletes every node in the tree and detaches its log
+	/// </summary>
+	virtual ~BinaryTree();
+
+	/// <summary>
+	/// Trees can't be copied implicitly, since copying every node is expensive. Use clone instead
+	/// </summary>
+	BinaryTree(const BinaryTree<T>&) = delete;
+	BinaryTree<T>& operator=(const BinaryTree<T>&) = delete;
+	/// <summary>
+	/// Takes the nodes of the other tree in O(1), leaving it empty. The other tree's log comes with its nodes
+	/// </summary>
+	/// <param name="other">The tree to take the nodes from</param>
+	BinaryTree(BinaryTree<T>&& other);
+	/// <summary>
+	/// Detaches this tree's log and deletes its nodes, then takes the nodes and log of the other tree in O(1), leaving it empty
+	/// </summary>
+	/// <param name="other">The tree to take the nodes from</param>
+	BinaryTree<T>& operator=(BinaryTree<T>&& other);
+	/// <summary>
+	/// Exchanges the nodes of this tree and the other tree in O(1). Both trees should be of the same kind.
+	/// Each log goes with the nodes it recorded and is told which tree it now belongs to
+	/// </summary>
+	/// <param name="other">The tree to exchange nodes with</param>
+	void swap(BinaryTree<T>& other);
+	/// <summary>
+	/// Creates a separate copy of every node in the tree without recursion. The copies are made in a single
+	/// arena in pre-order, so the copy takes one allocation and every node sits close to its parent
+	/// </summary>
+	/// <returns>A new tree with the same shape and values, without a log or find cache</returns>
+	BinaryTree<T> clone() const;
+	/// <summary>
+	/// Deletes every node in the tree, telling the log that every copy was removed
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Returns whether or not there are any nodes in the list
+	/// </summary>
+	bool isEmpty() const;
+	/// <summary>
+	/// Returns the number of nodes in the tree. In a multiset each node is counted once, however many copies it stands for.
+	/// Takes O(1) time, except for the first call after a split or a Treap union, intersection or difference, which counts the nodes once
+	/// </summary>
+	size_t size() const;
+	/// <summary>
+	/// Returns the number of levels in the tree, which is 0 for an empty tree and 1 for a tree with only a root.
+	/// Inserting a value and the set operations keep it up to date, and so does removing a node when the nodes that
+	/// move up are leaves above the deepest level. Any other removal, or rebalancing, makes the next call walk the tree
+	/// once to measure it again, so height is O(n) after such a change
+	/// </summary>
+	size_t height() const;
+	/// <summary>
+	/// Estimates how many nodes are at each depth by following random paths down from the root, so it costs
+	/// O(sampleCount * height) however large the tree is. Each path multiplies the number of children it could have
+	/// taken at every node, which makes the average over many paths an unbiased estimate of the real counts.
+	/// Deep levels that few paths reach are the least accurate. Trees with no more nodes than the sample count are counted exactly instead
+	/// </summary>
+	/// <param name="sampleCount">The number of random paths to follow</param>
+	/// <param name="seed">The seed for picking the paths</param>
+	/// <returns>The estimated number of nodes at each depth, starting from the root at depth 0</returns>
+	std::vector<double> depthHistogram(size_t sampleCount = 256, unsigned int seed = 1) const;
+	/// <summary>
+	/// Returns whether or not this tree keeps duplicate values
+	/// </summary>
+	bool isMultiset() const;
+	/// <summary>
+	/// Returns the node at the top of the tree
+	/// </summary>
+	TreeNode<T>* getRoot() const;
+	/// <summary>
+	/// Returns the log that is told about every change to the tree, or nullptr if there isn't one
+	/// </summary>
+	TreeLog<T>* getLog() const;
+	/// <summary>
+	/// Sets the log that is told about every value inserted into or removed from the tree.
+	/// Split and join move nodes without logging them. The log that was set before is detached
+	/// </summary>
+	/// <param name="log">The log to attach, or nullptr to stop logging</param>
+	void setLog(TreeLog<T>* log);
+	/// <summary>
+	/// Keeps the nodes that were found most recently in a fixed size table, so finding them again
+	/// doesn't have to walk down from the root. Values whose type can't be hashed are never cached
+	/// </summary>
+	/// <param name="slotCount">The number of nodes the cache can hold, or 0 to turn the cache off</param>
+	void setFindCacheSize(size_t slotCount);
+	/// <summary>
+	/// Returns the cache used by find, which counts its hits and misses, or nullptr if it is off
+	/// </summary>
+	const FindCache<T>* getFindCache() const;
+	/// <summary>
+	/// Creates a new node that stores the given value and places it into the tree
+	/// </summary>
+	/// <param name="value">The new value to add to the tree</param>
+	/// <returns>The node storing the value, which is the existing node if the value was already in the tree</returns>
+	TreeNode<T>* insert(T value);
+	/// <summary>
+	/// Places the value next to the hint without searching from the root if it belongs right before or
+	/// right after it. Adding values in increasing order with the last node added as the hint takes O(1)
+	/// per value. Otherwise the value is inserted as usual
+	/// </summary>
+	/// <param name="hint">A node in the tree that is next to where the value belongs, or nullptr</param>
+	/// <param name="value">The new value to add to the tree</param>
+	/// <returns>The node storing the value, which is the existing node if the value was already in the tree</returns>
+	TreeNode<T>* insert(TreeNode<T>* hint, T value);
+	/// <summary>
+	/// Places a node that was extracted from this or another tree, without creating a new one.
+	/// If the value is already in a multiset the node's copies are added to the existing node and the
+	/// extracted node is deleted. If it is already in a set the handle keeps the node
+	/// </summary>
+	/// <param name="handle">The handle owning the node, which is left empty once the node is placed</param>
+	/// <returns>The node storing the value, which is the existing node if the value was already in the tree</returns>
+	TreeNode<T>* insert(NodeHandle<T>& handle);
+	/// <summary>
+	/// Returns the node whose value is equivalent to the key, or builds a value in place from the arguments
+	/// and adds it where the key belongs. The tree is only searched once, and the value is neither built
+	/// nor copied if the key is already in the tree. An existing value isn't counted again in a multiset
+	/// </summary>
+	/// <param name="key">The key to search for, which must order the same as the value the arguments build</param>
+	/// <param name="args">The arguments passed to the value's constructor</param>
+	/// <returns>The node storing the key's value and whether or not it was just added</returns>
+	template<typename Key, typename... Args>
+	std::pair<TreeNode<T>*, bool> tryEmplace(const Key& key, Args&&... args);
+	/// <summary>
+	/// Finds the node with the given value and removes it from the tree.
+	/// In a multiset only one copy of the value is removed
+	/// </summary>
+	/// <param name="value">The value of the node to search for in the tree</param>
+	void remove(T value);
+	/// <summary>
+	/// Removes the node from the tree and deletes it, along with every copy it stands for in a multiset.
+	/// The node's parent is already known, so the tree isn't searched
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	void erase(TreeNode<T>* node);
+	/// <summary>
+	/// Removes the node the iterator is at
+	/// </summary>
+	/// <param name="position">An iterator at a node in the tree</param>
+	/// <returns>An iterator at the node after the one removed</returns>
+	Iterator erase(Iterator position);
+	/// <summary>
+	/// Takes the node holding the value out of the tree without deleting it, along with every copy it stands for
+	/// </summary>
+	/// <param name="value">The value of the node to take out</param>
+	/// <returns>A handle owning the node, which is empty if the value isn't in the tree</returns>
+	NodeHandle<T> extract(T value);
+	/// <summary>
+	/// Takes the node out of the tree without deleting it
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	/// <returns>A handle owning the node</returns>
+	NodeHandle<T> extract(TreeNode<T>* node);
+	/// <summary>
+	/// Finds and returns a node with the given value in the tree
+	/// </summary>
+	/// <param name="value">The value of the node to search for</param>
+	TreeNode<T>* find(T value);
+	/// <summary>
+	/// Finds and returns the node whose value is equivalent to the given key.
+	/// The key only needs to be comparable with the stored values using the less than operator
+	/// </summary>
+	/// <param name="key">The key to search for</param>
+	template<typename Key>
+	TreeNode<T>* findKey(const Key& key);
+	/// <summary>
+	/// Returns how many copies of the given value are in the tree
+	/// </summary>
+	/// <param name="value">The value to count</param>
+	unsigned int count(T value);
+	/// <summary>
+	/// Returns the node with the next larger value, or nullptr if the node holds the largest value.
+	/// Follows parent links, so walking the whole tree this way costs O(1) per node on average
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	static TreeNode<T>* next(TreeNode<T>* node);
+	/// <summary>
+	/// Returns the node with the next smaller value, or nullptr if the node holds the smallest value
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	static TreeNode<T>* prev(TreeNode<T>* node);
+	/// <summary>
+	/// Returns an iterator at the smallest value
+	/// </summary>
+	Iterator begin() const;
+	/// <summary>
+	/// Returns an iterator past the largest value
+	/// </summary>
+	Iterator end() const;
+
+	/// <summary>
+	/// Moves every node with a value greater than or equal to the key into the given tree.
+	/// The nodes with values less than the key stay in this tree
+	/// </summary>
+	/// <param name="key">The value to split the tree at</param>
+	/// <param name="right">An empty tree that will receive the values greater than or equal to the key</param>
+	void split(T key, BinaryTree<T>& right);
+	/// <summary>
+	/// Moves every node of the given tree into this tree without reinserting them.
+	/// Every value in the given tree must be greater than every value in this tree
+	/// </summary>
+	/// <param name="right">The tree whose nodes will be added after the nodes of this tree</param>
+	/// <returns>Whether or not the trees were joined. Trees whose values overlap or that count duplicates differently are left as they were</returns>
+	bool join(BinaryTree<T>& right);
+
+	/// <summary>
+	/// Adds every value in the other tree to this tree. In a multiset the copies are added together.
+	/// Both trees are walked in order side by side and the result is relinked into a balanced tree
+	/// </summary>
+	/// <param name="other">The tree to take the values from, which is left unchanged</param>
+	void unionWith(const BinaryTree<T>& other);
+	/// <summary>
+	/// Keeps only the values that are also in the other tree. In a multiset the smaller count is kept
+	/// </summary>
+	/// <param name="other">The tree to compare against, which is left unchanged</param>
+	void intersect(const BinaryTree<T>& other);
+	/// <summary>
+	/// Removes every value that is in the other tree. In a multiset the other tree's copies are subtracted
+	/// </summary>
+	/// <param name="other">The tree holding the values to remove, which is left unchanged</param>
+	void difference(const BinaryTree<T>& other);
+
+	/// <summary>
+	/// Adds every value in the list to the tree. If the tree is empty and the list is sorted,
+	/// a balanced tree is linked together directly instead of inserting the values one by one
+	/// </summary>
+	/// <param name="sortedValues">The values to add, from smallest to largest</param>
+	void bulkLoad(const std::vector<T>& sortedValues);
+	/// <summary>
+	/// Reads one value per line from the stream and adds them to the tree as they are read, so only one block
+	/// of the stream is held in memory. The stream is read in fixed size blocks and integers are parsed without
+	/// going through the stream. Sorted values read into an empty tree are chained onto the largest node and
+	/// rebalanced in place once the stream ends. Values that arrive out of order, or that are read into a tree
+	/// that already has nodes, are inserted one by one, so the shape then depends on their order like any insert
+	/// </summary>
+	/// <param name="stream">The stream to read the values from</param>
+	/// <returns>Whether or not every line could be read as a value</returns>
+	bool loadFrom(std::istream& stream);
+	/// <summary>
+	/// Writes every value in the tree to the stream from smallest to largest, one per line
+	/// </summary>
+	/// <param name="stream">The stream to write the values to</param>
+	/// <returns>Whether or not every value could be written</returns>
+	bool saveTo(std::ostream& stream) const;
+
+protected:
+	/// <summary>
+	/// Called on every node whose subtree changed, children before parents.
+	/// Augmented trees override this to refresh the data they keep about each subtree
+	/// </summary>
+	/// <param name="node">The node to refresh</param>
+	virtual void updateNode(TreeNode<T>*) {}
+
+	/// <summary>
+	/// Makes the given node the top of the tree. Used by trees that rearrange their own nodes
+	/// </summary>
+	/// <param name="node">The new root</param>
+	void setRoot(TreeNode<T>* node);
+	/// <summary>
+	/// Returns the node with the largest value, which hinted inserts and split rely on
+	/// </summary>
+	TreeNode<T>* getLargestNode() const;
+	/// <summary>
+	/// Records which node has the largest value. Trees that link or unlink nodes themselves must keep it
+	/// current, since the inherited split, hinted insert and bulkLoad read it
+	/// </summary>
+	/// <param name="node">The node with the largest value, or nullptr if the tree is empty</param>
+	void setLargestNode(TreeNode<T>* node);
+	/// <summary>
+	/// Removes the node from the find cache. Used by trees that unlink nodes themselves
+	/// </summary>
+	/// <param name="node">The node that is leaving the tree</param>
+	void forgetCachedNode(TreeNode<T>* node);
+	/// <summary>
+	/// Empties the find cache. Used by trees that move many nodes at once
+	/// </summary>
+	void clearFindCache();
+	/// <summary>
+	/// Changes the number of nodes the tree has. Used by trees that create or delete nodes themselves
+	/// </summary>
+	/// <param name="change">The number of nodes added, or removed if negative</param>
+	void adjustSize(std::ptrdiff_t change);
+	/// <summary>
+	/// Makes the next call to size count the nodes. Used after moving an unknown number of nodes
+	/// </summary>
+	void forgetSize();
+	/// <summary>
+	/// Adds the nodes of the other tree to this tree's size. Used when every node of the other tree moves over
+	/// </summary>
+	/// <param name="other">The tree the nodes came from, before it is emptied</param>
+	void takeSize(const BinaryTree<T>& other);
+	/// <summary>
+	/// Makes the next call to height measure the tree. Used after nodes are moved around
+	/// </summary>
+	void forgetHeight();
+	/// <summary>
+	/// Returns whether or not unlinking the node by moving its successor or only child up could lower the height.
+	/// Only the nodes below it move up, so the height is kept when those are leaves above the deepest level.
+	/// Climbs to the root to find their depth, which is only done while the height is known
+	/// </summary>
+	/// <param name="nodeToRemove">A node in the tree</param>
+	bool canLowerHeight(TreeNode<T>* nodeToRemove) const;
+	/// <summary>
+	/// Keeps the arenas of the other tree alive for as long as this tree. Used when nodes move over from the other tree
+	/// </summary>
+	/// <param name="other">The tree the nodes came from</param>
+	void shareArenas(const BinaryTree<T>& other);
+	/// <summary>
+	/// Copies every node of this tree into the given empty tree. Used by trees that return their own kind from clone
+	/// </summary>
+	/// <param name="copy">An empty tree that counts duplicates the same way as this tree</param>
+	void cloneInto(BinaryTree<T>& copy) const;
+	/// <summary>
+	/// Reads one value per line from the stream, handing each one over as soon as its line is parsed.
+	/// Used by loadFrom, and by trees that load the values their own way
+	/// </summary>
+	/// <param name="stream">The stream to read the values from</param>
+	/// <param name="visitor">Called with every value, in the order they appear</param>
+	/// <returns>Whether or not every line could be read as a value</returns>
+	template<typename Visitor>
+	static bool readValues(std::istream& stream, Visitor visitor);
+
+	/// <summary>
+	/// Whether or not updateNode needs to be called when the tree changes
+	/// </summary>
+	bool m_isAugmented = false;
+
+private:
+	/// <summary>
+	/// Deletes every node in the tree without telling the log
+	/// </summary>
+	void deleteAllNodes();
+	/// <summary>
+	/// Takes the node out of the tree, telling the log that its copies were removed, and clears its links
+	/// </summary>
+	/// <param name="nodeToRemove">A node in the tree</param>
+	void unlinkNode(TreeNode<T>* nodeToRemove);
+
+	/// <summary>
+	/// Calls updateNode on the given node and every node above it, starting from the bottom
+	/// </summary>
+	/// <param name="node">The lowest node whose subtree changed</param>
+	void updatePath(TreeNode<T>* node);
+
+	/// <summary>
+	/// Links the given nodes into a balanced subtree and returns its root
+	/// </summary>
+	/// <param name="nodes">The nodes in sorted order</param>
+	/// <param name="first">The index of the first node in the subtree</param>
+	/// <param name="last">The index after the last node in the subtree</param>
+	TreeNode<T>* linkBalanced(std::vector<TreeNode<T>*>& nodes, size_t first, size_t last);
+
+	/// <summary>
+	/// Adds every node of the subtree to the list from smallest to largest
+	/// </summary>
+	static void collectInOrder(TreeNode<T>* node, std::vector<TreeNode<T>*>& nodes);
+	/// <summary>
+	/// Makes the given nodes, in sorted order, the whole tree
+	/// </summary>
+	void relinkAll(std::vector<TreeNode<T>*>& nodes);
+	/// <summary>
+	/// Rebalances a tree whose nodes all hang to the right of each other, in place and without extra memory,
+	/// using the rotations of the Day-Stout-Warren algorithm
+	/// </summary>
+	/// <param name="nodeCount">The number of nodes in the tree</param>
+	void balanceVine(size_t nodeCount);
+	/// <summary>
+	/// Rotates every other node of the tree's right edge to the left, starting at the root
+	/// </summary>
+	/// <param name="rotationCount">The number of rotations to make</param>
+	void rotateVine(size_t rotationCount);
+	/// <summary>
+	/// Walks the tree once to count its nodes and measure its height
+	/// </summary>
+	void measureShape() const;
+
+	/// <summary>
+	/// Reads a value from the characters of a single line
+	/// </summary>
+	/// <returns>Whether or not the line held a value</returns>
+	static bool parseValue(const char* begin, const char* end, T& value);
+
+	TreeNode<T>* m_root = nullptr;
+	//The node with the largest value, so values added in increasing order can be placed without searching
+	TreeNode<T>* m_largestNode = nullptr;
+	bool m_isMultiset = false;
+	TreeLog<T>* m_log = nullptr;
+	std::unique_ptr<FindCache<T>> m_findCache;
+	//The shape of the tree, which is measured again only when an operation couldn't keep track of it
+	mutable size_t m_size = 0;
+	mutable size_t m_height = 0;
+	mutable bool m_isSizeKnown = true;
+	mutable bool m_isHeightKnown = true;
+	//The arenas that nodes of this tree may live in, which can't be freed until those nodes are gone
+	std::vector<std::shared_ptr<NodeArena<T>>> m_arenas;
+};
+#endif
+
+template<typename T>
+inline BinaryTree<T>::BinaryTree()
+{
+	m_root = nullptr;
+}
+
+template<typename T>
+inline BinaryTree<T>::BinaryTree(bool isMultiset)
+{
+	m_root = nullptr;
+	m_isMultiset = isMultiset;
+}
+
+template<typename T>
+inline BinaryTree<T>::~BinaryTree()
+{
+	//The log may outlive the tree, so it must not keep pointing at it
+	setLog(nullptr);
+	deleteAllNodes();
+}
+
+template<typename T>
+inline BinaryTree<T>::BinaryTree(BinaryTree<T>&& other)
+{
+	//A derived tree that is moved doesn't run its own constructor, so it takes the setting from the other tree
+	m_isAugmented = other.m_isAugmented;
+	swap(other);
+}
+
+template<typename T>
+inline BinaryTree<T>& BinaryTree<T>::operator=(BinaryTree<T>&& other)
+{
+	if (&other != this)
+	{
+		//The nodes are deleted without being logged, so the log is let go before they are
+		setLog(nullptr);
+		deleteAllNodes();
+		swap(other);
+	}
+	return *this;
+}
+
+template<typename T>
+inline void BinaryTree<T>::swap(BinaryTree<T>& other)
+{
+	//The cache only holds nodes, so it goes with them
+	std::swap(m_root, other.m_root);
+	std::swap(m_largestNode, other.m_largestNode);
+	std::swap(m_isMultiset, other.m_isMultiset);
+	std::swap(m_findCache, other.m_findCache);
+	std::swap(m_arenas, other.m_arenas);
+	std::swap(m_size, other.m_size);
+	std::swap(m_height, other.m_height);
+	std::swap(m_isSizeKnown, other.m_isSizeKnown);
+	std::swap(m_isHeightKnown, other.m_isHeightKnown);
+
+	//A log records the values of the nodes, so it goes with them
+	std::swap(m_log, other.m_log);
+	if (m_log)
+		m_log->moveTree(*this);
+	if (other.m_log)
+		other.m_log->moveTree(other);
+}
+
+template<typename T>
+inline BinaryTree<T> BinaryTree<T>::clone() const
+{
+	BinaryTree<T> copy(m_isMultiset);
+	cloneInto(copy);
+	return copy;
+}
+
+template<typename T>
+inline void BinaryTree<T>::cloneInto(BinaryTree<T>& copy) const
+{
+	if (!m_root)
+		return;
+
+	//All of the copies fit in one arena, and the copy has the same shape as this tree
+	std::shared_ptr<NodeArena<T>> arena = std::make_shared<NodeArena<T>>(size());
+	copy.m_arenas.push_back(arena);
+
+	TreeNode<T>* sourceNode = m_root;
+	TreeNode<T>* copyNode = arena->createNode(m_root->getData());
+	copyNode->setCount(m_root->getCount());
+	copyNode->setPriority(m_root->getPriority());
+	copy.setRoot(copyNode);
+
+	//Walks both trees side by side. A child that hasn't been copied yet is copied and walked into,
+	//and once both children are done the walk climbs back up both trees. Nodes are copied in pre-order,
+	//so each node's left child sits right after it in the arena
+	while (true)
+	{
+		if (sourceNode == m_largestNode)
+			copy.m_largestNode = copyNode;
+
+		TreeNode<T>* sourceChild = nullptr;
+		bool isLeftChild = false;
+		if (sourceNode->hasLeft() && !copyNode->hasLeft())
+		{
+			sourceChild = sourceNode->getLeft();
+			isLeftChild = true;
+		}
+		else if (sourceNode->hasRight() && !copyNode->hasRight())
+			sourceChild = sourceNode->getRight();
+
+		if (sourceChild)
+		{
+			TreeNode<T>* copyChild = arena->createNode(sourceChild->getData());
+			copyChild->setCount(sourceChild->getCount());
+			copyChild->setPriority(sourceChild->getPriority());
+			if (isLeftChild)
+				copyNode->setLeft(copyChild);
+			else
+				copyNode->setRight(copyChild);
+
+			sourceNode = sourceChild;
+			copyNode = copyChild;
+		}
+		else if (sourceNode == m_root)
+			break;
+		else
+		{
+			sourceNode = sourceNode->getParent();
+			copyNode = copyNode->getParent();
+		}
+	}
+
+	copy.m_size = m_size;
+	copy.m_height = m_height;
+	copy.m_isHeightKnown = m_isHeightKnown;
+}
+
+template<typename T>
+inline void BinaryTree<T>::clear()
+{
+	if (m_log)
+	{
+		TreeTraversal<T>::inOrder(m_root, [&](TreeNode<T>* node, size_t)
+		{
+			for (unsigned int i = 0; i < node->getCount(); i++)
+				m_log->logRemove(node->getData());
+		});
+	}
+
+	deleteAllNodes();
+}
+
+template<typename T>
+inline void BinaryTree<T>::deleteAllNodes()
+{
+	TreeTraversal<T>::postOrder(m_root, [](TreeNode<T>* node, size_t)
+	{
+		NodeArena<T>::destroyNode(node);
+	});
+
+	setRoot(nullptr);
+	m_largestNode = nullptr;
+	clearFindCache();
+
+	//With no nodes left, none of the arenas are needed
+	m_arenas.clear();
+}
+
+template<typename T>
+inline bool BinaryTree<T>::isEmpty() const
+{
+	return m_root == nullptr;
+}
+
+template<typename T>
+inline size_t BinaryTree<T>::size() const
+{
+	if (!m_isSizeKnown)
+		measureShape();
+	return m_size;
+}
+
+template<typename T>
+inline size_t BinaryTree<T>::height() const
+{
+	if (!m_isHeightKnown)
+		measureShape();
+	return m_height;
+}
+
+template<typename T>
+inline std::vector<double> BinaryTree<T>::depthHistogram(size_t sampleCount, unsigned int seed) const
+{
+	std::vector<double> nodesAtDepth;
+
+	//A small tree is cheaper to count than to sample
+	if (m_isSizeKnown && m_size <= sampleCount)
+	{
+		TreeTraversal<T>::preOrder(m_root, [&](TreeNode<T>*, size_t depth)
+		{
+			if (depth >= nodesAtDepth.size())
+				nodesAtDepth.resize(depth + 1, 0.0);
+			nodesAtDepth[depth]++;
+		});
+		return nodesAtDepth;
+	}
+
+	std::minstd_rand random(seed);
+	for (size_t sample = 0; sample < sampleCount; sample++)
+	{
+		//Every node on the path stands for as many nodes as there were ways to reach it
+		double weight = 1.0;
+		size_t depth = 0;
+		TreeNode<T>* currentNode = m_root;
+		while (currentNode)
+		{
+			if (depth >= nodesAtDepth.size())
+				nodesAtDepth.resize(depth + 1, 0.0);
+			nodesAtDepth[depth] += weight;
+
+			if (currentNode->hasLeft() && currentNode->hasRight())
+			{
+				weight *= 2.0;
+				currentNode = random() % 2 == 0 ? currentNode->getLeft() : currentNode->getRight();
+			}
+			else
+				currentNode = currentNode->hasLeft() ? currentNode->getLeft() : currentNode->getRight();
+			depth++;
+		}
+	}
+
+	for (double& nodeCount : nodesAtDepth)
+		nodeCount /= (double)sampleCount;
+	return nodesAtDepth;
+}
+
+template<typename T>
+inline bool BinaryTree<T>::isMultiset() const
+{
+	return m_isMultiset;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::getRoot() const
+{
+	return m_root;
+}
+
+template<typename T>
+inline void BinaryTree<T>::setRoot(TreeNode<T>* node)
+{
+	m_root = node;
+	if (node)
+		node->setParent(nullptr);
+
+	//A tree without a root has no nodes
+	else
+	{
+		m_largestNode = nullptr;
+		m_size = 0;
+		m_height = 0;
+		m_isSizeKnown = true;
+		m_isHeightKnown = true;
+	}
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::getLargestNode() const
+{
+	return m_largestNode;
+}
+
+template<typename T>
+inline void BinaryTree<T>::setLargestNode(TreeNode<T>* node)
+{
+	m_largestNode = node;
+}
+
+template<typename T>
+inline void BinaryTree<T>::forgetCachedNode(TreeNode<T>* node)
+{
+	if (m_findCache)
+		m_findCache->invalidate(node);
+}
+
+template<typename T>
+inline void BinaryTree<T>::clearFindCache()
+{
+	if (m_findCache)
+		m_findCache->clear();
+}
+
+template<typename T>
+inline void BinaryTree<T>::adjustSize(std::ptrdiff_t change)
+{
+	if (m_isSizeKnown)
+		m_size = (size_t)((std::ptrdiff_t)m_size + change);
+}
+
+template<typename T>
+inline void BinaryTree<T>::forgetSize()
+{
+	m_isSizeKnown = false;
+}
+
+template<typename T>
+inline void BinaryTree<T>::takeSize(const BinaryTree<T>& other)
+{
+	if (m_isSizeKnown && other.m_isSizeKnown)
+		m_size += other.m_size;
+	else
+		m_isSizeKnown = false;
+}
+
+template<typename T>
+inline void BinaryTree<T>::forgetHeight()
+{
+	m_isHeightKnown = false;
+}
+
+template<typename T>
+inline void BinaryTree<T>::shareArenas(const BinaryTree<T>& other)
+{
+	for (const std::shared_ptr<NodeArena<T>>& arena : other.m_arenas)
+	{
+		if (std::find(m_arenas.begin(), m_arenas.end(), arena) == m_arenas.end())
+			m_arenas.push_back(arena);
+	}
+}
+
+template<typename T>
+template<typename Visitor>
+inline bool BinaryTree<T>::readValues(std::istream& stream, Visitor visitor)
+{
+	const size_t bufferSize = 1 << 16;
+	std::vector<char> buffer(bufferSize);
+	std::string partialLine;
+	bool succeeded = true;
+	T value = T();
+
+	//Reads the stream one block at a time, parsing every full line in the block
+	while (stream)
+	{
+		stream.read(buffer.data(), bufferSize);
+		size_t bytesRead = (size_t)stream.gcount();
+		if (bytesRead == 0)
+			break;
+
+		const char* lineStart = buffer.data();
+		const char* blockEnd = lineStart + bytesRead;
+		while (lineStart < blockEnd)
+		{
+			const char* lineEnd = (const char*)memchr(lineStart, '\n', blockEnd - lineStart);
+
+			//Keeps the end of the block for the next one if the line continues there
+			if (!lineEnd)
+			{
+				partialLine.append(lineStart, blockEnd);
+				break;
+			}
+
+			//A line that started in an earlier block is put back together first
+			const char* textStart = lineStart;
+			const char* textEnd = lineEnd;
+			if (!partialLine.empty())
+			{
+				partialLine.append(lineStart, lineEnd);
+				textStart = partialLine.data();
+				textEnd = textStart + partialLine.size();
+			}
+
+			//Only a line that is blank once put back together may hold no value
+			if (parseValue(textStart, textEnd, value))
+				visitor(value);
+			else if (textEnd != textStart && !(textEnd - textStart == 1 && *textStart == '\r'))
+				succeeded = false;
+
+			partialLine.clear();
+			lineStart = lineEnd + 1;
+		}
+	}
+
+	//Parses the last line if the stream didn't end with a new line
+	if (!partialLine.empty())
+	{
+		if (parseValue(partialLine.data(), partialLine.data() + partialLine.size(), value))
+			visitor(value);
+		else
+			succeeded = false;
+	}
+
+	return succeeded && !stream.bad();
+}
+
+template<typename T>
+inline TreeLog<T>* BinaryTree<T>::getLog() const
+{
+	return m_log;
+}
+
+template<typename T>
+inline void BinaryTree<T>::setLog(TreeLog<T>* log)
+{
+	TreeLog<T>* oldLog = m_log;
+	m_log = log;
+	if (oldLog && oldLog != log)
+		oldLog->detachTree();
+}
+
+template<typename T>
+inline void BinaryTree<T>::setFindCacheSize(size_t slotCount)
+{
+	if (slotCount > 0 && FindCache<T>::IS_SUPPORTED)
+		m_findCache.reset(new FindCache<T>(slotCount));
+	else
+		m_findCache.reset();
+}
+
+template<typename T>
+inline const FindCache<T>* BinaryTree<T>::getFindCache() const
+{
+	return m_findCache.get();
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::insert(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+
+	//Creates pointer for the current node and its parent
+	TreeNode<T>* currentNode = m_root;
+	TreeNode<T>* parentNode = nullptr;
+	size_t depth = 0;
+
+	//While the current node exists
+	while (currentNode)
+	{
+		//Makes the parent node become the current node
+		parentNode = currentNode;
+		depth++;
+		TREE_STATS_VISIT();
+
+		//If the current node's value is less than the inserted value, move the current node to the right
+		if (TREE_STATS_COMPARE(currentNode->getData() < value))
+			currentNode = currentNode->getRight();
+
+		//If the current node's value is greater than the inserted value, move the current node to the left
+		else if (TREE_STATS_COMPARE(currentNode->getData() > value))
+			currentNode = currentNode->getLeft();
+
+		//Return the existing node if the value is already in the tree, counting the copy in a multiset
+		else
+		{
+			if (m_isMultiset)
+			{
+				if (m_log)
+					m_log->logInsert(value);
+				currentNode->setCount(currentNode->getCount() + 1);
+				updatePath(currentNode);
+			}
+			return currentNode;
+		}
+	}
+
+	//Make the current node become a node with the value to be inserted
+	if (m_log)
+		m_log->logInsert(value);
+	TREE_STATS_ALLOCATION();
+	currentNode = new TreeNode<T>(std::move(value));
+
+	///If the parent node exist, make the inserted node a leaf of the node
+	if (parentNode)
+	{
+		if (TREE_STATS_COMPARE(parentNode->getData() > currentNode->getData()))
+			parentNode->setLeft(currentNode);
+		else
+			parentNode->setRight(currentNode);
+	}
+	else
+		setRoot(currentNode);
+
+	if (!m_largestNode || m_largestNode->getData() < currentNode->getData())
+		m_largestNode = currentNode;
+
+	//A new leaf doesn't move any other node, so the height only changes if the leaf is deeper than the rest
+	adjustSize(1);
+	if (depth + 1 > m_height)
+		m_height = depth + 1;
+
+	updatePath(currentNode);
+	return currentNode;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::insert(TreeNode<T>* hint, T value)
+{
+	if (!hint)
+		return insert(value);
+
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TreeNode<T>* parentNode = nullptr;
+	bool isLeftChild = false;
+
+	//If the value comes after the hint, it belongs before the next node
+	if (TREE_STATS_COMPARE(hint->getData() < value))
+	{
+		//The largest node has nothing after it, which is what makes adding values in order cheap
+		TreeNode<T>* nextNode = hint == m_largestNode ? nullptr : next(hint);
+		if (nextNode && !TREE_STATS_COMPARE(value < nextNode->getData()))
+			return insert(value);
+
+		//The new node goes on whichever side of the two neighbours is free
+		if (!hint->hasRight())
+			parentNode = hint;
+		else
+		{
+			parentNode = nextNode;
+			isLeftChild = true;
+		}
+	}
+
+	//If the value comes before the hint, it belongs after the previous node
+	else if (TREE_STATS_COMPARE(value < hint->getData()))
+	{
+		TreeNode<T>* prevNode = prev(hint);
+		if (prevNode && !TREE_STATS_COMPARE(prevNode->getData() < value))
+			return insert(value);
+
+		if (!hint->hasLeft())
+		{
+			parentNode = hint;
+			isLeftChild = true;
+		}
+		else
+			parentNode = prevNode;
+	}
+
+	//The hint holds the value already
+	else
+	{
+		if (m_isMultiset)
+		{
+			if (m_log)
+				m_log->logInsert(value);
+			hint->setCount(hint->getCount() + 1);
+			updatePath(hint);
+		}
+		return hint;
+	}
+
+	if (m_log)
+		m_log->logInsert(value);
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* newNode = new TreeNode<T>(std::move(value));
+
+	if (isLeftChild)
+		parentNode->setLeft(newNode);
+	else
+		parentNode->setRight(newNode);
+
+	if (m_largestNode->getData() < newNode->getData())
+		m_largestNode = newNode;
+
+	//The depth of the new node isn't known without climbing to the root, which would undo the point of the hint
+	adjustSize(1);
+	forgetHeight();
+
+	updatePath(newNode);
+	return newNode;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::insert(NodeHandle<T>& handle)
+{
+	if (handle.isEmpty())
+		return nullptr;
+
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TreeNode<T>* node = handle.getNode();
+	TreeNode<T>* currentNode = m_root;
+	TreeNode<T>* parentNode = nullptr;
+	size_t depth = 0;
+
+	//Walks down to where the node belongs
+	while (currentNode)
+	{
+		parentNode = currentNode;
+		depth++;
+		TREE_STATS_VISIT();
+		if (TREE_STATS_COMPARE(currentNode->getData() < node->getData()))
+			currentNode = currentNode->getRight();
+		else if (TREE_STATS_COMPARE(node->getData() < currentNode->getData()))
+			currentNode = currentNode->getLeft();
+
+		//A multiset takes the copies and the extra node is no longer needed
+		else
+		{
+			if (m_isMultiset)
+			{
+				if (m_log)
+				{
+					for (unsigned int i = 0; i < node->getCount(); i++)
+						m_log->logInsert(node->getData());
+				}
+				currentNode->setCount(currentNode->getCount() + node->getCount());
+				updatePath(currentNode);
+				handle = NodeHandle<T>();
+			}
+			return currentNode;
+		}
+	}
+
+	//A set only keeps one copy of every value
+	if (!m_isMultiset)
+		node->setCount(1);
+
+	if (m_log)
+	{
+		for (unsigned int i = 0; i < node->getCount(); i++)
+			m_log->logInsert(node->getData());
+	}
+
+	handle.release();
+	if (!parentNode)
+		setRoot(node);
+	else if (TREE_STATS_COMPARE(node->getData() < parentNode->getData()))
+		parentNode->setLeft(node);
+	else
+		parentNode->setRight(node);
+
+	if (!m_largestNode || m_largestNode->getData() < node->getData())
+		m_largestNode = node;
+
+	adjustSize(1);
+	if (depth + 1 > m_height)
+		m_height = depth + 1;
+
+	updatePath(node);
+	return node;
+}
+
+template<typename T>
+template<typename Key, typename... Args>
+inline std::pair<TreeNode<T>*, bool> BinaryTree<T>::tryEmplace(const Key& key, Args&&... args)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TreeNode<T>* currentNode = m_root;
+	TreeNode<T>* parentNode = nullptr;
+	bool isLeftChild = false;
+	size_t depth = 0;
+
+	//Walks down to where the key belongs, stopping early if it is already there
+	while (currentNode)
+	{
+		parentNode = currentNode;
+		depth++;
+		TREE_STATS_VISIT();
+		if (TREE_STATS_COMPARE(currentNode->getData() < key))
+		{
+			currentNode = currentNode->getRight();
+			isLeftChild = false;
+		}
+		else if (TREE_STATS_COMPARE(key < currentNode->getData()))
+		{
+			currentNode = currentNode->getLeft();
+			isLeftChild = true;
+		}
+		else
+			return std::pair<TreeNode<T>*, bool>(currentNode, false);
+	}
+
+	//The value is built straight into the new node
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* newNode = new TreeNode<T>(std::in_place, std::forward<Args>(args)...);
+	if (m_log)
+		m_log->logInsert(newNode->getData());
+
+	if (!parentNode)
+		setRoot(newNode);
+	else if (isLeftChild)
+		parentNode->setLeft(newNode);
+	else
+		parentNode->setRight(newNode);
+
+	if (!m_largestNode || m_largestNode->getData() < newNode->getData())
+		m_largestNode = newNode;
+
+	adjustSize(1);
+	if (depth + 1 > m_height)
+		m_height = depth + 1;
+
+	updatePath(newNode);
+	return std::pair<TreeNode<T>*, bool>(newNode, true);
+}
+
+template<typename T>
+inline void BinaryTree<T>::remove(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+
+	//Return if the value is not in the tree
+	TreeNode<T>* nodeToRemove = find(value);
+	if (!nodeToRemove)
+		return;
+
+	//If the node stands for more than one copy, only remove one of them
+	if (nodeToRemove->getCount() > 1)
+	{
+		if (m_log)
+			m_log->logRemove(value);
+		nodeToRemove->setCount(nodeToRemove->getCount() - 1);
+		updatePath(nodeToRemove);
+		return;
+	}
+
+	erase(nodeToRemove);
+}
+
+template<typename T>
+inline void BinaryTree<T>::erase(TreeNode<T>* nodeToRemove)
+{
+	if (!nodeToRemove)
+		return;
+
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	unlinkNode(nodeToRemove);
+	NodeArena<T>::destroyNode(nodeToRemove);
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator BinaryTree<T>::erase(Iterator position)
+{
+	TreeNode<T>* nodeToRemove = position.getNode();
+	++position;
+	erase(nodeToRemove);
+	return position;
+}
+
+template<typename T>
+inline NodeHandle<T> BinaryTree<T>::extract(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	return extract(find(value));
+}
+
+template<typename T>
+inline NodeHandle<T> BinaryTree<T>::extract(TreeNode<T>* node)
+{
+	if (!node)
+		return NodeHandle<T>();
+
+	//A node in an arena can't be owned on its own, so the handle gets a copy of it instead
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	unlinkNode(node);
+	return NodeHandle<T>(NodeArena<T>::moveOutOfArena(node));
+}
+
+template<typename T>
+inline void BinaryTree<T>::unlinkNode(TreeNode<T>* nodeToRemove)
+{
+	if (m_log)
+	{
+		for (unsigned int i = 0; i < nodeToRemove->getCount(); i++)
+			m_log->logRemove(nodeToRemove->getData());
+	}
+
+	if (nodeToRemove == m_largestNode)
+		m_largestNode = prev(nodeToRemove);
+
+	adjustSize(-1);
+	if (canLowerHeight(nodeToRemove))
+		forgetHeight();
+
+	TreeNode<T>* parentNode = nodeToRemove->getParent();
+
+	//The lowest node whose subtree will change
+	TreeNode<T>* lowestChangedNode = parentNode;
+
+	//If the node has two leaves
+	if (nodeToRemove->hasLeft() && nodeToRemove->hasRight())
+	{
+		//Create a pointer to nodes to replace the node to remove
+		TreeNode<T>* replacementNode = nodeToRemove->getRight();
+		TreeNode<T>* replacementParent = nodeToRemove;
+
+		while (replacementNode->hasLeft())
+		{
+			//Makes the parent of the replacement node equal to its leaf, then moves its leaf to the left
+			replacementParent = replacementNode;
+			replacementNode = replacementNode->getLeft();
+		}
+
+		//Change the removed node with the replacement node
+		if (replacementParent != nodeToRemove)
+		{
+			replacementParent->setLeft(replacementNode->getRight());
+			replacementNode->setRight(nodeToRemove->getRight());
+			lowestChangedNode = replacementParent;
+		}
+		else
+			lowestChangedNode = replacementNode;
+		replacementNode->setLeft(nodeToRemove->getLeft());
+
+		//If the removed node had a parent
+		if (parentNode)
+		{
+			//Make the parent's leaf become the replacement node
+			if (parentNode->getLeft() == nodeToRemove)
+				parentNode->setLeft(replacementNode);
+			else
+				parentNode->setRight(replacementNode);
+		}
+		else
+			setRoot(replacementNode);
+	}
+
+	//If it only has one leaf
+	else if (nodeToRemove->hasLeft() || nodeToRemove->hasRight())
+	{
+		//If the current node has no parent node
+		if (!parentNode)
+		{
+			//Sets the leaf to be the root node
+			if (nodeToRemove->hasLeft())
+				setRoot(nodeToRemove->getLeft());
+			else
+				setRoot(nodeToRemove->getRight());
+		}
+
+		//If the parent's left leaf is the node to remove
+		else if (parentNode->getLeft() == nodeToRemove)
+		{
+			//Set the parent's left leaf to be the leaf of the removed node
+			if (nodeToRemove->hasLeft())
+				parentNode->setLeft(nodeToRemove->getLeft());
+			else
+				parentNode->setLeft(nodeToRemove->getRight());
+		}
+
+		//If the parent's right leaf is the node to remove
+		else if (parentNode->getRight() == nodeToRemove)
+		{
+			//Set the parent's right leaf to be the leaf of the removed node
+			if (nodeToRemove->hasLeft())
+				parentNode->setRight(nodeToRemove->getLeft());
+			else
+				parentNode->setRight(nodeToRemove->getRight());
+		}
+	}
+
+	//If the node has no leaves but isn't the root node
+	else if (parentNode != nullptr)
+	{
+		//If the parent's left leaf is the node to remove
+		if (parentNode->getLeft() == nodeToRemove)
+				parentNode->setLeft(nullptr);
+
+		//If the parent's right leaf is the node to remove
+		else if (parentNode->getRight() == nodeToRemove)
+				parentNode->setRight(nullptr);
+	}
+	else
+		setRoot(nullptr);
+
+	updatePath(lowestChangedNode);
+
+	forgetCachedNode(nodeToRemove);
+
+	//Cuts the node's links so it can be placed somewhere else
+	nodeToRemove->setLeft(nullptr);
+	nodeToRemove->setRight(nullptr);
+	nodeToRemove->setParent(nullptr);
+}
+
+template<typename T>
+inline bool BinaryTree<T>::canLowerHeight(TreeNode<T>* nodeToRemove) const
+{
+	if (!m_isHeightKnown)
+		return false;
+
+	//Finds the node that moves up from the deepest place. A successor moves up along with its right child,
+	//and an only child moves up along with its whole subtree, so either has to be a leaf to be the deepest
+	TreeNode<T>* lowestNode = nodeToRemove;
+	if (nodeToRemove->hasLeft() && nodeToRemove->hasRight())
+	{
+		lowestNode = nodeToRemove->getRight();
+		while (lowestNode->hasLeft())
+			lowestNode = lowestNode->getLeft();
+		if (lowestNode->hasRight())
+			lowestNode = lowestNode->getRight();
+	}
+	else if (nodeToRemove->hasLeft() || nodeToRemove->hasRight())
+		lowestNode = nodeToRemove->hasLeft() ? nodeToRemove->getLeft() : nodeToRemove->getRight();
+	if (lowestNode->hasLeft() || lowestNode->hasRight())
+		return true;
+
+	//Another leaf may be just as deep, but that can't be known without looking, so only shallower leaves keep the height
+	size_t depth = 0;
+	for (TreeNode<T>* node = lowestNode; node->getParent(); node = node->getParent())
+		depth++;
+	return depth + 1 >= m_height;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::find(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Find);
+	if (!m_findCache)
+		return findKey(value);
+
+	//Return the cached node if the value was found recently
+	TreeNode<T>* node = m_findCache->lookup(value);
+	if (node)
+		return node;
+
+	node = findKey(value);
+	if (node)
+		m_findCache->store(value, node);
+	return node;
+}
+
+template<typename T>
+template<typename Key>
+inline TreeNode<T>* BinaryTree<T>::findKey(const Key& key)
+{
+	TREE_STATS_OPERATION(TreeOperation::Find);
+
+	//Create a pointer for the node to return
+	TreeNode<T>* currentNode = m_root;
+
+	//While the current node exists
+	while (currentNode)
+	{
+		TREE_STATS_VISIT();
+
+		//If the current node's value is less than the key to find
+		if (TREE_STATS_COMPARE(currentNode->getData() < key))
+			//Make the current value the next node to the right
+			currentNode = currentNode->getRight();
+		//If the current node's value is greater than the key to find
+		else if (TREE_STATS_COMPARE(key < currentNode->getData()))
+			//Make the current value the next node to the left
+			currentNode = currentNode->getLeft();
+		//If the current node's value matches the key to find
+		else
+			break;
+	}
+
+	//return the found node
+	return currentNode;
+}
+
+template<typename T>
+inline unsigned int BinaryTree<T>::count(T value)
+{
+	TreeNode<T>* node = find(value);
+	return node ? node->getCount() : 0;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::next(TreeNode<T>* node)
+{
+	//The next value is the smallest one in the right subtree if there is one
+	if (node->hasRight())
+	{
+		node = node->getRight();
+		while (node->hasLeft())
+			node = node->getLeft();
+		return node;
+	}
+
+	//Otherwise it is the first parent reached from its left side
+	TreeNode<T>* parentNode = node->getParent();
+	while (parentNode && parentNode->getRight() == node)
+	{
+		node = parentNode;
+		parentNode = parentNode->getParent();
+	}
+	return parentNode;
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::prev(TreeNode<T>* node)
+{
+	//The previous value is the largest one in the left subtree if there is one
+	if (node->hasLeft())
+	{
+		node = node->getLeft();
+		while (node->hasRight())
+			node = node->getRight();
+		return node;
+	}
+
+	//Otherwise it is the first parent reached from its right side
+	TreeNode<T>* parentNode = node->getParent();
+	while (parentNode && parentNode->getLeft() == node)
+	{
+		node = parentNode;
+		parentNode = parentNode->getParent();
+	}
+	return parentNode;
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator BinaryTree<T>::begin() const
+{
+	TreeNode<T>* node = m_root;
+	while (node && node->hasLeft())
+		node = node->getLeft();
+	return Iterator(node, this);
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator BinaryTree<T>::end() const
+{
+	return Iterator(nullptr, this);
+}
+
+template<typename T>
+inline BinaryTree<T>::Iterator::Iterator(TreeNode<T>* node, const BinaryTree<T>* tree) : m_node(node), m_tree(tree)
+{
+}
+
+template<typename T>
+inline const T& BinaryTree<T>::Iterator::operator*() const
+{
+	return m_node->getData();
+}
+
+template<typename T>
+inline const T* BinaryTree<T>::Iterator::operator->() const
+{
+	return &m_node->getData();
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator& BinaryTree<T>::Iterator::operator++()
+{
+	m_node = BinaryTree<T>::next(m_node);
+	return *this;
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator BinaryTree<T>::Iterator::operator++(int)
 {
-public:
-
-	BinaryTree();
-	~BinaryTree() {}
-
-	/// <summary>
-	/// Returns whether or not there are any nodes in the list
-	/// </summary>
-	bool isEmpty() const;
-	/// <summary>
-	/// Creates a new node that stores the given value and places it into the tree
-	/// </summary>
-	/// <param name="value">The new value to add to the tree</param>
-	void insert(T value);
-	/// <summary>
-	/// Finds the node with the given value and removes it from the tree
-	/// </summary>
-	/// <param name="value">The value of the node to search for in the tree</param>
-	void remove(T value);
-	/// <summary>
-	/// Finds and returns a node with the given value in the tree
-	/// </summary>
-	/// <param name="value">The value of the node to search for</param>
-	TreeNode<T>* find(T value);
-
-	void draw(TreeNode<T>* selected = nullptr);
+	Iterator previous = *this;
+	++*this;
+	return previous;
+}
 
-private:
-	/// <summary>
-	/// Finds the node that matches the value in the list
-	/// </summary>
-	/// <param name="searchValue">The value of the node to search for</param>
-	/// <param name="nodeFound">A pointer that will store the address of the node that was found</param>
-	/// <param name="nodeParent">A pointer that will store the address of the parent of the node that was found</param>
-	/// <returns>Whether or not a node matching the value could be found</returns>
-	bool findNode(T searchValue, TreeNode<T>*& nodeFound, TreeNode<T>*& nodeParent);
+template<typename T>
+inline typename BinaryTree<T>::Iterator& BinaryTree<T>::Iterator::operator--()
+{
+	//Stepping back from the end reaches the largest value
+	if (!m_node)
+	{
+		m_node = m_tree->getRoot();
+		while (m_node && m_node->hasRight())
+			m_node = m_node->getRight();
+	}
+	else
+		m_node = BinaryTree<T>::prev(m_node);
+	return *this;
+}
 
-	void draw(TreeNode<T>* currentNode, int x, int y, int horizontalSpacing, TreeNode<T>* selected = nullptr);
+template<typename T>
+inline typename BinaryTree<T>::Iterator BinaryTree<T>::Iterator::operator--(int)
+{
+	Iterator previous = *this;
+	--*this;
+	return previous;
+}
 
-	TreeNode<T>* m_root = nullptr;
-};
-#endif
+template<typename T>
+inline bool BinaryTree<T>::Iterator::operator==(const Iterator& other) const
+{
+	return m_node == other.m_node;
+}
 
 template<typename T>
-inline BinaryTree<T>::BinaryTree()
+inline bool BinaryTree<T>::Iterator::operator!=(const Iterator& other) const
 {
-	m_root = nullptr;
+	return m_node != other.m_node;
 }
 
 template<typename T>
-inline bool BinaryTree<T>::isEmpty() const
+inline TreeNode<T>* BinaryTree<T>::Iterator::getNode() const
 {
-	return m_root == nullptr;
+	return m_node;
 }
 
 template<typename T>
-inline void BinaryTree<T>::insert(T value)
+inline void BinaryTree<T>::split(T key, BinaryTree<T>& right)
 {
-	//Return if the value is null or is already exists
-	if (value == NULL || find(value) != nullptr)
+	//Return if the right tree already has nodes or is this tree
+	if (!right.isEmpty() || &right == this)
 		return;
 
-	//Creates pointer for the current node and its parent
+	//Creates pointers for the roots of both halves and the last node added to each half
+	TreeNode<T>* leftRoot = nullptr;
+	TreeNode<T>* rightRoot = nullptr;
+	TreeNode<T>* leftTail = nullptr;
+	TreeNode<T>* rightTail = nullptr;
 	TreeNode<T>* currentNode = m_root;
-	TreeNode<T>* parentNode = nullptr;
 
-	//While the current node exists
+	//Walks down a single path, cutting every link that crosses the key
 	while (currentNode)
 	{
-		//Makes the parent node become the current node
-		parentNode = currentNode;
+		//If the current node's value is less than the key, it and its left subtree belong to the left half
+		if (currentNode->getData() < key)
+		{
+			if (leftTail)
+				leftTail->setRight(currentNode);
+			else
+				leftRoot = currentNode;
 
-		//If the current node's value is less than the inserted value, move the current node to the right
-		if (currentNode->getData() < value)
+			leftTail = currentNode;
 			currentNode = currentNode->getRight();
+		}
 
-		//If the current node's value is greater than the inserted value, move the current node to the left
-		else if (currentNode->getData() > value)
+		//Otherwise it and its right subtree belong to the right half
+		else
+		{
+			if (rightTail)
+				rightTail->setLeft(currentNode);
+			else
+				rightRoot = currentNode;
+
+			rightTail = currentNode;
 			currentNode = currentNode->getLeft();
+		}
 	}
 
-	//Make the current node become a node with the value to be inserted
-	currentNode = new TreeNode<T>(value);
+	//Cuts the links still pointing into the other half
+	if (leftTail)
+		leftTail->setRight(nullptr);
+	if (rightTail)
+		rightTail->setLeft(nullptr);
 
-	///If the parent node exist, make the inserted node a leaf of the node
-	if (parentNode)
+	//Reads the largest node before an empty left half forgets it
+	TreeNode<T>* largestNode = m_largestNode;
+	setRoot(leftRoot);
+	right.setRoot(rightRoot);
+	right.shareArenas(*this);
+
+	//Neither half knows how many nodes it got without counting them
+	if (leftRoot)
 	{
-		if (parentNode->getData() > currentNode->getData())
-			parentNode->setLeft(currentNode);
-		else
-			parentNode->setRight(currentNode);
+		forgetSize();
+		forgetHeight();
 	}
-	else
-		m_root = currentNode;
+	if (rightRoot)
+	{
+		right.forgetSize();
+		right.forgetHeight();
+	}
+
+	//The last node added to the left half is its largest, and the right half keeps the old largest node if it has any nodes
+	right.m_largestNode = rightRoot ? largestNode : nullptr;
+	m_largestNode = leftTail;
+
+	//Forgets the cached nodes, since some of them now belong to the other tree
+	clearFindCache();
+	right.clearFindCache();
+
+	//Refreshes the edges of both halves that were cut
+	updatePath(leftTail);
+	right.updatePath(rightTail);
 }
 
 template<typename T>
-inline void BinaryTree<T>::remove(T value)
+inline bool BinaryTree<T>::join(BinaryTree<T>& right)
 {
-	//Return if the value is null or not in the tree
-	if (value == NULL || !find(value))
-		return;
-
-	TreeNode<T>* nodeToRemove;
-	TreeNode<T>* parentNode = nullptr;
+	//A multiset's counts would be lost in a set, and a tree can't be joined to itself
+	if (&right == this || right.m_isMultiset != m_isMultiset)
+		return false;
+	if (right.isEmpty())
+		return true;
 
-	//Sets the pointers to be the node to remove and its parent
-	findNode(value, nodeToRemove, parentNode);
+	shareArenas(right);
 
-	//If the node has two leaves
-	if (nodeToRemove->hasLeft() && nodeToRemove->hasRight())
+	//If this tree is empty it just takes the other tree's nodes
+	if (isEmpty())
 	{
-		//Create a pointer to nodes to replace the node to remove
-		TreeNode<T>* replacementNode = nodeToRemove->getRight();
-		TreeNode<T>* replacementParent = nodeToRemove;
+		setRoot(right.m_root);
+		m_largestNode = right.m_largestNode;
+		takeSize(right);
+		m_height = right.m_height;
+		m_isHeightKnown = right.m_isHeightKnown;
+		right.setRoot(nullptr);
+		right.m_largestNode = nullptr;
+		right.clearFindCache();
+		return true;
+	}
 
-		while (replacementNode->hasLeft())
+	//Finds the largest node in this tree and the smallest node in the other tree
+	TreeNode<T>* largestNode = m_largestNode;
+
+	TreeNode<T>* smallestNode = right.m_root;
+	while (smallestNode->hasLeft())
+		smallestNode = smallestNode->getLeft();
+
+	//Refuse if the trees overlap, since joining them would break the ordering
+	if (!(largestNode->getData() < smallestNode->getData()))
+		return false;
+
+	//Hangs the other tree off the largest node
+	largestNode->setRight(right.m_root);
+	m_largestNode = right.m_largestNode;
+	takeSize(right);
+	forgetHeight();
+	right.setRoot(nullptr);
+	right.m_largestNode = nullptr;
+	right.clearFindCache();
+	updatePath(largestNode);
+	return true;
+}
+
+template<typename T>
+inline void BinaryTree<T>::unionWith(const BinaryTree<T>& other)
+{
+	std::vector<TreeNode<T>*> nodes;
+	std::vector<TreeNode<T>*> otherNodes;
+	collectInOrder(m_root, nodes);
+	collectInOrder(other.m_root, otherNodes);
+
+	//Merges the two sorted lists, creating nodes for the values only the other tree has
+	std::vector<TreeNode<T>*> mergedNodes;
+	mergedNodes.reserve(nodes.size() + otherNodes.size());
+	size_t i = 0;
+	size_t j = 0;
+	while (i < nodes.size() || j < otherNodes.size())
+	{
+		if (j == otherNodes.size() || (i < nodes.size() && nodes[i]->getData() < otherNodes[j]->getData()))
 		{
-			//Makes the parent of the replacement node equal to its leaf, then moves its leaf to the left
-			replacementParent = replacementNode;
-			replacementNode = replacementNode->getLeft();
+			mergedNodes.push_back(nodes[i++]);
+			continue;
 		}
 
-		//Change the removed node with the replacement node
-		replacementParent->setLeft(replacementNode->getRight());
-		replacementNode->setLeft(nodeToRemove->getLeft());
-		if (replacementParent != nodeToRemove)
-			replacementNode->setRight(nodeToRemove->getRight());
-		
+		TreeNode<T>* otherNode = otherNodes[j++];
+		unsigned int addedCount = m_isMultiset ? otherNode->getCount() : 0;
+		bool isShared = i < nodes.size() && !(otherNode->getData() < nodes[i]->getData());
 
-		//If the removed node had a parent
-		if (parentNode)
+		if (isShared)
 		{
-			//Make the parent's leaf become the replacement node
-			if (parentNode->getLeft() == nodeToRemove)
-				parentNode->setLeft(replacementNode);
-			else
-				parentNode->setRight(replacementNode);
+			nodes[i]->setCount(nodes[i]->getCount() + addedCount);
+			mergedNodes.push_back(nodes[i++]);
 		}
 		else
-			m_root = replacementNode;
+		{
+			addedCount = m_isMultiset ? addedCount : 1;
+			TREE_STATS_ALLOCATION();
+			TreeNode<T>* newNode = new TreeNode<T>(otherNode->getData());
+			newNode->setCount(addedCount);
+			mergedNodes.push_back(newNode);
+		}
+
+		if (m_log)
+		{
+			for (unsigned int k = 0; k < addedCount; k++)
+				m_log->logInsert(otherNode->getData());
+		}
 	}
 
-	//If it only has one leaf
-	else if (nodeToRemove->hasLeft() || nodeToRemove->hasRight())
+	relinkAll(mergedNodes);
+}
+
+template<typename T>
+inline void BinaryTree<T>::intersect(const BinaryTree<T>& other)
+{
+	std::vector<TreeNode<T>*> nodes;
+	std::vector<TreeNode<T>*> otherNodes;
+	collectInOrder(m_root, nodes);
+	collectInOrder(other.m_root, otherNodes);
+
+	//Keeps the nodes whose values the other tree has too, skipping past the smaller value each step
+	std::vector<TreeNode<T>*> keptNodes;
+	size_t j = 0;
+	for (TreeNode<T>* node : nodes)
 	{
-		//If the current node has no parent node
-		if (!parentNode)
+		while (j < otherNodes.size() && otherNodes[j]->getData() < node->getData())
+			j++;
+
+		unsigned int keptCount = 0;
+		if (j < otherNodes.size() && !(node->getData() < otherNodes[j]->getData()))
+			keptCount = std::min(node->getCount(), otherNodes[j]->getCount());
+
+		if (m_log)
 		{
-			//Sets the leaf to be the root node
-			if (nodeToRemove->hasLeft())
-				m_root = nodeToRemove->getLeft();
-			else
-				m_root = nodeToRemove->getRight();
+			for (unsigned int k = keptCount; k < node->getCount(); k++)
+				m_log->logRemove(node->getData());
 		}
 
-		//If the parent's left leaf is the node to remove
-		else if (parentNode->getLeft() == nodeToRemove)
+		if (keptCount > 0)
 		{
-			//Set the parent's left leaf to be the leaf of the removed node
-			if (nodeToRemove->hasLeft())
-				parentNode->setLeft(nodeToRemove->getLeft());
-			else
-				parentNode->setLeft(nodeToRemove->getRight());
+			node->setCount(keptCount);
+			keptNodes.push_back(node);
 		}
+		else
+			NodeArena<T>::destroyNode(node);
+	}
 
-		//If the parent's right leaf is the node to remove
-		else if (parentNode->getRight() == nodeToRemove)
+	relinkAll(keptNodes);
+}
+
+template<typename T>
+inline void BinaryTree<T>::difference(const BinaryTree<T>& other)
+{
+	//Removing a tree from itself leaves nothing, and its nodes can't be read once they are deleted
+	bool isSameTree = &other == this;
+
+	std::vector<TreeNode<T>*> nodes;
+	std::vector<TreeNode<T>*> otherNodes;
+	collectInOrder(m_root, nodes);
+	if (!isSameTree)
+		collectInOrder(other.m_root, otherNodes);
+
+	//Subtracts the other tree's copies from every shared value, keeping what is left
+	std::vector<TreeNode<T>*> keptNodes;
+	size_t j = 0;
+	for (TreeNode<T>* node : nodes)
+	{
+		while (j < otherNodes.size() && otherNodes[j]->getData() < node->getData())
+			j++;
+
+		unsigned int keptCount = isSameTree ? 0 : node->getCount();
+		if (j < otherNodes.size() && !(node->getData() < otherNodes[j]->getData()))
+			keptCount = otherNodes[j]->getCount() < keptCount ? keptCount - otherNodes[j]->getCount() : 0;
+
+		if (m_log)
 		{
-			//Set the parent's right leaf to be the leaf of the removed node
-			if (nodeToRemove->hasLeft())
-				parentNode->setRight(nodeToRemove->getLeft());
-			else
-				parentNode->setRight(nodeToRemove->getRight());
+			for (unsigned int k = keptCount; k < node->getCount(); k++)
+				m_log->logRemove(node->getData());
 		}
+
+		if (keptCount > 0)
+		{
+			node->setCount(keptCount);
+			keptNodes.push_back(node);
+		}
+		else
+			NodeArena<T>::destroyNode(node);
 	}
 
-	//If the node has no leaves but isn't the root node
-	else if (parentNode != nullptr)
+	relinkAll(keptNodes);
+}
+
+template<typename T>
+inline void BinaryTree<T>::bulkLoad(const std::vector<T>& sortedValues)
+{
+	//If the tree already has nodes or the values are out of order, they have to be inserted one by one
+	if (!isEmpty() || !std::is_sorted(sortedValues.begin(), sortedValues.end()))
 	{
-		//If the parent's left leaf is the node to remove
-		if (parentNode->getLeft() == nodeToRemove)
-				parentNode->setLeft(nullptr);
+		for (const T& value : sortedValues)
+			insert(value);
+		return;
+	}
 
-		//If the parent's right leaf is the node to remove
-		else if (parentNode->getRight() == nodeToRemove)
-				parentNode->setRight(nullptr);
+	//Creates one node per distinct value, counting the copies in a multiset
+	std::vector<TreeNode<T>*> nodes;
+	nodes.reserve(sortedValues.size());
+	for (const T& value : sortedValues)
+	{
+		if (m_log && (m_isMultiset || nodes.empty() || nodes.back()->getData() < value))
+			m_log->logInsert(value);
+
+		if (!nodes.empty() && !(nodes.back()->getData() < value))
+		{
+			if (m_isMultiset)
+				nodes.back()->setCount(nodes.back()->getCount() + 1);
+			continue;
+		}
+		TREE_STATS_ALLOCATION();
+		nodes.push_back(new TreeNode<T>(value));
 	}
-	else
-		m_root = nullptr;
 
-	//Deletes the current node
-	nodeToRemove = nullptr;
+	relinkAll(nodes);
 }
 
 template<typename T>
-inline TreeNode<T>* BinaryTree<T>::find(T value)
+inline bool BinaryTree<T>::loadFrom(std::istream& stream)
 {
-	//Return nullptr if the value is null
-	if (!value)
-		return nullptr;
+	//While the values come in order, each one is chained to the right of the largest node
+	bool isChaining = isEmpty();
+	size_t chainLength = 0;
 
-	//Create a pointer for the node to return
-	TreeNode<T>* currentNode = m_root;
+	bool succeeded = readValues(stream, [&](const T& value)
+	{
+		if (isChaining && (!m_largestNode || !(value < m_largestNode->getData())))
+		{
+			if (m_log && (m_isMultiset || !m_largestNode || m_largestNode->getData() < value))
+				m_log->logInsert(value);
 
-	//While the current node exists
-		while (currentNode)
+			//Copies of the same value are counted on one node in a multiset
+			if (m_largestNode && !(m_largestNode->getData() < value))
+			{
+				if (m_isMultiset)
+					m_largestNode->setCount(m_largestNode->getCount() + 1);
+				return;
+			}
+
+			TREE_STATS_ALLOCATION();
+			TreeNode<T>* newNode = new TreeNode<T>(value);
+			if (m_largestNode)
+				m_largestNode->setRight(newNode);
+			else
+				setRoot(newNode);
+			m_largestNode = newNode;
+			chainLength++;
+			return;
+		}
+
+		//A value out of order ends the chain, which is balanced before the rest are inserted
+		if (isChaining)
 		{
-			//If the current node's value is less than the value to find
-			if (currentNode->getData() < value)
-				//Make the current value the next node to the right
-				currentNode = currentNode->getRight();
-			//If the current node's value is greater than the value to find
-			else if (currentNode->getData() > value)
-				//Make the current value the next node to the left
-				currentNode = currentNode->getLeft();
-			//If the current node's value is the value to find
-			else if (currentNode->getData() == value)
-				break;
+			isChaining = false;
+			balanceVine(chainLength);
 		}
+		insert(value);
+	});
 
-	//return the found node
-	return currentNode;
+	if (isChaining)
+		balanceVine(chainLength);
+
+	return succeeded;
 }
 
 template<typename T>
-inline void BinaryTree<T>::draw(TreeNode<T>* selected)
+inline bool BinaryTree<T>::saveTo(std::ostream& stream) const
 {
-	draw(m_root, 400, 40, 400, selected);
+	const size_t bufferSize = 1 << 16;
+	std::vector<char> buffer(bufferSize);
+	size_t bufferUsed = 0;
+
+	//Walks the tree in order, skipping the rest of it once the stream fails
+	TreeTraversal<T>::inOrder(m_root, [&](TreeNode<T>* currentNode, size_t)
+	{
+		if (!stream)
+			return;
+
+		//Writes the value once for every copy of it
+		for (unsigned int i = 0; i < currentNode->getCount(); i++)
+		{
+			if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+			{
+				//Writes the buffer out once a number might not fit
+				if (bufferSize - bufferUsed < 32)
+				{
+					stream.write(buffer.data(), bufferUsed);
+					bufferUsed = 0;
+				}
+
+				char* numberEnd = std::to_chars(buffer.data() + bufferUsed, buffer.data() + bufferSize, currentNode->getData()).ptr;
+				*numberEnd = '\n';
+				bufferUsed = numberEnd + 1 - buffer.data();
+			}
+			else
+				stream << currentNode->getData() << '\n';
+		}
+	});
+
+	stream.write(buffer.data(), bufferUsed);
+	return (bool)stream;
 }
 
 template<typename T>
-inline bool BinaryTree<T>::findNode(T searchValue, TreeNode<T>*& nodeFound, TreeNode<T>*& nodeParent)
+inline void BinaryTree<T>::updatePath(TreeNode<T>* node)
 {
-	//Return nullptr if the value is null
-	if (!searchValue && !find(searchValue))
-		return false;
+	//Return if this tree doesn't keep anything about its subtrees
+	if (!m_isAugmented)
+		return;
+
+	//Refreshes the nodes from the bottom up so every child is refreshed before its parent
+	for (TreeNode<T>* currentNode = node; currentNode; currentNode = currentNode->getParent())
+		updateNode(currentNode);
+}
+
+template<typename T>
+inline TreeNode<T>* BinaryTree<T>::linkBalanced(std::vector<TreeNode<T>*>& nodes, size_t first, size_t last)
+{
+	if (first >= last)
+		return nullptr;
+
+	//The middle node becomes the root so both sides have the same number of nodes
+	size_t middle = first + (last - first) / 2;
+	TreeNode<T>* node = nodes[middle];
+	node->setLeft(linkBalanced(nodes, first, middle));
+	node->setRight(linkBalanced(nodes, middle + 1, last));
 
-	nodeFound = m_root;
-	//While the current node is not the searched node
-	while (nodeFound->getData() != searchValue)
+	if (m_isAugmented)
+		updateNode(node);
+	return node;
+}
+
+template<typename T>
+inline void BinaryTree<T>::collectInOrder(TreeNode<T>* node, std::vector<TreeNode<T>*>& nodes)
+{
+	TreeTraversal<T>::inOrder(node, [&](TreeNode<T>* currentNode, size_t)
 	{
-		//Makes the parent node become the current node
-		nodeParent = nodeFound;
+		nodes.push_back(currentNode);
+	});
+}
+
+template<typename T>
+inline void BinaryTree<T>::relinkAll(std::vector<TreeNode<T>*>& nodes)
+{
+	//Nodes may have been deleted or moved, so nothing cached can be trusted
+	clearFindCache();
+	setRoot(linkBalanced(nodes, 0, nodes.size()));
+	m_largestNode = nodes.empty() ? nullptr : nodes.back();
+
+	//Splitting at the middle every time gives the smallest possible height, one level per bit of the node count
+	m_size = nodes.size();
+	m_isSizeKnown = true;
+	m_height = 0;
+	for (size_t count = m_size; count > 0; count >>= 1)
+		m_height++;
+	m_isHeightKnown = true;
+}
+
+template<typename T>
+inline void BinaryTree<T>::balanceVine(size_t nodeCount)
+{
+	if (nodeCount == 0)
+		return;
+
+	//The nodes past the largest perfect tree that fits become its bottom level,
+	//then each pass halves the remaining right edge until it is a single node
+	size_t perfectCount = 1;
+	while (perfectCount * 2 + 1 <= nodeCount)
+		perfectCount = perfectCount * 2 + 1;
 
-		//If the current node's value is less than the inserted value, move the node to the right
-		if (nodeFound->getData() < searchValue)
-			nodeFound = nodeFound->getRight();
+	rotateVine(nodeCount - perfectCount);
+	for (size_t rotationCount = perfectCount / 2; rotationCount > 0; rotationCount /= 2)
+		rotateVine(rotationCount);
 
-		//If the current node's value is greater than the inserted value, move the node to the left
-		else if (nodeFound->getData() > searchValue)
-			nodeFound = nodeFound->getLeft();
+	//Every subtree changed, so each node is refreshed after both of its children
+	if (m_isAugmented)
+	{
+		TreeTraversal<T>::postOrder(m_root, [&](TreeNode<T>* node, size_t)
+		{
+			updateNode(node);
+		});
 	}
-	return true;
+
+	//The result is as short as a tree of this many nodes can be, one level per bit of the node count
+	clearFindCache();
+	m_size = nodeCount;
+	m_isSizeKnown = true;
+	m_height = 0;
+	for (size_t count = nodeCount; count > 0; count >>= 1)
+		m_height++;
+	m_isHeightKnown = true;
+}
+
+template<typename T>
+inline void BinaryTree<T>::rotateVine(size_t rotationCount)
+{
+	TreeNode<T>* node = m_root;
+	for (size_t i = 0; i < rotationCount; i++)
+	{
+		//The right child takes the node's place and the node becomes its left child
+		TreeNode<T>* rightChild = node->getRight();
+		TreeNode<T>* parentNode = node->getParent();
+		node->setRight(rightChild->getLeft());
+		rightChild->setLeft(node);
+		if (parentNode)
+			parentNode->setRight(rightChild);
+		else
+			setRoot(rightChild);
+
+		node = rightChild->getRight();
+	}
+}
+
+template<typename T>
+inline void BinaryTree<T>::measureShape() const
+{
+	size_t nodeCount = 0;
+	size_t deepestLevel = 0;
+	TreeTraversal<T>::preOrder(m_root, [&](TreeNode<T>*, size_t depth)
+	{
+		nodeCount++;
+		if (depth + 1 > deepestLevel)
+			deepestLevel = depth + 1;
+	});
+
+	m_size = nodeCount;
+	m_height = deepestLevel;
+	m_isSizeKnown = true;
+	m_isHeightKnown = true;
 }
 
 template<typename T>
-inline void BinaryTree<T>::draw(TreeNode<T>* currentNode, int x, int y, int horizontalSpacing, TreeNode<T>* selected)
-{
-	//sets the needed space in between      
-	horizontalSpacing /= 2;   
-
-	//check if the current node in null     
-	if (currentNode)     
-	{         
-		//draws the left child if this node has one         
-		if (currentNode->hasLeft())         
-		{            
-			//Darws a line betwen the left child and the current node             
-			DrawLine(x, y, x - horizontalSpacing, y + 80, RED);             
-			//draws the left child             
-			draw(currentNode->getLeft(), x - horizontalSpacing, y + 80, horizontalSpacing, selected);         
-		}          
-
-		//draws the right child if this node has one         
-		if (currentNode->hasRight())         
-		{             
-			//draws a line between this child and the curent code             
-			DrawLine(x, y, x + horizontalSpacing, y + 80, RED);             
-			//draws the right child             
-			draw(currentNode->getRight(), x + horizontalSpacing, y + 80, horizontalSpacing, selected);         
-		}         
-		//draws the current node         
-		currentNode->draw(x, y, (selected == currentNode));      
+inline bool BinaryTree<T>::parseValue(const char* begin, const char* end, T& value)
+{
+	//Ignores the carriage return of files with windows line endings
+	if (end > begin && end[-1] == '\r')
+		end--;
+	if (begin == end)
+		return false;
+
+	if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value)
+	{
+		std::from_chars_result result = std::from_chars(begin, end, value);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+	else if constexpr (std::is_constructible<T, std::string>::value)
+	{
+		value = T(std::string(begin, end));
+		return true;
+	}
+	else
+	{
+		std::istringstream lineStream(std::string(begin, end));
+		return (bool)(lineStream >> value);
 	}
 }
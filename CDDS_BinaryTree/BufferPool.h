@@ -0,0 +1,353 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Keeps a fixed number of pages of a file in memory. Pages are pinned while they are in use
+/// and the page that was used least recently is written back and replaced when room is needed
+/// </summary>
+class BufferPool
+{
+public:
+	/// <summary>
+	/// The number of bytes in every page
+	/// </summary>
+	static const uint32_t PAGE_SIZE = 4096;
+	/// <summary>
+	/// The id returned for a page that couldn't be created
+	/// </summary>
+	static const uint32_t NO_PAGE = 0xFFFFFFFF;
+
+	BufferPool() {}
+	~BufferPool();
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	/// <summary>
+	/// Opens the file at the given path, creating it if it doesn't exist
+	/// </summary>
+	/// <param name="path">The path of the file holding the pages</param>
+	/// <param name="capacity">The most pages that are kept in memory at once</param>
+	/// <returns>Whether or not the file could be opened</returns>
+	bool open(const char* path, size_t capacity);
+	/// <summary>
+	/// Writes every changed page back to the file and closes it
+	/// </summary>
+	void close();
+	/// <summary>
+	/// Returns whether or not a file is open
+	/// </summary>
+	bool isOpen() const;
+
+	/// <summary>
+	/// Returns the page with the given id, reading it from the file if it isn't in memory.
+	/// The page stays in memory until it is unpinned
+	/// </summary>
+	/// <param name="pageId">The id of the page</param>
+	/// <returns>The bytes of the page, or nullptr if every page in memory is pinned</returns>
+	char* fetchPage(uint32_t pageId);
+	/// <summary>
+	/// Adds a new empty page to the end of the file. The new page is pinned
+	/// </summary>
+	/// <param name="pageId">Stores the id of the new page</param>
+	/// <returns>The bytes of the page, or nullptr if every page in memory is pinned</returns>
+	char* allocatePage(uint32_t& pageId);
+	/// <summary>
+	/// Lets the page be replaced once it is no longer used
+	/// </summary>
+	/// <param name="pageId">The id of the page</param>
+	/// <param name="isDirty">Whether or not the page was changed and has to be written back</param>
+	void unpinPage(uint32_t pageId, bool isDirty);
+	/// <summary>
+	/// Writes every changed page back to the file
+	/// </summary>
+	/// <returns>Whether or not every page could be written</returns>
+	bool flush();
+
+	/// <summary>
+	/// Returns how many pages are in the file
+	/// </summary>
+	uint32_t getPageCount() const;
+	/// <summary>
+	/// Returns how many pages have been read from the file
+	/// </summary>
+	uint64_t getReadCount() const;
+	/// <summary>
+	/// Returns how many pages have been written to the file
+	/// </summary>
+	uint64_t getWriteCount() const;
+
+private:
+	struct Frame
+	{
+		uint32_t pageId = NO_PAGE;
+		int pinCount = 0;
+		bool isDirty = false;
+		bool isInLru = false;
+		std::list<size_t>::iterator lruPosition;
+	};
+
+	/// <summary>
+	/// Returns a frame that can hold a new page, writing back the page that was used least recently if needed
+	/// </summary>
+	/// <returns>The index of the frame, or the number of frames if every frame is pinned</returns>
+	size_t findFreeFrame();
+	/// <summary>
+	/// Marks the frame as in use so it can't be replaced
+	/// </summary>
+	void pinFrame(size_t frameIndex);
+	/// <summary>
+	/// Moves the file position to the start of the given page
+	/// </summary>
+	bool seekToPage(uint32_t pageId);
+	/// <summary>
+	/// Returns the memory the frame keeps its page in
+	/// </summary>
+	char* getFrameBytes(size_t frameIndex);
+
+	FILE* m_file = nullptr;
+	std::vector<char> m_memory;
+	std::vector<Frame> m_frames;
+	std::vector<size_t> m_freeFrames;
+	std::unordered_map<uint32_t, size_t> m_pageTable;
+	//Unpinned frames, with the least recently used one at the front
+	std::list<size_t> m_lru;
+
+	uint32_t m_pageCount = 0;
+	uint64_t m_readCount = 0;
+	uint64_t m_writeCount = 0;
+};
+
+inline BufferPool::~BufferPool()
+{
+	close();
+}
+
+inline bool BufferPool::open(const char* path, size_t capacity)
+{
+	close();
+
+	//Opens the file for reading and writing, creating it if it doesn't exist yet
+	m_file = fopen(path, "r+b");
+	if (!m_file)
+		m_file = fopen(path, "w+b");
+	if (!m_file)
+		return false;
+
+	//Counts the pages already in the file
+	fseek(m_file, 0, SEEK_END);
+#ifdef _WIN32
+	m_pageCount = (uint32_t)(_ftelli64(m_file) / PAGE_SIZE);
+#else
+	m_pageCount = (uint32_t)(ftello(m_file) / PAGE_SIZE);
+#endif
+
+	//Sets aside the memory for every frame at once
+	m_memory.assign(capacity * PAGE_SIZE, 0);
+	m_frames.assign(capacity, Frame());
+	m_freeFrames.clear();
+	for (size_t i = capacity; i > 0; i--)
+		m_freeFrames.push_back(i - 1);
+
+	m_readCount = 0;
+	m_writeCount = 0;
+	return true;
+}
+
+inline void BufferPool::close()
+{
+	if (!m_file)
+		return;
+
+	flush();
+	fclose(m_file);
+	m_file = nullptr;
+
+	m_memory.clear();
+	m_frames.clear();
+	m_freeFrames.clear();
+	m_pageTable.clear();
+	m_lru.clear();
+	m_pageCount = 0;
+}
+
+inline bool BufferPool::isOpen() const
+{
+	return m_file != nullptr;
+}
+
+inline char* BufferPool::fetchPage(uint32_t pageId)
+{
+	if (!m_file || pageId >= m_pageCount)
+		return nullptr;
+
+	//Return the page straight away if it is already in memory
+	std::unordered_map<uint32_t, size_t>::iterator entry = m_pageTable.find(pageId);
+	if (entry != m_pageTable.end())
+	{
+		pinFrame(entry->second);
+		return getFrameBytes(entry->second);
+	}
+
+	size_t frameIndex = findFreeFrame();
+	if (frameIndex == m_frames.size())
+		return nullptr;
+
+	//Reads the page into the frame
+	char* bytes = getFrameBytes(frameIndex);
+	if (!seekToPage(pageId) || fread(bytes, PAGE_SIZE, 1, m_file) != 1)
+	{
+		m_freeFrames.push_back(frameIndex);
+		return nullptr;
+	}
+	m_readCount++;
+
+	m_frames[frameIndex].pageId = pageId;
+	m_frames[frameIndex].isDirty = false;
+	m_pageTable[pageId] = frameIndex;
+	pinFrame(frameIndex);
+	return bytes;
+}
+
+inline char* BufferPool::allocatePage(uint32_t& pageId)
+{
+	pageId = NO_PAGE;
+	if (!m_file || m_pageCount == NO_PAGE)
+		return nullptr;
+
+	size_t frameIndex = findFreeFrame();
+	if (frameIndex == m_frames.size())
+		return nullptr;
+
+	//The page only exists in memory until it is written back, so it starts out dirty
+	pageId = m_pageCount++;
+	char* bytes = getFrameBytes(frameIndex);
+	memset(bytes, 0, PAGE_SIZE);
+	m_frames[frameIndex].pageId = pageId;
+	m_frames[frameIndex].isDirty = true;
+	m_pageTable[pageId] = frameIndex;
+	pinFrame(frameIndex);
+	return bytes;
+}
+
+inline void BufferPool::unpinPage(uint32_t pageId, bool isDirty)
+{
+	std::unordered_map<uint32_t, size_t>::iterator entry = m_pageTable.find(pageId);
+	if (entry == m_pageTable.end())
+		return;
+
+	Frame& frame = m_frames[entry->second];
+	frame.isDirty = frame.isDirty || isDirty;
+	if (frame.pinCount > 0 && --frame.pinCount == 0)
+	{
+		//The frame becomes the most recently used one that can be replaced
+		frame.lruPosition = m_lru.insert(m_lru.end(), entry->second);
+		frame.isInLru = true;
+	}
+}
+
+inline bool BufferPool::flush()
+{
+	if (!m_file)
+		return false;
+
+	bool succeeded = true;
+	for (size_t i = 0; i < m_frames.size(); i++)
+	{
+		Frame& frame = m_frames[i];
+		if (frame.pageId == NO_PAGE || !frame.isDirty)
+			continue;
+
+		if (seekToPage(frame.pageId) && fwrite(getFrameBytes(i), PAGE_SIZE, 1, m_file) == 1)
+		{
+			frame.isDirty = false;
+			m_writeCount++;
+		}
+		else
+			succeeded = false;
+	}
+
+	return fflush(m_file) == 0 && succeeded;
+}
+
+inline uint32_t BufferPool::getPageCount() const
+{
+	return m_pageCount;
+}
+
+inline uint64_t BufferPool::getReadCount() const
+{
+	return m_readCount;
+}
+
+inline uint64_t BufferPool::getWriteCount() const
+{
+	return m_writeCount;
+}
+
+inline size_t BufferPool::findFreeFrame()
+{
+	//Uses a frame that has never held a page if there is one
+	if (!m_freeFrames.empty())
+	{
+		size_t frameIndex = m_freeFrames.back();
+		m_freeFrames.pop_back();
+		return frameIndex;
+	}
+
+	//Otherwise replaces the page that was used least recently
+	if (m_lru.empty())
+		return m_frames.size();
+
+	size_t frameIndex = m_lru.front();
+	m_lru.pop_front();
+	Frame& frame = m_frames[frameIndex];
+	frame.isInLru = false;
+
+	//Writes the old page back if it was changed
+	if (frame.isDirty)
+	{
+		if (!seekToPage(frame.pageId) || fwrite(getFrameBytes(frameIndex), PAGE_SIZE, 1, m_file) != 1)
+		{
+			frame.lruPosition = m_lru.insert(m_lru.begin(), frameIndex);
+			frame.isInLru = true;
+			return m_frames.size();
+		}
+		m_writeCount++;
+	}
+
+	m_pageTable.erase(frame.pageId);
+	frame.pageId = NO_PAGE;
+	frame.isDirty = false;
+	return frameIndex;
+}
+
+inline void BufferPool::pinFrame(size_t frameIndex)
+{
+	Frame& frame = m_frames[frameIndex];
+	if (frame.isInLru)
+	{
+		m_lru.erase(frame.lruPosition);
+		frame.isInLru = false;
+	}
+	frame.pinCount++;
+}
+
+inline bool BufferPool::seekToPage(uint32_t pageId)
+{
+#ifdef _WIN32
+	return _fseeki64(m_file, (long long)pageId * PAGE_SIZE, SEEK_SET) == 0;
+#else
+	return fseeko(m_file, (off_t)pageId * PAGE_SIZE, SEEK_SET) == 0;
+#endif
+}
+
+inline char* BufferPool::getFrameBytes(size_t frameIndex)
+{
+	return m_memory.data() + frameIndex * PAGE_SIZE;
+}
@@ -0,0 +1,483 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "BufferPool.h"
+
+/// <summary>
+/// The first page of a disk tree file
+/// </summary>
+struct DiskTreeHeader
+{
+	char magic[8];
+	uint32_t pageSize;
+	uint32_t valueSize;
+	uint32_t rootPage;
+	uint32_t reserved;
+	uint64_t valueCount;
+};
+
+/// <summary>
+/// The start of every node page. The values follow it, and internal nodes store their child page ids after the values
+/// </summary>
+struct DiskNodeHeader
+{
+	uint16_t isLeaf;
+	uint16_t count;
+	uint32_t nextLeaf;
+	uint64_t reserved;
+};
+
+/// <summary>
+/// A tree that keeps its nodes in pages of a file instead of in memory, so it can hold more values
+/// than fit in memory. Each node is a page holding many sorted values, which keeps the tree only a
+/// few pages tall, and a buffer pool keeps the pages that were used most recently in memory
+/// </summary>
+template<typename T>
+class DiskTree
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Disk trees can only store trivially copyable values");
+
+public:
+	DiskTree() {}
+	~DiskTree();
+
+	DiskTree(const DiskTree<T>&) = delete;
+	DiskTree<T>& operator=(const DiskTree<T>&) = delete;
+
+	/// <summary>
+	/// Opens the tree stored in the file at the given path, creating an empty tree if the file doesn't exist
+	/// </summary>
+	/// <param name="path">The path of the file</param>
+	/// <param name="memoryPages">The most pages kept in memory at once</param>
+	/// <returns>Whether or not the file could be opened and holds a tree of this type</returns>
+	bool open(const char* path, size_t memoryPages);
+	/// <summary>
+	/// Writes every change to the file and closes it
+	/// </summary>
+	void close();
+	/// <summary>
+	/// Writes every change to the file
+	/// </summary>
+	/// <returns>Whether or not every change could be written</returns>
+	bool flush();
+
+	/// <summary>
+	/// Returns whether or not there are any values in the tree
+	/// </summary>
+	bool isEmpty() const;
+	/// <summary>
+	/// Returns how many values are in the tree
+	/// </summary>
+	uint64_t getValueCount() const;
+	/// <summary>
+	/// Returns the buffer pool, which counts the pages read from and written to the file
+	/// </summary>
+	const BufferPool& getBufferPool() const;
+
+	/// <summary>
+	/// Adds the value to the tree if it isn't already in it
+	/// </summary>
+	/// <param name="value">The new value to add to the tree</param>
+	void insert(T value);
+	/// <summary>
+	/// Removes the value from the tree
+	/// </summary>
+	/// <param name="value">The value to remove</param>
+	void remove(T value);
+	/// <summary>
+	/// Returns whether or not the value is in the tree
+	/// </summary>
+	/// <param name="value">The value to search for</param>
+	bool find(T value);
+
+private:
+	static DiskNodeHeader* getNodeHeader(char* page) { return (DiskNodeHeader*)page; }
+	static T* getValues(char* page) { return (T*)(page + sizeof(DiskNodeHeader)); }
+	static uint32_t* getChildren(char* page) { return (uint32_t*)(page + CHILDREN_OFFSET); }
+	static bool isFull(char* page);
+
+	/// <summary>
+	/// Moves the upper half of a full child into a new page and adds the value that separates them to the parent
+	/// </summary>
+	/// <param name="parent">The page of the parent, which must not be full</param>
+	/// <param name="childIndex">Which child of the parent is being split</param>
+	/// <param name="child">The page of the full child</param>
+	/// <returns>Whether or not a page could be added for the new child</returns>
+	bool splitChild(char* parent, int childIndex, char* child);
+	/// <summary>
+	/// Finds the child of an internal node that leads to the value
+	/// </summary>
+	static int findChildIndex(char* page, const T& value);
+
+	/// <summary>
+	/// The most values a leaf page can hold
+	/// </summary>
+	static const int LEAF_CAPACITY = (int)((BufferPool::PAGE_SIZE - sizeof(DiskNodeHeader)) / sizeof(T));
+	/// <summary>
+	/// The most values an internal page can hold, leaving room for one more child than values
+	/// </summary>
+	static const int INTERNAL_CAPACITY = (int)((BufferPool::PAGE_SIZE - sizeof(DiskNodeHeader) - 2 * sizeof(uint32_t)) / (sizeof(T) + sizeof(uint32_t)));
+	/// <summary>
+	/// Where the child page ids start in an internal page
+	/// </summary>
+	static const size_t CHILDREN_OFFSET = (sizeof(DiskNodeHeader) + INTERNAL_CAPACITY * sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+
+	//Splitting a full page moves a value up and has to leave at least one value on each side of it
+	static_assert(LEAF_CAPACITY >= 3, "A leaf page must hold at least three values");
+	static_assert(INTERNAL_CAPACITY >= 3, "An internal page must hold at least three values");
+
+	BufferPool m_pool;
+	//Zeroed until a file is opened, so an unopened tree is empty
+	DiskTreeHeader m_header = {};
+};
+
+template<typename T>
+inline DiskTree<T>::~DiskTree()
+{
+	close();
+}
+
+template<typename T>
+inline bool DiskTree<T>::open(const char* path, size_t memoryPages)
+{
+	close();
+
+	//A split needs the parent, the child and the new page in memory at the same time
+	if (!m_pool.open(path, memoryPages < 4 ? 4 : memoryPages))
+		return false;
+
+	DiskTreeHeader expected;
+	memset(&expected, 0, sizeof(expected));
+	memcpy(expected.magic, "BTDISK1", 8);
+	expected.pageSize = BufferPool::PAGE_SIZE;
+	expected.valueSize = sizeof(T);
+	expected.rootPage = BufferPool::NO_PAGE;
+
+	//A new file starts with the header page and no root
+	if (m_pool.getPageCount() == 0)
+	{
+		uint32_t headerPage;
+		char* page = m_pool.allocatePage(headerPage);
+		if (!page)
+		{
+			m_pool.close();
+			return false;
+		}
+		memcpy(page, &expected, sizeof(expected));
+		m_pool.unpinPage(headerPage, true);
+		m_header = expected;
+		return true;
+	}
+
+	//Otherwise checks that the file holds a tree of this type
+	char* page = m_pool.fetchPage(0);
+	if (!page)
+	{
+		m_pool.close();
+		return false;
+	}
+	memcpy(&m_header, page, sizeof(m_header));
+	m_pool.unpinPage(0, false);
+
+	if (memcmp(m_header.magic, expected.magic, 8) != 0 || m_header.pageSize != expected.pageSize || m_header.valueSize != expected.valueSize)
+	{
+		m_pool.close();
+		return false;
+	}
+	return true;
+}
+
+template<typename T>
+inline void DiskTree<T>::close()
+{
+	if (!m_pool.isOpen())
+		return;
+
+	flush();
+	m_pool.close();
+	m_header = DiskTreeHeader();
+}
+
+template<typename T>
+inline bool DiskTree<T>::flush()
+{
+	if (!m_pool.isOpen())
+		return false;
+
+	//Copies the header into its page before everything is written
+	char* page = m_pool.fetchPage(0);
+	if (!page)
+		return false;
+	memcpy(page, &m_header, sizeof(m_header));
+	m_pool.unpinPage(0, true);
+
+	return m_pool.flush();
+}
+
+template<typename T>
+inline bool DiskTree<T>::isEmpty() const
+{
+	return m_header.valueCount == 0;
+}
+
+template<typename T>
+inline uint64_t DiskTree<T>::getValueCount() const
+{
+	return m_pool.isOpen() ? m_header.valueCount : 0;
+}
+
+template<typename T>
+inline const BufferPool& DiskTree<T>::getBufferPool() const
+{
+	return m_pool;
+}
+
+template<typename T>
+inline void DiskTree<T>::insert(T value)
+{
+	if (!m_pool.isOpen())
+		return;
+
+	uint32_t nodeId = m_header.rootPage;
+	char* node;
+
+	//The first value creates a leaf as the root
+	if (nodeId == BufferPool::NO_PAGE)
+	{
+		node = m_pool.allocatePage(nodeId);
+		if (!node)
+			return;
+		getNodeHeader(node)->isLeaf = 1;
+		getNodeHeader(node)->nextLeaf = BufferPool::NO_PAGE;
+		m_header.rootPage = nodeId;
+	}
+	else
+		node = m_pool.fetchPage(nodeId);
+
+	if (!node)
+		return;
+
+	//If the root is full, it becomes the only child of a new root and is split, which makes the tree one page taller
+	if (isFull(node))
+	{
+		uint32_t newRootId;
+		char* newRoot = m_pool.allocatePage(newRootId);
+		if (!newRoot)
+		{
+			m_pool.unpinPage(nodeId, false);
+			return;
+		}
+		getNodeHeader(newRoot)->isLeaf = 0;
+		getNodeHeader(newRoot)->nextLeaf = BufferPool::NO_PAGE;
+		getChildren(newRoot)[0] = nodeId;
+
+		bool succeeded = splitChild(newRoot, 0, node);
+		m_pool.unpinPage(nodeId, succeeded);
+		if (!succeeded)
+		{
+			m_pool.unpinPage(newRootId, false);
+			return;
+		}
+
+		m_header.rootPage = newRootId;
+		nodeId = newRootId;
+		node = newRoot;
+	}
+
+	bool isNodeDirty = true;
+
+	//Walks down to the leaf, splitting every full page on the way so there is always room for a separator in the parent
+	while (!getNodeHeader(node)->isLeaf)
+	{
+		int childIndex = findChildIndex(node, value);
+		uint32_t childId = getChildren(node)[childIndex];
+		char* child = m_pool.fetchPage(childId);
+		if (!child)
+		{
+			m_pool.unpinPage(nodeId, isNodeDirty);
+			return;
+		}
+
+		bool isChildDirty = false;
+		if (isFull(child))
+		{
+			if (!splitChild(node, childIndex, child))
+			{
+				m_pool.unpinPage(childId, false);
+				m_pool.unpinPage(nodeId, isNodeDirty);
+				return;
+			}
+			isNodeDirty = true;
+			isChildDirty = true;
+
+			//Moves to the new page if the value belongs in the upper half
+			if (!(value < getValues(node)[childIndex]))
+			{
+				m_pool.unpinPage(childId, true);
+				childId = getChildren(node)[childIndex + 1];
+				child = m_pool.fetchPage(childId);
+				if (!child)
+				{
+					m_pool.unpinPage(nodeId, true);
+					return;
+				}
+			}
+		}
+
+		m_pool.unpinPage(nodeId, isNodeDirty);
+		nodeId = childId;
+		node = child;
+		isNodeDirty = isChildDirty;
+	}
+
+	//Adds the value to the leaf in sorted order unless it is already there
+	DiskNodeHeader* leafHeader = getNodeHeader(node);
+	T* values = getValues(node);
+	T* position = std::lower_bound(values, values + leafHeader->count, value);
+	if (position != values + leafHeader->count && !(value < *position))
+	{
+		m_pool.unpinPage(nodeId, isNodeDirty);
+		return;
+	}
+
+	memmove(position + 1, position, (values + leafHeader->count - position) * sizeof(T));
+	*position = value;
+	leafHeader->count++;
+	m_header.valueCount++;
+	m_pool.unpinPage(nodeId, true);
+}
+
+template<typename T>
+inline void DiskTree<T>::remove(T value)
+{
+	if (!m_pool.isOpen() || m_header.rootPage == BufferPool::NO_PAGE)
+		return;
+
+	uint32_t nodeId = m_header.rootPage;
+	char* node = m_pool.fetchPage(nodeId);
+
+	//Walks down to the leaf that would hold the value
+	while (node && !getNodeHeader(node)->isLeaf)
+	{
+		uint32_t childId = getChildren(node)[findChildIndex(node, value)];
+		m_pool.unpinPage(nodeId, false);
+		nodeId = childId;
+		node = m_pool.fetchPage(nodeId);
+	}
+	if (!node)
+		return;
+
+	//Removes the value from the leaf. Pages are allowed to become sparse rather than being merged,
+	//since the values in the parents still send every search to the right leaf
+	DiskNodeHeader* leafHeader = getNodeHeader(node);
+	T* values = getValues(node);
+	T* position = std::lower_bound(values, values + leafHeader->count, value);
+	if (position == values + leafHeader->count || value < *position)
+	{
+		m_pool.unpinPage(nodeId, false);
+		return;
+	}
+
+	memmove(position, position + 1, (values + leafHeader->count - position - 1) * sizeof(T));
+	leafHeader->count--;
+	m_header.valueCount--;
+	m_pool.unpinPage(nodeId, true);
+}
+
+template<typename T>
+inline bool DiskTree<T>::find(T value)
+{
+	if (!m_pool.isOpen() || m_header.rootPage == BufferPool::NO_PAGE)
+		return false;
+
+	uint32_t nodeId = m_header.rootPage;
+	char* node = m_pool.fetchPage(nodeId);
+
+	//Reads one page per level of the tree
+	while (node && !getNodeHeader(node)->isLeaf)
+	{
+		uint32_t childId = getChildren(node)[findChildIndex(node, value)];
+		m_pool.unpinPage(nodeId, false);
+		nodeId = childId;
+		node = m_pool.fetchPage(nodeId);
+	}
+	if (!node)
+		return false;
+
+	T* values = getValues(node);
+	T* end = values + getNodeHeader(node)->count;
+	T* position = std::lower_bound(values, end, value);
+	bool isFound = position != end && !(value < *position);
+	m_pool.unpinPage(nodeId, false);
+	return isFound;
+}
+
+template<typename T>
+inline bool DiskTree<T>::isFull(char* page)
+{
+	DiskNodeHeader* header = getNodeHeader(page);
+	return header->count >= (header->isLeaf ? LEAF_CAPACITY : INTERNAL_CAPACITY);
+}
+
+template<typename T>
+inline bool DiskTree<T>::splitChild(char* parent, int childIndex, char* child)
+{
+	uint32_t siblingId;
+	char* sibling = m_pool.allocatePage(siblingId);
+	if (!sibling)
+		return false;
+
+	DiskNodeHeader* childHeader = getNodeHeader(child);
+	DiskNodeHeader* siblingHeader = getNodeHeader(sibling);
+	siblingHeader->isLeaf = childHeader->isLeaf;
+	siblingHeader->nextLeaf = BufferPool::NO_PAGE;
+	int middle = childHeader->count / 2;
+
+	//Points at the separator where it already is, since the value type may not be default constructible.
+	//Both places are in the child or its sibling, which the parent's changes below don't touch
+	const T* separator;
+
+	if (childHeader->isLeaf)
+	{
+		//Leaves keep every value, so the first value of the new leaf is copied up as the separator
+		siblingHeader->count = (uint16_t)(childHeader->count - middle);
+		memcpy(getValues(sibling), getValues(child) + middle, siblingHeader->count * sizeof(T));
+		childHeader->count = (uint16_t)middle;
+		separator = getValues(sibling);
+
+		siblingHeader->nextLeaf = childHeader->nextLeaf;
+		childHeader->nextLeaf = siblingId;
+	}
+	else
+	{
+		//Internal pages move their middle value up to the parent
+		separator = getValues(child) + middle;
+		siblingHeader->count = (uint16_t)(childHeader->count - middle - 1);
+		memcpy(getValues(sibling), getValues(child) + middle + 1, siblingHeader->count * sizeof(T));
+		memcpy(getChildren(sibling), getChildren(child) + middle + 1, (siblingHeader->count + 1) * sizeof(uint32_t));
+		childHeader->count = (uint16_t)middle;
+	}
+
+	//Makes room in the parent for the separator and the new child
+	DiskNodeHeader* parentHeader = getNodeHeader(parent);
+	T* parentValues = getValues(parent);
+	uint32_t* parentChildren = getChildren(parent);
+	memmove(parentValues + childIndex + 1, parentValues + childIndex, (parentHeader->count - childIndex) * sizeof(T));
+	memmove(parentChildren + childIndex + 2, parentChildren + childIndex + 1, (parentHeader->count - childIndex) * sizeof(uint32_t));
+	parentValues[childIndex] = *separator;
+	parentChildren[childIndex + 1] = siblingId;
+	parentHeader->count++;
+
+	m_pool.unpinPage(siblingId, true);
+	return true;
+}
+
+template<typename T>
+inline int DiskTree<T>::findChildIndex(char* page, const T& value)
+{
+	//Every value in a child is at least the separator before it, so equal values go right
+	T* values = getValues(page);
+	return (int)(std::upper_bound(values, values + getNodeHeader(page)->count, value) - values);
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+template<typename T>
+class TreeNode;
+
+/// <summary>
+/// A fixed size table of nodes that were found recently. Each value can only be stored in
+/// the one slot its hash picks, so checking the cache costs a single comparison
+/// </summary>
+template<typename T>
+class FindCache
+{
+public:
+	/// <summary>
+	/// Whether or not values of this type can be hashed and cached
+	/// </summary>
+	static const bool IS_SUPPORTED = std::is_default_constructible<std::hash<T>>::value;
+
+	/// <summary>
+	/// Creates a cache with at least the given number of slots, rounded up to a power of two
+	/// </summary>
+	/// <param name="slotCount">The number of nodes the cache can hold</param>
+	explicit FindCache(size_t slotCount);
+
+	/// <summary>
+	/// Returns the cached node holding the value, or nullptr if it isn't cached
+	/// </summary>
+	/// <param name="value">The value to search for</param>
+	TreeNode<T>* lookup(const T& value);
+	/// <summary>
+	/// Remembers the node that holds the value, replacing whatever was in its slot
+	/// </summary>
+	/// <param name="value">The value the node holds</param>
+	/// <param name="node">The node to remember</param>
+	void store(const T& value, TreeNode<T>* node);
+	/// <summary>
+	/// Forgets the node if it is cached
+	/// </summary>
+	/// <param name="node">The node that is leaving the tree</param>
+	void invalidate(TreeNode<T>* node);
+	/// <summary>
+	/// Forgets every cached node
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// Returns how many lookups found their node in the cache
+	/// </summary>
+	uint64_t getHitCount() const;
+	/// <summary>
+	/// Returns how many lookups didn't find their node in the cache
+	/// </summary>
+	uint64_t getMissCount() const;
+	/// <summary>
+	/// Returns how many nodes the cache can hold
+	/// </summary>
+	size_t getSlotCount() const;
+
+private:
+	/// <summary>
+	/// Returns the index of the slot the value is stored in
+	/// </summary>
+	size_t getSlot(const T& value) const;
+
+	std::vector<TreeNode<T>*> m_slots;
+	size_t m_mask = 0;
+	uint64_t m_hitCount = 0;
+	uint64_t m_missCount = 0;
+};
+
+template<typename T>
+inline FindCache<T>::FindCache(size_t slotCount)
+{
+	//Rounds up to a power of two so a slot can be picked with a mask instead of a division
+	size_t size = 1;
+	while (size < slotCount)
+		size <<= 1;
+
+	m_slots.assign(size, nullptr);
+	m_mask = size - 1;
+}
+
+template<typename T>
+inline TreeNode<T>* FindCache<T>::lookup(const T& value)
+{
+	TreeNode<T>* node = m_slots[getSlot(value)];
+
+	//The slot may hold a different value with the same hash
+	if (node && !(node->getData() < value) && !(value < node->getData()))
+	{
+		m_hitCount++;
+		return node;
+	}
+
+	m_missCount++;
+	return nullptr;
+}
+
+template<typename T>
+inline void FindCache<T>::store(const T& value, TreeNode<T>* node)
+{
+	m_slots[getSlot(value)] = node;
+}
+
+template<typename T>
+inline void FindCache<T>::invalidate(TreeNode<T>* node)
+{
+	size_t slot = getSlot(node->getData());
+	if (m_slots[slot] == node)
+		m_slots[slot] = nullptr;
+}
+
+template<typename T>
+inline void FindCache<T>::clear()
+{
+	std::fill(m_slots.begin(), m_slots.end(), nullptr);
+}
+
+template<typename T>
+inline uint64_t FindCache<T>::getHitCount() const
+{
+	return m_hitCount;
+}
+
+template<typename T>
+inline uint64_t FindCache<T>::getMissCount() const
+{
+	return m_missCount;
+}
+
+template<typename T>
+inline size_t FindCache<T>::getSlotCount() const
+{
+	return m_slots.size();
+}
+
+template<typename T>
+inline size_t FindCache<T>::getSlot(const T& value) const
+{
+	if constexpr (IS_SUPPORTED)
+	{
+		//Mixes the hash so values that only differ in their high bits still land in different slots
+		uint64_t hash = (uint64_t)std::hash<T>()(value);
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		return (size_t)hash & m_mask;
+	}
+	else
+		return 0;
+}
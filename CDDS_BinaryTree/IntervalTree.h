@@ -0,0 +1,176 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "BinaryTree.h"
+#include "TreeNode.h"
+
+template<typename T>
+class IntervalTree;
+
+/// <summary>
+/// A closed range of values. Intervals are ordered by their low end, then their high end
+/// </summary>
+template<typename T>
+struct Interval
+{
+	/// <summary>
+	/// Creates the interval between the two ends. Ends given in reverse are swapped, since an interval
+	/// whose high end is below its low end would make the tree skip subtrees that hold overlapping intervals
+	/// </summary>
+	Interval(T lowValue, T highValue) : low(lowValue), high(highValue), maxHigh(highValue)
+	{
+		if (high < low)
+		{
+			std::swap(low, high);
+			maxHigh = high;
+		}
+	}
+
+	T low;
+	T high;
+
+private:
+	friend class IntervalTree<T>;
+
+	/// <summary>
+	/// The largest high end of any interval in the subtree of the node storing this interval.
+	/// Only the tree reads it, since it is stale in any copy handed out. It isn't part of the order,
+	/// so the tree refreshes it in place while the interval sits in a node
+	/// </summary>
+	mutable T maxHigh;
+};
+
+template<typename T>
+inline bool operator<(const Interval<T>& lhs, const Interval<T>& rhs) { return lhs.low < rhs.low || (!(rhs.low < lhs.low) && lhs.high < rhs.high); }
+template<typename T>
+inline bool operator>(const Interval<T>& lhs, const Interval<T>& rhs) { return rhs < lhs; }
+template<typename T>
+inline bool operator==(const Interval<T>& lhs, const Interval<T>& rhs) { return !(lhs < rhs) && !(rhs < lhs); }
+template<typename T>
+inline bool operator!=(const Interval<T>& lhs, const Interval<T>& rhs) { return !(lhs == rhs); }
+
+template<typename T>
+class IntervalTree : public BinaryTree<Interval<T>>
+{
+public:
+
+	IntervalTree();
+	/// <summary>
+	/// Creates a separate copy of every node in the tree, along with the highest end kept for each subtree
+	/// </summary>
+	/// <returns>A new interval tree with the same shape and intervals, without a log or find cache</returns>
+	IntervalTree<T> clone() const;
+
+	/// <summary>
+	/// Adds the interval with the given ends to the tree. Ends given in reverse are swapped
+	/// </summary>
+	/// <param name="low">The low end of the interval</param>
+	/// <param name="high">The high end of the interval</param>
+	void insert(T low, T high);
+	/// <summary>
+	/// Removes the interval with the given ends from the tree. Ends given in reverse are swapped
+	/// </summary>
+	/// <param name="low">The low end of the interval</param>
+	/// <param name="high">The high end of the interval</param>
+	void remove(T low, T high);
+
+	/// <summary>
+	/// Adds every interval that contains the given point to the results
+	/// </summary>
+	/// <param name="point">The point the intervals must contain</param>
+	/// <param name="results">The list the intervals that were found are added to</param>
+	void findContaining(T point, std::vector<Interval<T>>& results) const;
+	/// <summary>
+	/// Adds every interval that overlaps the given range to the results. Ends given in reverse are swapped
+	/// </summary>
+	/// <param name="low">The low end of the range</param>
+	/// <param name="high">The high end of the range</param>
+	/// <param name="results">The list the intervals that were found are added to</param>
+	void findOverlapping(T low, T high, std::vector<Interval<T>>& results) const;
+
+protected:
+	/// <summary>
+	/// Recalculates the largest high end in the node's subtree from its children
+	/// </summary>
+	void updateNode(TreeNode<Interval<T>>* node) override;
+};
+
+template<typename T>
+inline IntervalTree<T>::IntervalTree()
+{
+	this->m_isAugmented = true;
+}
+
+template<typename T>
+inline IntervalTree<T> IntervalTree<T>::clone() const
+{
+	IntervalTree<T> copy;
+	this->cloneInto(copy);
+	return copy;
+}
+
+template<typename T>
+inline void IntervalTree<T>::insert(T low, T high)
+{
+	BinaryTree<Interval<T>>::insert(Interval<T>(low, high));
+}
+
+template<typename T>
+inline void IntervalTree<T>::remove(T low, T high)
+{
+	BinaryTree<Interval<T>>::remove(Interval<T>(low, high));
+}
+
+template<typename T>
+inline void IntervalTree<T>::findContaining(T point, std::vector<Interval<T>>& results) const
+{
+	findOverlapping(point, point, results);
+}
+
+template<typename T>
+inline void IntervalTree<T>::findOverlapping(T low, T high, std::vector<Interval<T>>& results) const
+{
+	if (high < low)
+		std::swap(low, high);
+
+	//Keeps the subtrees that still need to be searched
+	std::vector<TreeNode<Interval<T>>*> nodesToVisit;
+	if (this->getRoot())
+		nodesToVisit.push_back(this->getRoot());
+
+	while (!nodesToVisit.empty())
+	{
+		TreeNode<Interval<T>>* currentNode = nodesToVisit.back();
+		nodesToVisit.pop_back();
+		const Interval<T>& interval = currentNode->getData();
+
+		//Skip the whole subtree if every interval in it ends before the range starts
+		if (interval.maxHigh < low)
+			continue;
+
+		if (currentNode->hasLeft())
+			nodesToVisit.push_back(currentNode->getLeft());
+
+		//If this interval starts after the range ends, so does everything to its right
+		if (high < interval.low)
+			continue;
+
+		if (!(interval.high < low))
+			results.push_back(interval);
+
+		if (currentNode->hasRight())
+			nodesToVisit.push_back(currentNode->getRight());
+	}
+}
+
+template<typename T>
+inline void IntervalTree<T>::updateNode(TreeNode<Interval<T>>* node)
+{
+	const Interval<T>& interval = node->getData();
+	interval.maxHigh = interval.high;
+
+	if (node->hasLeft() && interval.maxHigh < node->getLeft()->getData().maxHigh)
+		interval.maxHigh = node->getLeft()->getData().maxHigh;
+	if (node->hasRight() && interval.maxHigh < node->getRight()->getData().maxHigh)
+		interval.maxHigh = node->getRight()->getData().maxHigh;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include "TreeStats.h"
+
+template<typename T>
+class TreeNode;
+
+/// <summary>
+/// A single block of memory with room for a fixed number of nodes, handed out one after another.
+/// Nodes made next to each other sit next to each other in memory, and the whole block is freed at once.
+/// A node in an arena must be destroyed with destroyNode instead of delete, and the arena must outlive
+/// every node made in it, which trees do by sharing ownership of the arenas their nodes came from
+/// </summary>
+template<typename T>
+class NodeArena
+{
+public:
+	/// <summary>
+	/// Allocates room for the given number of nodes without creating any of them
+	/// </summary>
+	/// <param name="capacity">The number of nodes the arena can hold</param>
+	explicit NodeArena(size_t capacity);
+	/// <summary>
+	/// Frees the block. Every node made in it must already have been destroyed
+	/// </summary>
+	~NodeArena();
+
+	NodeArena(const NodeArena<T>&) = delete;
+	NodeArena<T>& operator=(const NodeArena<T>&) = delete;
+
+	/// <summary>
+	/// Creates a node in the next free slot
+	/// </summary>
+	/// <param name="value">The value the node holds</param>
+	/// <returns>The new node, or nullptr if the arena is full</returns>
+	TreeNode<T>* createNode(const T& value);
+
+	/// <summary>
+	/// Returns the number of nodes the arena can hold
+	/// </summary>
+	size_t getCapacity() const;
+	/// <summary>
+	/// Returns the number of nodes that have been made in the arena, including any destroyed since
+	/// </summary>
+	size_t getUsed() const;
+
+	/// <summary>
+	/// Deletes a node made with new, or only destroys a node that lives in an arena, leaving its slot to the arena
+	/// </summary>
+	/// <param name="node">The node to get rid of, or nullptr</param>
+	static void destroyNode(TreeNode<T>* node);
+	/// <summary>
+	/// Moves a node that lives in an arena into a node made with new, so it can be owned on its own.
+	/// Nodes that are already on their own are returned as they are
+	/// </summary>
+	/// <param name="node">A node that isn't linked into a tree</param>
+	/// <returns>A node made with new holding the same value, count and priority</returns>
+	static TreeNode<T>* moveOutOfArena(TreeNode<T>* node);
+
+private:
+	TreeNode<T>* m_nodes = nullptr;
+	size_t m_capacity = 0;
+	size_t m_used = 0;
+};
+
+template<typename T>
+inline NodeArena<T>::NodeArena(size_t capacity) : m_capacity(capacity)
+{
+	//Only the memory is allocated here, the nodes are created in place as they are needed
+	if (m_capacity > 0)
+	{
+		TREE_STATS_ALLOCATION();
+		m_nodes = std::allocator<TreeNode<T>>().allocate(m_capacity);
+	}
+}
+
+template<typename T>
+inline NodeArena<T>::~NodeArena()
+{
+	if (m_nodes)
+	{
+		TREE_STATS_FREE();
+		std::allocator<TreeNode<T>>().deallocate(m_nodes, m_capacity);
+	}
+}
+
+template<typename T>
+inline TreeNode<T>* NodeArena<T>::createNode(const T& value)
+{
+	if (m_used == m_capacity)
+		return nullptr;
+
+	TreeNode<T>* node = new (m_nodes + m_used) TreeNode<T>(value);
+	node->setInArena(true);
+	m_used++;
+	return node;
+}
+
+template<typename T>
+inline size_t NodeArena<T>::getCapacity() const
+{
+	return m_capacity;
+}
+
+template<typename T>
+inline size_t NodeArena<T>::getUsed() const
+{
+	return m_used;
+}
+
+template<typename T>
+inline void NodeArena<T>::destroyNode(TreeNode<T>* node)
+{
+	if (!node)
+		return;
+
+	if (node->isInArena())
+		node->~TreeNode<T>();
+	else
+	{
+		TREE_STATS_FREE();
+		delete node;
+	}
+}
+
+template<typename T>
+inline TreeNode<T>* NodeArena<T>::moveOutOfArena(TreeNode<T>* node)
+{
+	if (!node || !node->isInArena())
+		return node;
+
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* ownNode = new TreeNode<T>(std::move(node->m_value));
+	ownNode->setCount(node->getCount());
+	ownNode->setPriority(node->getPriority());
+	destroyNode(node);
+	return ownNode;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "TreeStats.h"
+
+template<typename T>
+class TreeNode;
+
+/// <summary>
+/// Owns a node that has been taken out of a tree. The node can be inserted into another tree
+/// without being deleted and created again, and it is deleted if the handle is dropped first
+/// </summary>
+template<typename T>
+class NodeHandle
+{
+public:
+	NodeHandle() {}
+	/// <summary>
+	/// Takes ownership of a node that isn't in any tree
+	/// </summary>
+	/// <param name="node">The node to own, or nullptr</param>
+	explicit NodeHandle(TreeNode<T>* node);
+	~NodeHandle();
+
+	NodeHandle(const NodeHandle<T>&) = delete;
+	NodeHandle<T>& operator=(const NodeHandle<T>&) = delete;
+	NodeHandle(NodeHandle<T>&& other);
+	NodeHandle<T>& operator=(NodeHandle<T>&& other);
+
+	/// <summary>
+	/// Returns whether or not the handle owns a node
+	/// </summary>
+	bool isEmpty() const;
+	/// <summary>
+	/// Returns the data the node contains. It can be changed while the node isn't in a tree
+	/// </summary>
+	T& getData() const;
+	/// <summary>
+	/// Returns how many copies of the data the node stands for
+	/// </summary>
+	unsigned int getCount() const;
+	/// <summary>
+	/// Returns the node without giving up ownership of it
+	/// </summary>
+	TreeNode<T>* getNode() const;
+	/// <summary>
+	/// Gives up ownership of the node and leaves the handle empty
+	/// </summary>
+	/// <returns>The node, which the caller is now responsible for</returns>
+	TreeNode<T>* release();
+
+private:
+	TreeNode<T>* m_node = nullptr;
+};
+
+template<typename T>
+inline NodeHandle<T>::NodeHandle(TreeNode<T>* node) : m_node(node)
+{
+}
+
+template<typename T>
+inline NodeHandle<T>::~NodeHandle()
+{
+	if (m_node)
+		TREE_STATS_FREE();
+	delete m_node;
+}
+
+template<typename T>
+inline NodeHandle<T>::NodeHandle(NodeHandle<T>&& other) : m_node(other.m_node)
+{
+	other.m_node = nullptr;
+}
+
+template<typename T>
+inline NodeHandle<T>& NodeHandle<T>::operator=(NodeHandle<T>&& other)
+{
+	if (&other != this)
+	{
+		if (m_node)
+			TREE_STATS_FREE();
+		delete m_node;
+		m_node = other.m_node;
+		other.m_node = nullptr;
+	}
+	return *this;
+}
+
+template<typename T>
+inline bool NodeHandle<T>::isEmpty() const
+{
+	return m_node == nullptr;
+}
+
+template<typename T>
+inline T& NodeHandle<T>::getData() const
+{
+	return m_node->m_value;
+}
+
+template<typename T>
+inline unsigned int NodeHandle<T>::getCount() const
+{
+	return m_node->getCount();
+}
+
+template<typename T>
+inline TreeNode<T>* NodeHandle<T>::getNode() const
+{
+	return m_node;
+}
+
+template<typename T>
+inline TreeNode<T>* NodeHandle<T>::release()
+{
+	TreeNode<T>* node = m_node;
+	m_node = nullptr;
+	return node;
+}
@@ -0,0 +1,292 @@
+#pragma once
+#include "BinaryTree.h"
+#include "TreeNode.h"
+#include "TreeStats.h"
+
+/// <summary>
+/// A tree that moves every node it finds to the root, so values that are used often stay near the top.
+/// Any series of operations takes O(log n) time per operation on average.
+/// Because find changes the shape of the tree, a splay tree must only be used by one thread at a time,
+/// and nodes returned by find stay valid but may have moved.
+/// Every insert, remove, erase, extract and find splays. Operations that build or cut the whole tree
+/// (bulkLoad, loadFrom, unionWith, intersect, difference, split and join) and the lookups count and findKey don't.
+/// Neither does anything called through a BinaryTree reference or pointer, since the base members aren't virtual.
+/// The tree stays in order either way, but the average bound only holds for the operations that splay
+/// </summary>
+template<typename T>
+class SplayTree : public BinaryTree<T>
+{
+public:
+
+	SplayTree() {}
+	/// <summary>
+	/// Creates a tree that either ignores duplicate values or counts them
+	/// </summary>
+	/// <param name="isMultiset">Whether inserting a value that is already in the tree should add another copy of it</param>
+	explicit SplayTree(bool isMultiset) : BinaryTree<T>(isMultiset) {}
+	/// <summary>
+	/// Creates a separate copy of every node in the tree
+	/// </summary>
+	/// <returns>A new splay tree with the same shape and values, without a log or find cache</returns>
+	SplayTree<T> clone() const;
+
+	/// <summary>
+	/// Adds the value to the tree and moves its node to the root
+	/// </summary>
+	/// <param name="value">The new value to add to the tree</param>
+	/// <returns>The node storing the value</returns>
+	TreeNode<T>* insert(T value);
+	/// <summary>
+	/// Places a node that was extracted from this or another tree and moves the node storing its value to the root
+	/// </summary>
+	/// <param name="handle">The handle owning the node, which is left empty unless a set already has the value</param>
+	/// <returns>The node storing the value</returns>
+	TreeNode<T>* insert(NodeHandle<T>& handle);
+	/// <summary>
+	/// A hint is no use in a tree that moves the node it inserts to the root. Use insert(value) instead
+	/// </summary>
+	TreeNode<T>* insert(TreeNode<T>* hint, T value) = delete;
+	/// <summary>
+	/// Returns the node whose value is equivalent to the key, or builds a value in place from the arguments
+	/// and adds it. Either way the node storing the key's value is moved to the root
+	/// </summary>
+	/// <param name="key">The key to search for, which must order the same as the value the arguments build</param>
+	/// <param name="args">The arguments passed to the value's constructor</param>
+	/// <returns>The node storing the key's value and whether or not it was just added</returns>
+	template<typename Key, typename... Args>
+	std::pair<TreeNode<T>*, bool> tryEmplace(const Key& key, Args&&... args);
+	/// <summary>
+	/// Moves the node with the given value to the root, then removes it
+	/// </summary>
+	/// <param name="value">The value to remove</param>
+	void remove(T value);
+	/// <summary>
+	/// Moves the node to the root, then removes it along with every copy it stands for
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	void erase(TreeNode<T>* node);
+	/// <summary>
+	/// Removes the node the iterator is at, moving it to the root first
+	/// </summary>
+	/// <param name="position">An iterator at a node in the tree</param>
+	/// <returns>An iterator at the node after the one removed</returns>
+	typename BinaryTree<T>::Iterator erase(typename BinaryTree<T>::Iterator position);
+	/// <summary>
+	/// Moves the node holding the value to the root, then takes it out of the tree without deleting it
+	/// </summary>
+	/// <param name="value">The value of the node to take out</param>
+	/// <returns>A handle owning the node, which is empty if the value isn't in the tree</returns>
+	NodeHandle<T> extract(T value);
+	/// <summary>
+	/// Moves the node to the root, then takes it out of the tree without deleting it
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	/// <returns>A handle owning the node</returns>
+	NodeHandle<T> extract(TreeNode<T>* node);
+	/// <summary>
+	/// Finds the node with the given value and moves it to the root. If the value isn't in the tree,
+	/// the last node reached while searching is moved to the root instead
+	/// </summary>
+	/// <param name="value">The value of the node to search for</param>
+	TreeNode<T>* find(T value);
+
+private:
+	/// <summary>
+	/// Moves the node closest to the value up to the root, taking the nodes passed on the way
+	/// apart into a left and right tree and joining them back under it. No parent pointers are needed
+	/// </summary>
+	/// <param name="key">The value, or a key that orders the same way, to search for</param>
+	template<typename Key>
+	void splay(const Key& key);
+};
+
+template<typename T>
+inline SplayTree<T> SplayTree<T>::clone() const
+{
+	SplayTree<T> copy(this->isMultiset());
+	this->cloneInto(copy);
+	return copy;
+}
+
+template<typename T>
+inline TreeNode<T>* SplayTree<T>::insert(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	BinaryTree<T>::insert(value);
+	splay(value);
+	return this->getRoot();
+}
+
+template<typename T>
+inline TreeNode<T>* SplayTree<T>::insert(NodeHandle<T>& handle)
+{
+	if (handle.isEmpty())
+		return nullptr;
+
+	//The node may be deleted once its copies are counted on an existing node, so its value is kept first
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	T value = handle.getData();
+	BinaryTree<T>::insert(handle);
+	splay(value);
+	return this->getRoot();
+}
+
+template<typename T>
+template<typename Key, typename... Args>
+inline std::pair<TreeNode<T>*, bool> SplayTree<T>::tryEmplace(const Key& key, Args&&... args)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	bool isAdded = BinaryTree<T>::tryEmplace(key, std::forward<Args>(args)...).second;
+	splay(key);
+	return std::pair<TreeNode<T>*, bool>(this->getRoot(), isAdded);
+}
+
+template<typename T>
+inline void SplayTree<T>::remove(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+
+	//Removing the root only has to walk down to its successor
+	splay(value);
+	BinaryTree<T>::remove(value);
+}
+
+template<typename T>
+inline void SplayTree<T>::erase(TreeNode<T>* node)
+{
+	if (!node)
+		return;
+
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	splay(node->getData());
+	BinaryTree<T>::erase(node);
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator SplayTree<T>::erase(typename BinaryTree<T>::Iterator position)
+{
+	//Splaying moves nodes around but never replaces them, so the next node is still the one after
+	TreeNode<T>* nodeToRemove = position.getNode();
+	++position;
+	erase(nodeToRemove);
+	return position;
+}
+
+template<typename T>
+inline NodeHandle<T> SplayTree<T>::extract(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	splay(value);
+	return BinaryTree<T>::extract(value);
+}
+
+template<typename T>
+inline NodeHandle<T> SplayTree<T>::extract(TreeNode<T>* node)
+{
+	if (!node)
+		return NodeHandle<T>();
+
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	splay(node->getData());
+	return BinaryTree<T>::extract(node);
+}
+
+template<typename T>
+inline TreeNode<T>* SplayTree<T>::find(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Find);
+	splay(value);
+
+	TreeNode<T>* root = this->getRoot();
+	if (root && !(root->getData() < value) && !(value < root->getData()))
+		return root;
+	return nullptr;
+}
+
+template<typename T>
+template<typename Key>
+inline void SplayTree<T>::splay(const Key& key)
+{
+	TreeNode<T>* currentNode = this->getRoot();
+	if (!currentNode)
+		return;
+
+	//The nodes smaller than the key are gathered into a left tree and the larger ones into a right tree.
+	//New nodes are always added to the largest end of the left tree and the smallest end of the right tree
+	TreeNode<T>* leftRoot = nullptr;
+	TreeNode<T>* leftLargest = nullptr;
+	TreeNode<T>* rightRoot = nullptr;
+	TreeNode<T>* rightSmallest = nullptr;
+
+	while (true)
+	{
+		TREE_STATS_VISIT();
+		if (TREE_STATS_COMPARE(key < currentNode->getData()))
+		{
+			if (!currentNode->hasLeft())
+				break;
+
+			//Rotates right when going left twice in a row, which halves the depth of the path
+			if (TREE_STATS_COMPARE(key < currentNode->getLeft()->getData()))
+			{
+				TREE_STATS_ROTATION();
+				TreeNode<T>* leftChild = currentNode->getLeft();
+				currentNode->setLeft(leftChild->getRight());
+				leftChild->setRight(currentNode);
+				currentNode = leftChild;
+				if (!currentNode->hasLeft())
+					break;
+			}
+
+			//Moves the current node into the right tree
+			if (rightSmallest)
+				rightSmallest->setLeft(currentNode);
+			else
+				rightRoot = currentNode;
+			rightSmallest = currentNode;
+			currentNode = currentNode->getLeft();
+		}
+		else if (TREE_STATS_COMPARE(currentNode->getData() < key))
+		{
+			if (!currentNode->hasRight())
+				break;
+
+			//Rotates left when going right twice in a row
+			if (TREE_STATS_COMPARE(currentNode->getRight()->getData() < key))
+			{
+				TREE_STATS_ROTATION();
+				TreeNode<T>* rightChild = currentNode->getRight();
+				currentNode->setRight(rightChild->getLeft());
+				rightChild->setLeft(currentNode);
+				currentNode = rightChild;
+				if (!currentNode->hasRight())
+					break;
+			}
+
+			//Moves the current node into the left tree
+			if (leftLargest)
+				leftLargest->setRight(currentNode);
+			else
+				leftRoot = currentNode;
+			leftLargest = currentNode;
+			currentNode = currentNode->getRight();
+		}
+		else
+			break;
+	}
+
+	//Hangs the current node's children off the left and right trees, then makes those trees its children
+	if (leftLargest)
+	{
+		leftLargest->setRight(currentNode->getLeft());
+		currentNode->setLeft(leftRoot);
+	}
+	if (rightSmallest)
+	{
+		rightSmallest->setLeft(currentNode->getRight());
+		currentNode->setRight(rightRoot);
+	}
+
+	this->setRoot(currentNode);
+	this->forgetHeight();
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include "../AggregateTree.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// The first and last value of a range and how many copies it holds. Combining spans isn't commutative,
+/// so a range combined out of order gives the wrong ends
+/// </summary>
+struct Span
+{
+	Span() {}
+	explicit Span(int value) : first(value), last(value), count(1) {}
+
+	int first = 0;
+	int last = 0;
+	int count = 0;
+};
+
+inline bool operator==(const Span& lhs, const Span& rhs) { return lhs.first == rhs.first && lhs.last == rhs.last && lhs.count == rhs.count; }
+
+struct SpanMonoid
+{
+	typedef Span Type;
+	static Span identity() { return Span(); }
+	static Span combine(const Span& lhs, const Span& rhs)
+	{
+		if (lhs.count == 0)
+			return rhs;
+		if (rhs.count == 0)
+			return lhs;
+
+		Span result;
+		result.first = lhs.first;
+		result.last = rhs.last;
+		result.count = lhs.count + rhs.count;
+		return result;
+	}
+};
+
+/// <summary>
+/// Combines every copy in the model between the ends one at a time
+/// </summary>
+template<typename Monoid>
+static typename Monoid::Type modelAggregate(const std::multiset<int>& model, int low, int high)
+{
+	typename Monoid::Type result = Monoid::identity();
+	for (std::multiset<int>::const_iterator it = model.lower_bound(low); it != model.end() && !(high < *it); ++it)
+		result = Monoid::combine(result, typename Monoid::Type(*it));
+	return result;
+}
+
+/// <summary>
+/// Makes random changes and checks the aggregate of random ranges, including empty and reversed ones, against the model
+/// </summary>
+template<typename Monoid>
+static void testRangeAggregate(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		AggregateTree<int, Monoid> tree(isMultiset);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 200);
+
+		for (int step = 0; step < 200; step++)
+		{
+			int value = (int)(random() % valueRange);
+			if (random() % 3 == 0)
+			{
+				tree.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+			}
+			else
+			{
+				tree.insert(value);
+				if (isMultiset || model.count(value) == 0)
+					model.insert(value);
+			}
+
+			int low = (int)(random() % (valueRange + 2)) - 1;
+			int high = (int)(random() % (valueRange + 2)) - 1;
+			CHECK(tree.rangeAggregate(low, high) == modelAggregate<Monoid>(model, low, high));
+		}
+
+		CHECK(tree.aggregate() == modelAggregate<Monoid>(model, -1, valueRange));
+		CHECK(tree.rangeAggregate(-1, valueRange) == tree.aggregate());
+		CHECK(isConsistent(tree));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(30);
+	testRangeAggregate<SumMonoid<int>>(random);
+	testRangeAggregate<MinMonoid<int>>(random);
+	testRangeAggregate<MaxMonoid<int>>(random);
+	testRangeAggregate<SpanMonoid>(random);
+
+	//An empty tree, and a range between two values, give the identity
+	{
+		AggregateTree<int, SumMonoid<int>> tree;
+		CHECK(tree.aggregate() == 0);
+		tree.insert(10);
+		tree.insert(20);
+		CHECK(tree.rangeAggregate(11, 19) == 0);
+		CHECK(tree.rangeAggregate(10, 20) == 30);
+	}
+
+	//Many copies of a value are combined in a few steps and still count every copy
+	{
+		AggregateTree<int, SumMonoid<int>> tree(true);
+		for (int i = 0; i < 1000; i++)
+			tree.insert(3);
+		tree.insert(5);
+		CHECK(tree.aggregate() == 3005);
+		CHECK(tree.rangeAggregate(0, 4) == 3000);
+	}
+
+	return finishTest("AggregateTreeTests");
+}
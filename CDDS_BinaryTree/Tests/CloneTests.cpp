@@ -0,0 +1,194 @@
+#include <memory>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "../AggregateTree.h"
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Returns whether or not the trees have the same shape, values, counts and priorities, without sharing a single node.
+/// The copy must also sit in one arena in pre-order, so every node is the one after the node visited before it
+/// </summary>
+template<typename T>
+static bool isSeparateCopy(const BinaryTree<T>& tree, const BinaryTree<T>& copy)
+{
+	std::vector<TreeNode<T>*> nodes;
+	std::vector<size_t> depths;
+	TreeTraversal<T>::preOrder(tree.getRoot(), [&](TreeNode<T>* node, size_t depth)
+	{
+		nodes.push_back(node);
+		depths.push_back(depth);
+	});
+
+	std::set<TreeNode<T>*> sourceNodes(nodes.begin(), nodes.end());
+	bool isSame = true;
+	size_t position = 0;
+	TreeNode<T>* firstNode = copy.getRoot();
+	TreeTraversal<T>::preOrder(copy.getRoot(), [&](TreeNode<T>* node, size_t depth)
+	{
+		if (position >= nodes.size() || sourceNodes.count(node) > 0 || !node->isInArena() || node != firstNode + position)
+			isSame = false;
+		else
+		{
+			const TreeNode<T>* source = nodes[position];
+			if (depth != depths[position] || source->getData() < node->getData() || node->getData() < source->getData() ||
+				node->getCount() != source->getCount() || node->getPriority() != source->getPriority())
+				isSame = false;
+		}
+		position++;
+	});
+	return isSame && position == nodes.size();
+}
+
+/// <summary>
+/// Clones random trees, then changes the tree and its copy in different ways and deletes one before the other.
+/// Each has to keep its own values, so nothing the copy does can reach the tree it came from
+/// </summary>
+template<typename Tree>
+static void testClone(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		std::unique_ptr<Tree> tree(new Tree(isMultiset));
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 200);
+		int valueCount = (int)(random() % 300);
+		for (int i = 0; i < valueCount; i++)
+		{
+			int value = (int)(random() % valueRange);
+			tree->insert(value);
+			if (isMultiset || model.count(value) == 0)
+				model.insert(value);
+		}
+
+		ModelLog<int> log(*tree);
+		tree->setLog(&log);
+		tree->setFindCacheSize(16);
+		std::unique_ptr<Tree> copy(new Tree(tree->clone()));
+		CHECK(isSeparateCopy<int>(*tree, *copy));
+		CHECK(copy->getLog() == nullptr && copy->getFindCache() == nullptr);
+		CHECK(copy->isMultiset() == isMultiset && copy->size() == tree->size());
+		CHECK(isConsistent(*copy));
+
+		//The copy is changed every way that frees or moves a node, which must not show up in the tree
+		std::multiset<int> copyModel = model;
+		for (int step = 0; step < 200; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 5)
+			{
+			case 0:
+				copy->insert(value);
+				if (isMultiset || copyModel.count(value) == 0)
+					copyModel.insert(value);
+				break;
+			case 1:
+				copy->remove(value);
+				if (copyModel.count(value) > 0)
+					copyModel.erase(copyModel.find(value));
+				break;
+			case 2:
+				if (copy->find(value))
+					copy->erase(copy->find(value));
+				copyModel.erase(value);
+				break;
+			case 3:
+			{
+				//A node that leaves the arena is moved into a node of its own, which the tree can take
+				NodeHandle<int> handle = copy->extract(value);
+				if (!handle.isEmpty())
+				{
+					copyModel.erase(value);
+					if (tree->find(value) == nullptr)
+					{
+						unsigned int copyCount = isMultiset ? handle.getCount() : 1;
+						CHECK(tree->insert(handle)->getData() == value);
+						for (unsigned int i = 0; i < copyCount; i++)
+							model.insert(value);
+					}
+				}
+				break;
+			}
+			default:
+				tree->remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+				break;
+			}
+		}
+
+		CHECK(treeValues(*tree) == modelValues<int>(model));
+		CHECK(treeValues(*copy) == modelValues<int>(copyModel));
+		CHECK(log.isValid() && log.getValues() == modelValues<int>(model));
+		if constexpr (std::is_same<Tree, Treap<int>>::value)
+			CHECK(isHeapOrdered(*tree) && isHeapOrdered(*copy));
+
+		//Either one can go first, and a copy of a copy is just as separate
+		tree->setLog(nullptr);
+		std::unique_ptr<Tree> copyOfCopy(new Tree(copy->clone()));
+		CHECK(isSeparateCopy<int>(*copy, *copyOfCopy));
+		if (random() % 2 == 0)
+			tree.reset();
+		else
+			copy.reset();
+		if (tree)
+			CHECK(treeValues(*tree) == modelValues<int>(model) && isConsistent(*tree));
+		if (copy)
+			CHECK(treeValues(*copy) == modelValues<int>(copyModel) && isConsistent(*copy));
+		copy.reset();
+		CHECK(treeValues(*copyOfCopy) == modelValues<int>(copyModel) && isConsistent(*copyOfCopy));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(44);
+	testClone<BinaryTree<int>>(random);
+	testClone<SplayTree<int>>(random);
+	testClone<Treap<int>>(random);
+
+	//Nodes joined from a copy into another tree keep the copy's arena alive after the copy is gone
+	{
+		BinaryTree<int> tree;
+		for (int value = 0; value < 50; value++)
+			tree.insert(value);
+
+		BinaryTree<int> right;
+		{
+			BinaryTree<int> source;
+			for (int value = 0; value < 100; value++)
+				source.insert((value * 37) % 100);
+			BinaryTree<int> copy = source.clone();
+			copy.split(50, right);
+			CHECK(copy.size() == 50 && right.size() == 50);
+		}
+		CHECK(tree.join(right));
+		CHECK(tree.size() == 100 && right.isEmpty());
+		CHECK(isConsistent(tree));
+	}
+
+	//A copy keeps the aggregate of every subtree, and adding after the largest value still works
+	{
+		AggregateTree<int, SumMonoid<int>> tree(true);
+		for (int value = 1; value <= 100; value++)
+			tree.insert(value % 10);
+		AggregateTree<int, SumMonoid<int>> copy = tree.clone();
+		CHECK(copy.aggregate() == 450 && copy.rangeAggregate(5, 9) == 350);
+		copy.insert(20);
+		tree.remove(9);
+		CHECK(copy.aggregate() == 470 && tree.aggregate() == 441);
+		CHECK(isConsistent(copy));
+
+		BinaryTree<int> empty;
+		BinaryTree<int> emptyCopy = empty.clone();
+		CHECK(emptyCopy.isEmpty() && emptyCopy.getRoot() == nullptr);
+		emptyCopy.insert(1);
+		CHECK(empty.isEmpty());
+	}
+
+	return finishTest("CloneTests");
+}
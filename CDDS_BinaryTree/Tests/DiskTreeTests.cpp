@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include "../DiskTree.h"
+#include "TestHelpers.h"
+
+static const char* TREE_PATH = "disk_tree_test.tree";
+
+/// <summary>
+/// A value so large that only a few fit on a page, so even small trees are several levels deep.
+/// It has no default constructor, which the tree mustn't need
+/// </summary>
+struct WideValue
+{
+	explicit WideValue(uint32_t valueKey) : key(valueKey), padding() {}
+
+	uint32_t key;
+	char padding[1000];
+};
+
+inline bool operator<(const WideValue& lhs, const WideValue& rhs) { return lhs.key < rhs.key; }
+
+/// <summary>
+/// Makes random changes with only a few pages in memory, closing and reopening the file now and then,
+/// and checks every value against std::set
+/// </summary>
+template<typename T>
+static void testDiskTree(std::mt19937& random, int stepCount, uint32_t valueRange)
+{
+	std::remove(TREE_PATH);
+	std::set<uint32_t> model;
+	size_t memoryPages = 3 + random() % 8;
+
+	DiskTree<T> tree;
+	CHECK(tree.open(TREE_PATH, memoryPages));
+	CHECK(tree.isEmpty());
+
+	for (int step = 0; step < stepCount; step++)
+	{
+		uint32_t key = (uint32_t)(random() % valueRange);
+		switch (random() % 100)
+		{
+		case 0:
+			CHECK(tree.flush());
+			break;
+		case 1:
+			//Everything written before closing is there after opening the file again
+			tree.close();
+			CHECK(tree.open(TREE_PATH, memoryPages));
+			CHECK(tree.getValueCount() == model.size());
+			break;
+		default:
+			if (random() % 4 == 0)
+			{
+				tree.remove(T(key));
+				model.erase(key);
+			}
+			else if (random() % 3 == 0)
+				CHECK(tree.find(T(key)) == (model.count(key) > 0));
+			else
+			{
+				tree.insert(T(key));
+				model.insert(key);
+			}
+			break;
+		}
+	}
+
+	CHECK(tree.getValueCount() == model.size());
+	tree.close();
+
+	CHECK(tree.open(TREE_PATH, memoryPages));
+	CHECK(tree.getValueCount() == model.size());
+	CHECK(tree.isEmpty() == model.empty());
+	for (uint32_t key = 0; key < valueRange; key++)
+		CHECK(tree.find(T(key)) == (model.count(key) > 0));
+	tree.close();
+}
+
+int main()
+{
+	std::mt19937 random(34);
+	for (int round = 0; round < 10; round++)
+	{
+		testDiskTree<uint32_t>(random, 20000, 1 + (uint32_t)(random() % 30000));
+		testDiskTree<WideValue>(random, 2000, 1 + (uint32_t)(random() % 1000));
+	}
+
+	//A file holding a tree of another type isn't opened
+	{
+		std::remove(TREE_PATH);
+		DiskTree<uint32_t> tree;
+		CHECK(tree.open(TREE_PATH, 4));
+		tree.insert(1);
+		tree.close();
+
+		DiskTree<uint64_t> otherTree;
+		CHECK(!otherTree.open(TREE_PATH, 4));
+	}
+
+	std::remove(TREE_PATH);
+	return finishTest("DiskTreeTests");
+}
@@ -0,0 +1,157 @@
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Adds copies of the value to the model the way a tree of the given kind counts them
+/// </summary>
+static void addCopies(std::multiset<int>& model, bool isMultiset, int value, unsigned int copyCount)
+{
+	if (!isMultiset)
+	{
+		if (model.count(value) == 0)
+			model.insert(value);
+		return;
+	}
+	for (unsigned int i = 0; i < copyCount; i++)
+		model.insert(value);
+}
+
+/// <summary>
+/// Moves random values back and forth between two trees of different kinds through node handles,
+/// checking both trees and both logs against std::multiset. A node that isn't in an arena is moved
+/// as it is, so the tree it lands in holds the very same node
+/// </summary>
+template<typename Source, typename Target>
+static void testTransfer(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		Source source(random() % 2 == 0);
+		Target target(random() % 2 == 0);
+		std::multiset<int> sourceModel;
+		std::multiset<int> targetModel;
+		int valueRange = 1 + (int)(random() % 60);
+
+		for (int i = 0; i < 100; i++)
+		{
+			int value = (int)(random() % valueRange);
+			source.insert(value);
+			addCopies(sourceModel, source.isMultiset(), value, 1);
+			if (random() % 3 == 0)
+			{
+				target.insert(value);
+				addCopies(targetModel, target.isMultiset(), value, 1);
+			}
+		}
+
+		ModelLog<int> sourceLog(source);
+		ModelLog<int> targetLog(target);
+		source.setLog(&sourceLog);
+		target.setLog(&targetLog);
+
+		for (int step = 0; step < 100; step++)
+		{
+			int value = (int)(random() % valueRange);
+			NodeHandle<int> handle = random() % 2 == 0 ? source.extract(value) : source.extract(source.find(value));
+			CHECK(handle.isEmpty() == (sourceModel.count(value) == 0));
+			if (handle.isEmpty())
+				continue;
+
+			unsigned int copyCount = (unsigned int)sourceModel.count(value);
+			CHECK(handle.getData() == value && handle.getCount() == copyCount);
+			sourceModel.erase(value);
+
+			TreeNode<int>* node = handle.getNode();
+			bool isPlaced = targetModel.count(value) == 0;
+			TreeNode<int>* placedNode = target.insert(handle);
+			CHECK(placedNode && placedNode->getData() == value);
+			CHECK(!isPlaced || placedNode == node);
+
+			//A set that already has the value leaves the node with the handle, so it can go back where it came from
+			if (!target.isMultiset() && !isPlaced)
+			{
+				CHECK(!handle.isEmpty() && handle.getNode() == node);
+				CHECK(source.insert(handle) == node);
+				addCopies(sourceModel, source.isMultiset(), value, copyCount);
+			}
+			else
+				addCopies(targetModel, target.isMultiset(), value, copyCount);
+			CHECK(handle.isEmpty());
+		}
+
+		CHECK(treeValues(source) == modelValues<int>(sourceModel));
+		CHECK(treeValues(target) == modelValues<int>(targetModel));
+		CHECK(isConsistent(source) && isConsistent(target));
+		if constexpr (std::is_same<Target, Treap<int>>::value)
+			CHECK(isHeapOrdered(target));
+		CHECK(sourceLog.isValid() && sourceLog.getValues() == modelValues<int>(sourceModel));
+		CHECK(targetLog.isValid() && targetLog.getValues() == modelValues<int>(targetModel));
+		source.setLog(nullptr);
+		target.setLog(nullptr);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(42);
+	testTransfer<BinaryTree<int>, BinaryTree<int>>(random);
+	testTransfer<BinaryTree<int>, Treap<int>>(random);
+	testTransfer<Treap<int>, SplayTree<int>>(random);
+	testTransfer<SplayTree<int>, BinaryTree<int>>(random);
+
+	//A node taken out of a cloned tree outlives the clone and its arena, since the handle gets a node of its own
+	{
+		BinaryTree<int> tree(true);
+		for (int value : { 4, 2, 6, 1, 3, 5, 7 })
+			tree.insert(value);
+		tree.insert(3);
+
+		NodeHandle<int> handle;
+		{
+			BinaryTree<int> copy = tree.clone();
+			handle = copy.extract(3);
+			CHECK(copy.count(3) == 0 && tree.count(3) == 2);
+		}
+		CHECK(!handle.isEmpty() && handle.getData() == 3 && handle.getCount() == 2);
+
+		Treap<int> treap(true);
+		CHECK(treap.insert(handle)->getData() == 3);
+		CHECK(treap.count(3) == 2 && isHeapOrdered(treap));
+	}
+
+	//A value can be changed while its node is out of every tree, and the node is placed by its new value
+	{
+		BinaryTree<int> source;
+		BinaryTree<int> target;
+		for (int value : { 10, 20, 30 })
+			source.insert(value);
+
+		NodeHandle<int> handle = source.extract(20);
+		handle.getData() = 25;
+		target.insert(40);
+		TreeNode<int>* node = handle.getNode();
+		CHECK(target.insert(handle) == node);
+		CHECK(treeValues(source) == std::vector<int>({ 10, 30 }));
+		CHECK(treeValues(target) == std::vector<int>({ 25, 40 }));
+		CHECK(isConsistent(target));
+	}
+
+	//A handle that is never placed deletes its node, and an empty handle places nothing
+	{
+		BinaryTree<int> tree;
+		tree.insert(1);
+		{
+			NodeHandle<int> handle = tree.extract(1);
+			CHECK(tree.isEmpty());
+		}
+		NodeHandle<int> empty = tree.extract(1);
+		CHECK(empty.isEmpty() && tree.insert(empty) == nullptr && tree.isEmpty());
+	}
+
+	return finishTest("ExtractTests");
+}
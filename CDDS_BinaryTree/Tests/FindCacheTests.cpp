@@ -0,0 +1,170 @@
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// A value std::hash knows nothing about, so it can't be cached
+/// </summary>
+struct UnhashedValue
+{
+	int key = 0;
+};
+
+inline bool operator<(const UnhashedValue& lhs, const UnhashedValue& rhs) { return lhs.key < rhs.key; }
+inline bool operator>(const UnhashedValue& lhs, const UnhashedValue& rhs) { return rhs.key < lhs.key; }
+
+/// <summary>
+/// Makes random changes of every kind that moves or deletes nodes, with caches small enough that values share slots.
+/// Every find has to return a node that is still in the tree and holds the value, which the sanitizers also watch for
+/// </summary>
+template<typename Tree>
+static void testInvalidation(std::mt19937& random)
+{
+	for (int round = 0; round < 300; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		Tree tree(isMultiset);
+		tree.setFindCacheSize(1 + random() % 16);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 60);
+
+		for (int step = 0; step < 300; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 10)
+			{
+			case 0:
+			case 1:
+				tree.insert(value);
+				if (isMultiset || model.count(value) == 0)
+					model.insert(value);
+				break;
+			case 2:
+				tree.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+				break;
+			case 3:
+				tree.erase(tree.find(value));
+				model.erase(value);
+				break;
+			case 4:
+			{
+				//The node comes back as a new node, since it may have left an arena
+				NodeHandle<int> handle = tree.extract(value);
+				if (!handle.isEmpty())
+					tree.insert(handle);
+				break;
+			}
+			case 5:
+			{
+				//Nodes cached before the split may now belong to the other half
+				Tree right(isMultiset);
+				tree.split(value, right);
+				if (random() % 2 == 0)
+					right.find(value);
+				tree.join(right);
+				break;
+			}
+			case 6:
+				if (random() % 10 == 0)
+				{
+					tree.clear();
+					model.clear();
+				}
+				break;
+			default:
+			{
+				TreeNode<int>* node = tree.find(value);
+				CHECK((node != nullptr) == (model.count(value) > 0));
+				if (node)
+				{
+					CHECK(node->getData() == value);
+					CHECK(node->getCount() == model.count(value));
+				}
+				break;
+			}
+			}
+		}
+
+		for (int value = 0; value < valueRange; value++)
+			CHECK(tree.count(value) == model.count(value));
+		CHECK(treeValues(tree) == modelValues<int>(model));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(35);
+	testInvalidation<BinaryTree<int>>(random);
+	testInvalidation<Treap<int>>(random);
+
+	//The first find misses and fills the cache, the next one hits, and a value that isn't there is never cached
+	{
+		BinaryTree<int> tree;
+		tree.setFindCacheSize(64);
+		for (int value : { 50, 25, 75, 10, 30 })
+			tree.insert(value);
+
+		const FindCache<int>* cache = tree.getFindCache();
+		TreeNode<int>* node = tree.find(30);
+		CHECK(node && node->getData() == 30);
+		CHECK(cache->getHitCount() == 0 && cache->getMissCount() == 1);
+		CHECK(tree.find(30) == node);
+		CHECK(cache->getHitCount() == 1 && cache->getMissCount() == 1);
+
+		CHECK(tree.find(31) == nullptr);
+		CHECK(tree.find(31) == nullptr);
+		CHECK(cache->getHitCount() == 1 && cache->getMissCount() == 3);
+
+		//Removing a node finds it through the cache and then forgets it, while removing one copy of many keeps the node
+		tree.remove(30);
+		CHECK(cache->getHitCount() == 2);
+		CHECK(tree.find(30) == nullptr);
+		CHECK(cache->getHitCount() == 2 && cache->getMissCount() == 4);
+		tree.insert(30);
+		CHECK(tree.find(30) && tree.find(30)->getData() == 30);
+
+		BinaryTree<int> multiset(true);
+		multiset.setFindCacheSize(8);
+		multiset.insert(7);
+		multiset.insert(7);
+		TreeNode<int>* copies = multiset.find(7);
+		multiset.remove(7);
+		CHECK(multiset.find(7) == copies && copies->getCount() == 1);
+		CHECK(multiset.getFindCache()->getHitCount() == 2);
+	}
+
+	//The cache is sized up to a power of two, turned off with zero, and never made for values that can't be hashed
+	{
+		BinaryTree<int> tree;
+		CHECK(tree.getFindCache() == nullptr);
+		tree.setFindCacheSize(100);
+		CHECK(tree.getFindCache() && tree.getFindCache()->getSlotCount() == 128);
+		tree.setFindCacheSize(0);
+		CHECK(tree.getFindCache() == nullptr);
+
+		BinaryTree<UnhashedValue> unhashed;
+		unhashed.setFindCacheSize(16);
+		CHECK(unhashed.getFindCache() == nullptr);
+		unhashed.insert(UnhashedValue());
+		CHECK(unhashed.find(UnhashedValue()) != nullptr);
+	}
+
+	//The cache moves with the nodes it points at
+	{
+		BinaryTree<int> tree;
+		tree.setFindCacheSize(16);
+		tree.insert(1);
+		TreeNode<int>* node = tree.find(1);
+		BinaryTree<int> moved = std::move(tree);
+		CHECK(tree.getFindCache() == nullptr);
+		CHECK(moved.find(1) == node);
+		CHECK(moved.getFindCache()->getHitCount() == 1);
+	}
+
+	return finishTest("FindCacheTests");
+}
@@ -0,0 +1,82 @@
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../AggregateTree.h"
+#include "../BinaryMap.h"
+#include "../BinaryTree.h"
+#include "../BufferPool.h"
+#include "../DiskTree.h"
+#include "../FindCache.h"
+#include "../IntervalTree.h"
+#include "../NodeArena.h"
+#include "../NodeHandle.h"
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "../TreeLog.h"
+#include "../TreeNode.h"
+#include "../TreeSnapshot.h"
+#include "../TreeStats.h"
+#include "../TreeTraversal.h"
+#include "../WriteAheadLog.h"
+#include "TestHelpers.h"
+
+//Members of a class template are only compiled when something uses them, so every container is
+//instantiated in full here. A header that stops compiling for one of these types fails the build
+template class BinaryTree<int>;
+template class BinaryTree<std::string>;
+template class SplayTree<int>;
+template class Treap<int>;
+template class IntervalTree<int>;
+template class AggregateTree<int, SumMonoid<int>>;
+template class AggregateTree<int, MinMonoid<int>>;
+template class AggregateTree<int, MaxMonoid<int>>;
+template class BinaryMap<int, std::string>;
+template class TreeSnapshot<int>;
+template class WriteAheadLog<int>;
+template class DiskTree<int>;
+template class DiskTree<uint64_t>;
+
+//The write-ahead log replays through the insert and remove of whichever kind of tree it is opened with
+template bool WriteAheadLog<int>::open(BinaryTree<int>&, const char*, const char*);
+template bool WriteAheadLog<int>::open(SplayTree<int>&, const char*, const char*);
+template bool WriteAheadLog<int>::open(Treap<int>&, const char*, const char*);
+
+//A node's data can only be read, since changing it in place could break the order of its tree
+static_assert(std::is_same<decltype(std::declval<TreeNode<int>&>().getData()), const int&>::value, "TreeNode::getData must be const");
+
+int main()
+{
+	//A map of values that can only be moved has to work without ever copying one
+	BinaryMap<int, std::unique_ptr<int>> ownerMap;
+	CHECK(ownerMap.tryEmplace(1, std::make_unique<int>(10)).second);
+	CHECK(!ownerMap.tryEmplace(1, std::make_unique<int>(20)).second);
+	CHECK(**ownerMap.find(1) == 10);
+	ownerMap.remove(1);
+	CHECK(ownerMap.isEmpty());
+
+	//A mapped value can be changed in place, while the key it is ordered by can't
+	BinaryMap<int, std::string> names;
+	names[2] = "two";
+	names[1] = "one";
+	*names.find(2) += "!";
+	CHECK(names[2] == "two!" && names[1] == "one" && names.size() == 2);
+
+	//Every derived tree clones to its own kind
+	SplayTree<int> splayTree;
+	Treap<int> treap;
+	for (int i = 0; i < 100; i++)
+	{
+		splayTree.insert(i * 7 % 100);
+		treap.insert(i * 7 % 100);
+	}
+
+	SplayTree<int> splayCopy = splayTree.clone();
+	Treap<int> treapCopy = treap.clone();
+	CHECK(treeValues(splayCopy) == treeValues(splayTree));
+	CHECK(treeValues(treapCopy) == treeValues(treap));
+	CHECK(isConsistent(splayCopy) && isConsistent(treapCopy));
+	CHECK(isHeapOrdered(treapCopy));
+
+	return finishTest("HeaderTests");
+}
@@ -0,0 +1,86 @@
+#include <random>
+#include <set>
+#include <vector>
+#include "../AggregateTree.h"
+#include "../BinaryMap.h"
+#include "../BinaryTree.h"
+#include "../BufferPool.h"
+#include "../DiskTree.h"
+#include "../FindCache.h"
+#include "../IntervalTree.h"
+#include "../NodeArena.h"
+#include "../NodeHandle.h"
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "../TreeLog.h"
+#include "../TreeNode.h"
+#include "../TreeSnapshot.h"
+#include "../TreeStats.h"
+#include "../TreeTraversal.h"
+#include "../WriteAheadLog.h"
+#include "TestHelpers.h"
+
+//The tests are built without raylib's include directory, so a core header that included raylib.h wouldn't compile here.
+//This catches one that finds an installed raylib instead. Only TreeVisualizer.h and the demo may draw
+#if defined(RAYLIB_H) || defined(RAYLIB_VERSION)
+#error "A core header includes raylib, so the tree can't be used without it"
+#endif
+
+/// <summary>
+/// Checks what TreeVisualizer takes from the public traversal: every node is visited after its parent,
+/// the parent is the last node visited one level up, and which side the node is on follows from comparing the two
+/// </summary>
+template<typename Tree>
+static void testDrawOrder(std::mt19937& random)
+{
+	for (int round = 0; round < 100; round++)
+	{
+		Tree tree(random() % 2 == 0);
+		std::set<int> values;
+		int valueCount = (int)(random() % 300);
+		for (int i = 0; i < valueCount; i++)
+		{
+			int value = (int)(random() % 500);
+			tree.insert(value);
+			values.insert(value);
+		}
+
+		std::vector<TreeNode<int>*> nodeByDepth;
+		size_t visitCount = 0;
+		bool isDrawable = true;
+		TreeTraversal<int>::preOrder(tree.getRoot(), [&](TreeNode<int>* node, size_t depth)
+		{
+			if (depth == 0)
+				isDrawable = isDrawable && node == tree.getRoot();
+			else
+			{
+				TreeNode<int>* parent = nodeByDepth[depth - 1];
+				bool isLeft = node->getData() < parent->getData();
+				isDrawable = isDrawable && (isLeft ? parent->getLeft() : parent->getRight()) == node;
+			}
+
+			nodeByDepth.resize(depth + 1);
+			nodeByDepth[depth] = node;
+			visitCount++;
+		});
+
+		CHECK(isDrawable);
+		CHECK(visitCount == values.size());
+	}
+}
+
+int main()
+{
+	std::mt19937 random(50);
+	testDrawOrder<BinaryTree<int>>(random);
+	testDrawOrder<SplayTree<int>>(random);
+	testDrawOrder<Treap<int>>(random);
+
+	//A tree with nothing in it gives the visualizer nothing to draw
+	BinaryTree<int> empty;
+	size_t visitCount = 0;
+	TreeTraversal<int>::preOrder(empty.getRoot(), [&](TreeNode<int>*, size_t) { visitCount++; });
+	CHECK(visitCount == 0);
+
+	return finishTest("HeadlessTests");
+}
@@ -0,0 +1,153 @@
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "TestHelpers.h"
+
+/// <summary>
+/// Returns a random node of the tree, or nullptr now and then, to use as a hint
+/// </summary>
+static TreeNode<int>* randomHint(const BinaryTree<int>& tree, std::mt19937& random)
+{
+	if (tree.isEmpty() || random() % 8 == 0)
+		return nullptr;
+
+	BinaryTree<int>::Iterator position = tree.begin();
+	for (int steps = (int)(random() % 16); steps > 0 && std::next(position) != tree.end(); steps--)
+		++position;
+	return position.getNode();
+}
+
+/// <summary>
+/// Inserts with hints that are right next to the value, far from it, holding it already or missing,
+/// and erases through iterators, checking the tree and its log against std::multiset
+/// </summary>
+static void testHints(std::mt19937& random)
+{
+	for (int round = 0; round < 300; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		BinaryTree<int> tree(isMultiset);
+		ModelLog<int> log(tree);
+		tree.setLog(&log);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 100);
+
+		for (int step = 0; step < 300; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 5)
+			{
+			case 0:
+			case 1:
+			{
+				//The node next to where the value belongs, found from the model
+				TreeNode<int>* hint = nullptr;
+				std::multiset<int>::iterator neighbour = random() % 2 == 0 ? model.lower_bound(value) : model.upper_bound(value);
+				if (neighbour != model.begin() && (neighbour == model.end() || random() % 2 == 0))
+					--neighbour;
+				if (neighbour != model.end())
+					hint = tree.find(*neighbour);
+
+				TreeNode<int>* node = tree.insert(hint, value);
+				CHECK(node && node->getData() == value);
+				if (isMultiset || model.count(value) == 0)
+					model.insert(value);
+				break;
+			}
+			case 2:
+			{
+				//A hint anywhere in the tree still puts the value in the right place
+				TreeNode<int>* node = tree.insert(randomHint(tree, random), value);
+				CHECK(node && node->getData() == value);
+				if (isMultiset || model.count(value) == 0)
+					model.insert(value);
+				break;
+			}
+			case 3:
+			{
+				//Erasing through an iterator drops every copy and returns the iterator at the next value
+				TreeNode<int>* node = tree.find(value);
+				if (!node)
+					break;
+				BinaryTree<int>::Iterator position = tree.erase(BinaryTree<int>::Iterator(node, &tree));
+				model.erase(value);
+				std::multiset<int>::iterator expected = model.upper_bound(value);
+				CHECK((position == tree.end()) == (expected == model.end()));
+				if (position != tree.end() && expected != model.end())
+					CHECK(*position == *expected);
+				break;
+			}
+			default:
+				tree.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+				break;
+			}
+		}
+
+		CHECK(treeValues(tree) == modelValues<int>(model));
+		CHECK(isConsistent(tree));
+		CHECK(log.isValid() && log.getValues() == modelValues<int>(model));
+
+		//Erasing every other node while stepping through the tree keeps the iterator valid
+		tree.setLog(nullptr);
+		std::set<int> kept;
+		bool isErased = false;
+		for (BinaryTree<int>::Iterator position = tree.begin(); position != tree.end(); isErased = !isErased)
+		{
+			if (isErased)
+				position = tree.erase(position);
+			else
+				kept.insert(*position++);
+		}
+		CHECK(std::vector<int>(tree.begin(), tree.end()) == std::vector<int>(kept.begin(), kept.end()));
+		CHECK(isConsistent(tree));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(41);
+	testHints(random);
+
+	//Values added in order with the last node as the hint, or in reverse with the first node, all end up in the tree
+	{
+		BinaryTree<int> tree;
+		TreeNode<int>* lastNode = nullptr;
+		for (int value = 0; value < 1000; value++)
+			lastNode = tree.insert(lastNode, value);
+		CHECK(tree.size() == 1000 && tree.height() == 1000);
+
+		TreeNode<int>* firstNode = tree.find(0);
+		for (int value = -1; value > -100; value--)
+			firstNode = tree.insert(firstNode, value);
+		CHECK(tree.size() == 1099 && tree.height() == 1000);
+		CHECK(isConsistent(tree));
+	}
+
+	//A hint that already holds the value adds a copy in a multiset and nothing in a set
+	{
+		BinaryTree<int> multiset(true);
+		TreeNode<int>* node = multiset.insert(5);
+		CHECK(multiset.insert(node, 5) == node && node->getCount() == 2);
+
+		BinaryTree<int> set;
+		node = set.insert(5);
+		CHECK(set.insert(node, 5) == node && node->getCount() == 1);
+		CHECK(set.size() == 1);
+	}
+
+	//Erasing the last node returns the end, and erasing the only node empties the tree
+	{
+		BinaryTree<int> tree;
+		tree.insert(1);
+		tree.insert(2);
+		CHECK(tree.erase(std::prev(tree.end())) == tree.end());
+		CHECK(tree.erase(tree.begin()) == tree.end());
+		CHECK(tree.isEmpty() && tree.getRoot() == nullptr);
+		CHECK(tree.insert(nullptr, 3) == tree.getRoot());
+	}
+
+	return finishTest("HintedInsertTests");
+}
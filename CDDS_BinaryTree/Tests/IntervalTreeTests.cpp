@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../IntervalTree.h"
+#include "TestHelpers.h"
+
+typedef std::pair<int, int> Ends;
+
+/// <summary>
+/// Returns the ends of every interval found, sorted so they can be compared with the model
+/// </summary>
+static std::vector<Ends> sortedEnds(const std::vector<Interval<int>>& intervals)
+{
+	std::vector<Ends> ends;
+	for (const Interval<int>& interval : intervals)
+		ends.push_back(Ends(interval.low, interval.high));
+	std::sort(ends.begin(), ends.end());
+	return ends;
+}
+
+/// <summary>
+/// Returns every interval in the model that overlaps the range, found by checking each one
+/// </summary>
+static std::vector<Ends> overlapping(const std::set<Ends>& model, int low, int high)
+{
+	std::vector<Ends> ends;
+	for (const Ends& interval : model)
+	{
+		if (!(interval.second < low) && !(high < interval.first))
+			ends.push_back(interval);
+	}
+	return ends;
+}
+
+int main()
+{
+	std::mt19937 random(29);
+
+	//Adds and removes random intervals, some with their ends in reverse, and checks every search against a scan of all intervals
+	for (int round = 0; round < 200; round++)
+	{
+		IntervalTree<int> tree;
+		std::set<Ends> model;
+		int valueRange = 1 + (int)(random() % 300);
+		int maxLength = 1 + (int)(random() % 50);
+
+		for (int step = 0; step < 300; step++)
+		{
+			int low = (int)(random() % valueRange);
+			int high = low + (int)(random() % maxLength);
+			bool isReversed = random() % 4 == 0;
+			if (random() % 3 == 0)
+			{
+				tree.remove(isReversed ? high : low, isReversed ? low : high);
+				model.erase(Ends(low, high));
+			}
+			else
+			{
+				tree.insert(isReversed ? high : low, isReversed ? low : high);
+				model.insert(Ends(low, high));
+			}
+
+			int queryLow = (int)(random() % (valueRange + maxLength)) - 1;
+			int queryHigh = queryLow + (int)(random() % maxLength);
+			std::vector<Interval<int>> results;
+			tree.findOverlapping(queryLow, queryHigh, results);
+			CHECK(sortedEnds(results) == overlapping(model, queryLow, queryHigh));
+
+			//A range given in reverse finds the same intervals
+			results.clear();
+			tree.findOverlapping(queryHigh, queryLow, results);
+			CHECK(sortedEnds(results) == overlapping(model, queryLow, queryHigh));
+
+			results.clear();
+			tree.findContaining(queryLow, results);
+			CHECK(sortedEnds(results) == overlapping(model, queryLow, queryLow));
+		}
+
+		CHECK(tree.size() == model.size());
+		CHECK(isConsistent(tree));
+	}
+
+	//Touching ends overlap, since intervals are closed. A long interval in the left subtree is still found past the end of every other interval
+	{
+		IntervalTree<int> tree;
+		for (int low = 10; low < 20; low++)
+			tree.insert(low, low + 1);
+		tree.insert(0, 100);
+
+		std::vector<Interval<int>> results;
+		tree.findOverlapping(21, 21, results);
+		CHECK(sortedEnds(results) == std::vector<Ends>({ Ends(0, 100) }));
+
+		results.clear();
+		tree.findOverlapping(20, 20, results);
+		CHECK(sortedEnds(results) == std::vector<Ends>({ Ends(0, 100), Ends(19, 20) }));
+
+		results.clear();
+		tree.findOverlapping(101, 200, results);
+		CHECK(results.empty());
+	}
+
+	return finishTest("IntervalTreeTests");
+}
@@ -0,0 +1,140 @@
+#include <random>
+#include <set>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Extracts the value's node, adds some copies back the usual way and then reinserts the node.
+/// An extracted node keeps its copies, which are added onto the existing node when it is reinserted
+/// </summary>
+template<typename Tree>
+static void extractAndReinsert(Tree& tree, std::multiset<int>& model, int value, std::mt19937& random)
+{
+	NodeHandle<int> handle = tree.extract(value);
+	CHECK(handle.isEmpty() == (model.count(value) == 0));
+	if (handle.isEmpty())
+		return;
+
+	unsigned int copyCount = (unsigned int)model.count(value);
+	CHECK(handle.getNode()->getCount() == copyCount);
+	model.erase(value);
+
+	unsigned int addedCount = (unsigned int)(random() % 3);
+	for (unsigned int i = 0; i < addedCount; i++)
+	{
+		tree.insert(value);
+		model.insert(value);
+	}
+
+	tree.insert(handle);
+	CHECK(handle.isEmpty());
+	if constexpr (std::is_same<Tree, SplayTree<int>>::value)
+		CHECK(tree.getRoot()->getData() == value);
+	for (unsigned int i = 0; i < copyCount; i++)
+		model.insert(value);
+}
+
+/// <summary>
+/// Applies random inserts, removes, erases and extractions to a multiset and checks every copy count against std::multiset
+/// </summary>
+template<typename Tree>
+static void testCounts(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		Tree tree(true);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 40);
+
+		for (int step = 0; step < 300; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 8)
+			{
+			case 0:
+			case 1:
+			case 2:
+				tree.insert(value);
+				model.insert(value);
+				break;
+			case 3:
+			case 4:
+				//Removes a single copy
+				tree.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+				break;
+			case 5:
+			{
+				//Erasing a node drops every copy it stands for
+				TreeNode<int>* node = tree.find(value);
+				CHECK((node != nullptr) == (model.count(value) > 0));
+				if (node)
+				{
+					tree.erase(node);
+					model.erase(value);
+				}
+				break;
+			}
+			case 6:
+				extractAndReinsert(tree, model, value, random);
+				break;
+			default:
+				CHECK(tree.count(value) == model.count(value));
+				break;
+			}
+		}
+
+		CHECK(treeValues(tree) == modelValues<int>(model));
+		CHECK(isConsistent(tree));
+		if constexpr (std::is_same<Tree, Treap<int>>::value)
+			CHECK(isHeapOrdered(tree));
+		for (int value = 0; value < valueRange; value++)
+			CHECK(tree.count(value) == model.count(value));
+
+		//Every copy is written out and read back, whether the tree is built directly or inserted into
+		std::stringstream stream;
+		CHECK(tree.saveTo(stream));
+		Tree loaded(true);
+		CHECK(loaded.loadFrom(stream));
+		CHECK(treeValues(loaded) == modelValues<int>(model));
+		CHECK(isConsistent(loaded));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(28);
+	testCounts<BinaryTree<int>>(random);
+	testCounts<SplayTree<int>>(random);
+	testCounts<Treap<int>>(random);
+
+	//Every way of adding or taking out a node in a splay tree leaves the node it used at the root
+	{
+		SplayTree<int> tree(true);
+		for (int value = 0; value < 20; value++)
+			tree.insert(value);
+
+		std::pair<TreeNode<int>*, bool> emplaced = tree.tryEmplace(5, 5);
+		CHECK(!emplaced.second && emplaced.first == tree.getRoot() && emplaced.first->getData() == 5);
+		emplaced = tree.tryEmplace(25, 25);
+		CHECK(emplaced.second && emplaced.first == tree.getRoot() && emplaced.first->getData() == 25);
+
+		NodeHandle<int> handle = tree.extract(tree.find(12));
+		CHECK(!handle.isEmpty() && tree.getRoot()->getData() != 12);
+		CHECK(tree.insert(handle) == tree.getRoot() && tree.getRoot()->getData() == 12);
+
+		//The iterator after the erased node survives the splay
+		BinaryTree<int>::Iterator position = tree.erase(BinaryTree<int>::Iterator(tree.find(7), &tree));
+		CHECK(position != tree.end() && *position == 8);
+		CHECK(tree.count(7) == 0 && tree.size() == 20);
+		CHECK(isConsistent(tree));
+	}
+
+	return finishTest("MultisetTests");
+}
@@ -0,0 +1,127 @@
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Steps from the smallest node to the end with next, and from the largest node to the start with prev,
+/// checking both walks and the nodes at either end against the model's distinct values
+/// </summary>
+template<typename Tree>
+static void checkNeighbours(const Tree& tree, const std::set<int>& values)
+{
+	TreeNode<int>* smallestNode = tree.getRoot();
+	TreeNode<int>* largestNode = tree.getRoot();
+	while (smallestNode && smallestNode->hasLeft())
+		smallestNode = smallestNode->getLeft();
+	while (largestNode && largestNode->hasRight())
+		largestNode = largestNode->getRight();
+	CHECK((smallestNode == nullptr) == values.empty());
+	if (!smallestNode)
+		return;
+
+	CHECK(BinaryTree<int>::prev(smallestNode) == nullptr);
+	CHECK(BinaryTree<int>::next(largestNode) == nullptr);
+
+	std::vector<int> forward;
+	for (TreeNode<int>* node = smallestNode; node; node = BinaryTree<int>::next(node))
+		forward.push_back(node->getData());
+	CHECK(forward == std::vector<int>(values.begin(), values.end()));
+
+	std::vector<int> backward;
+	for (TreeNode<int>* node = largestNode; node; node = BinaryTree<int>::prev(node))
+		backward.push_back(node->getData());
+	CHECK(backward == std::vector<int>(values.rbegin(), values.rend()));
+
+	//The iterators reach the same ends, and stepping back from the end lands on the largest value
+	CHECK(tree.begin().getNode() == smallestNode);
+	typename BinaryTree<int>::Iterator last = tree.end();
+	--last;
+	CHECK(last.getNode() == largestNode);
+	CHECK(std::next(last) == tree.end());
+}
+
+/// <summary>
+/// Makes random changes that move nodes around, checking that the parent links still lead to the right neighbours
+/// </summary>
+template<typename Tree>
+static void testNeighbours(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		Tree tree(isMultiset);
+		std::set<int> values;
+		int valueRange = 1 + (int)(random() % 100);
+
+		for (int step = 0; step < 100; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 4)
+			{
+			case 0:
+			case 1:
+				tree.insert(value);
+				values.insert(value);
+				break;
+			case 2:
+				if (tree.find(value))
+				{
+					tree.erase(tree.find(value));
+					values.erase(value);
+				}
+				break;
+			default:
+			{
+				//Splitting and joining relinks the nodes along a whole path
+				Tree right(isMultiset);
+				tree.split(value, right);
+				checkNeighbours(right, std::set<int>(values.lower_bound(value), values.end()));
+				tree.join(right);
+				break;
+			}
+			}
+		}
+
+		checkNeighbours(tree, values);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(40);
+	testNeighbours<BinaryTree<int>>(random);
+	testNeighbours<SplayTree<int>>(random);
+	testNeighbours<Treap<int>>(random);
+
+	//A single node has no neighbours, and an empty tree's iterators start at the end
+	{
+		BinaryTree<int> tree;
+		CHECK(tree.begin() == tree.end());
+		TreeNode<int>* node = tree.insert(1);
+		CHECK(BinaryTree<int>::next(node) == nullptr && BinaryTree<int>::prev(node) == nullptr);
+		CHECK(std::next(tree.begin()) == tree.end());
+		CHECK(std::prev(tree.end()).getNode() == node);
+	}
+
+	//A node's neighbour can be its parent, grandparent or the far end of a subtree. Walking up stops at the root in both directions
+	{
+		BinaryTree<int> tree;
+		for (int value : { 50, 20, 80, 10, 30, 70, 90, 25, 35, 75 })
+			tree.insert(value);
+
+		CHECK(BinaryTree<int>::next(tree.find(35))->getData() == 50);
+		CHECK(BinaryTree<int>::prev(tree.find(70))->getData() == 50);
+		CHECK(BinaryTree<int>::next(tree.find(50))->getData() == 70);
+		CHECK(BinaryTree<int>::prev(tree.find(50))->getData() == 35);
+		CHECK(BinaryTree<int>::next(tree.find(75))->getData() == 80);
+		CHECK(BinaryTree<int>::prev(tree.find(25))->getData() == 20);
+		CHECK(BinaryTree<int>::next(tree.find(90)) == nullptr);
+		CHECK(BinaryTree<int>::prev(tree.find(10)) == nullptr);
+	}
+
+	return finishTest("NeighbourTests");
+}
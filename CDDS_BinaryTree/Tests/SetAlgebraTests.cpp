@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "TestHelpers.h"
+
+/// <summary>
+/// Fills a tree and its model with random values
+/// </summary>
+static void fillTree(BinaryTree<int>& tree, std::multiset<int>& model, std::mt19937& random, int valueRange)
+{
+	int valueCount = (int)(random() % 60);
+	for (int i = 0; i < valueCount; i++)
+	{
+		int value = (int)(random() % valueRange);
+		tree.insert(value);
+		if (tree.isMultiset() || model.count(value) == 0)
+			model.insert(value);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(38);
+
+	//Combines random sets and multisets with each other and with themselves. The result is checked against the
+	//standard algorithms, and the log is checked to describe exactly the copies that were added and removed
+	for (int round = 0; round < 3000; round++)
+	{
+		int valueRange = 1 + (int)(random() % 50);
+		BinaryTree<int> tree(random() % 2 == 0);
+		BinaryTree<int> other(random() % 2 == 0);
+		std::multiset<int> model;
+		std::multiset<int> otherModel;
+		fillTree(tree, model, random, valueRange);
+		fillTree(other, otherModel, random, valueRange);
+
+		bool isSameTree = random() % 8 == 0;
+		const BinaryTree<int>& operand = isSameTree ? tree : other;
+		const std::multiset<int> operandModel = isSameTree ? model : otherModel;
+
+		ModelLog<int> log(tree);
+		tree.setLog(&log);
+
+		std::vector<int> expected;
+		switch (random() % 3)
+		{
+		case 0:
+			tree.unionWith(operand);
+			if (tree.isMultiset())
+				std::merge(model.begin(), model.end(), operandModel.begin(), operandModel.end(), std::back_inserter(expected));
+			else
+			{
+				std::set<int> values(model.begin(), model.end());
+				values.insert(operandModel.begin(), operandModel.end());
+				expected.assign(values.begin(), values.end());
+			}
+			break;
+		case 1:
+			tree.intersect(operand);
+			std::set_intersection(model.begin(), model.end(), operandModel.begin(), operandModel.end(), std::back_inserter(expected));
+			break;
+		default:
+			tree.difference(operand);
+			std::set_difference(model.begin(), model.end(), operandModel.begin(), operandModel.end(), std::back_inserter(expected));
+			break;
+		}
+		tree.setLog(nullptr);
+
+		CHECK(treeValues(tree) == expected);
+		CHECK(isConsistent(tree));
+		CHECK(log.isValid() && log.getValues() == expected);
+		if (!isSameTree)
+			CHECK(treeValues(other) == modelValues<int>(otherModel));
+
+		//The relinked tree still takes new largest values and inserts from a hint
+		TreeNode<int>* hint = tree.insert(valueRange);
+		tree.insert(hint, valueRange + 1);
+		expected.push_back(valueRange);
+		expected.push_back(valueRange + 1);
+		CHECK(treeValues(tree) == expected);
+	}
+
+	return finishTest("SetAlgebraTests");
+}
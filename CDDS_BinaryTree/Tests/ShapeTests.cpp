@@ -0,0 +1,150 @@
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Returns the number of nodes at each depth, counted by walking the whole tree
+/// </summary>
+template<typename T>
+static std::vector<double> countDepths(const BinaryTree<T>& tree)
+{
+	std::vector<double> nodesAtDepth;
+	TreeTraversal<T>::preOrder(tree.getRoot(), [&](TreeNode<T>*, size_t depth)
+	{
+		if (depth >= nodesAtDepth.size())
+			nodesAtDepth.resize(depth + 1, 0.0);
+		nodesAtDepth[depth]++;
+	});
+	return nodesAtDepth;
+}
+
+/// <summary>
+/// Removes values every way a tree can, with leaves, inner nodes and the root all taken out, and checks the size
+/// and height the tree keeps against a walk after every change
+/// </summary>
+template<typename Tree>
+static void testRemoveShape(std::mt19937& random)
+{
+	for (int round = 0; round < 200; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		Tree tree(isMultiset);
+		std::set<int> values;
+		int valueRange = 1 + (int)(random() % 300);
+
+		for (int step = 0; step < 400; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 6)
+			{
+			case 0:
+			case 1:
+				tree.insert(value);
+				values.insert(value);
+				break;
+			case 2:
+				//Removing one copy of many keeps the node
+				tree.remove(value);
+				if (tree.find(value) == nullptr)
+					values.erase(value);
+				break;
+			case 3:
+				tree.erase(tree.find(value));
+				values.erase(value);
+				break;
+			case 4:
+				tree.extract(value);
+				values.erase(value);
+				break;
+			default:
+				//The root and the leaves are where a kept height is most likely to go wrong
+				if (tree.getRoot())
+				{
+					TreeNode<int>* node = tree.getRoot();
+					if (random() % 2 == 0)
+					{
+						while (node->hasLeft() || node->hasRight())
+							node = node->hasLeft() && (!node->hasRight() || random() % 2 == 0) ? node->getLeft() : node->getRight();
+					}
+					values.erase(node->getData());
+					tree.erase(node);
+				}
+				break;
+			}
+
+			CHECK(tree.size() == values.size());
+			CHECK(tree.height() == countDepths(tree).size());
+		}
+
+		CHECK(isConsistent(tree));
+		CHECK(tree.depthHistogram(values.size()) == countDepths(tree));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(45);
+	testRemoveShape<BinaryTree<int>>(random);
+	testRemoveShape<SplayTree<int>>(random);
+	testRemoveShape<Treap<int>>(random);
+
+	//Taking out the only deepest leaf lowers the height, while a shallower leaf or a node with a leaf below it doesn't
+	{
+		BinaryTree<int> tree;
+		for (int value : { 50, 30, 70, 20, 40, 80, 10 })
+			tree.insert(value);
+		CHECK(tree.height() == 4 && tree.size() == 7);
+		tree.remove(40);
+		CHECK(tree.height() == 4 && tree.size() == 6);
+		tree.remove(70);
+		CHECK(tree.height() == 4 && tree.size() == 5);
+		tree.remove(10);
+		CHECK(tree.height() == 3 && tree.size() == 4);
+		tree.remove(50);
+		CHECK(tree.height() == 3 && tree.size() == 3);
+		CHECK(isConsistent(tree));
+		tree.remove(20);
+		tree.remove(30);
+		tree.remove(80);
+		CHECK(tree.height() == 0 && tree.size() == 0 && tree.depthHistogram().empty());
+	}
+
+	//Every path through a perfect tree or a chain stands for the same number of nodes, so sampling gives the exact counts
+	{
+		BinaryTree<int> perfect;
+		std::vector<int> values;
+		for (int value = 0; value < 4095; value++)
+			values.push_back(value);
+		perfect.bulkLoad(values);
+		std::vector<double> expected;
+		for (int depth = 0; depth < 12; depth++)
+			expected.push_back(std::pow(2.0, depth));
+		CHECK(perfect.depthHistogram(64, 7) == expected);
+
+		BinaryTree<int> chain;
+		TreeNode<int>* lastNode = nullptr;
+		for (int value = 0; value < 1000; value++)
+			lastNode = chain.insert(lastNode, value);
+		CHECK(chain.depthHistogram(16) == std::vector<double>(1000, 1.0));
+	}
+
+	//In a random tree the estimate is close to the real counts at the shallow levels most paths pass through.
+	//Deep levels are left out, since few paths reach them. Sampling at least as many paths as there are nodes counts them exactly
+	{
+		BinaryTree<int> tree;
+		for (int i = 0; i < 100000; i++)
+			tree.insert((int)random());
+		std::vector<double> exact = countDepths(tree);
+		std::vector<double> estimate = tree.depthHistogram(20000, 3);
+		CHECK(estimate.size() <= exact.size());
+		for (size_t depth = 0; depth < 8 && depth < estimate.size(); depth++)
+			CHECK(std::fabs(estimate[depth] - exact[depth]) < 0.1 * exact[depth]);
+		CHECK(tree.depthHistogram(tree.size()) == exact);
+	}
+
+	return finishTest("ShapeTests");
+}
@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <vector>
+#include "../TreeSnapshot.h"
+#include "TestHelpers.h"
+
+static const char* SNAPSHOT_PATH = "snapshot_test.snapshot";
+
+/// <summary>
+/// Walks the snapshot's nodes in order through their links, returning every copy of every value
+/// </summary>
+static std::vector<int> snapshotValues(const TreeSnapshot<int>& snapshot)
+{
+	std::vector<int> values;
+	std::vector<uint32_t> pendingIndices;
+	uint32_t currentIndex = snapshot.getNodeCount() > 0 ? 0 : TreeSnapshot<int>::NO_NODE;
+	while (currentIndex != TreeSnapshot<int>::NO_NODE || !pendingIndices.empty())
+	{
+		while (currentIndex != TreeSnapshot<int>::NO_NODE)
+		{
+			pendingIndices.push_back(currentIndex);
+			currentIndex = snapshot.getNode(currentIndex)->left;
+		}
+
+		const SnapshotNode<int>* node = snapshot.getNode(pendingIndices.back());
+		pendingIndices.pop_back();
+		for (uint32_t i = 0; i < node->count; i++)
+			values.push_back(node->value);
+		currentIndex = node->right;
+	}
+	return values;
+}
+
+int main()
+{
+	std::mt19937 random(31);
+
+	//Saves random trees of every shape, from balanced to a single long path, and searches the mapped file
+	for (int round = 0; round < 300; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		BinaryTree<int> tree(isMultiset);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 500);
+		int valueCount = (int)(random() % 400);
+		bool isSorted = random() % 4 == 0;
+		for (int i = 0; i < valueCount; i++)
+		{
+			int value = isSorted ? i : (int)(random() % valueRange);
+			tree.insert(value);
+			if (isMultiset || model.count(value) == 0)
+				model.insert(value);
+		}
+
+		uint64_t logPosition = random();
+		CHECK(TreeSnapshot<int>::save(tree, SNAPSHOT_PATH, logPosition));
+
+		TreeSnapshot<int> snapshot;
+		CHECK(snapshot.open(SNAPSHOT_PATH));
+		CHECK(snapshot.isOpen());
+		CHECK(snapshot.verify());
+		CHECK(snapshot.getNodeCount() == tree.size());
+		CHECK(snapshot.getLogPosition() == logPosition);
+		CHECK(snapshotValues(snapshot) == modelValues<int>(model));
+		CHECK(snapshot.getNode((uint32_t)snapshot.getNodeCount()) == nullptr);
+
+		int largestValue = isSorted ? valueCount : valueRange;
+		for (int value = -1; value <= largestValue; value++)
+		{
+			CHECK(snapshot.count(value) == model.count(value));
+			const SnapshotNode<int>* node = snapshot.find(value);
+			CHECK((node != nullptr) == (model.count(value) > 0));
+			if (node)
+				CHECK(node->value == value);
+		}
+	}
+
+	//Overwrites random links. Any damage verify misses must still leave every search finishing inside the file
+	for (int round = 0; round < 300; round++)
+	{
+		BinaryTree<int> tree;
+		int valueCount = 2 + (int)(random() % 100);
+		for (int i = 0; i < valueCount; i++)
+			tree.insert((int)(random() % 1000));
+		CHECK(TreeSnapshot<int>::save(tree, SNAPSHOT_PATH));
+
+		uint32_t nodeCount = (uint32_t)tree.size();
+		uint32_t nodeIndex = (uint32_t)(random() % nodeCount);
+		size_t linkOffset = random() % 2 == 0 ? offsetof(SnapshotNode<int>, left) : offsetof(SnapshotNode<int>, right);
+		long fileOffset = (long)(sizeof(SnapshotHeader) + nodeIndex * sizeof(SnapshotNode<int>) + linkOffset);
+
+		FILE* file = std::fopen(SNAPSHOT_PATH, "r+b");
+		uint32_t oldLink = 0;
+		std::fseek(file, fileOffset, SEEK_SET);
+		CHECK(std::fread(&oldLink, sizeof(oldLink), 1, file) == 1);
+		uint32_t newLinks[] = { 0, nodeIndex, (uint32_t)(random() % nodeCount), nodeCount + (uint32_t)(random() % 10), TreeSnapshot<int>::NO_NODE - 1 };
+		uint32_t newLink = newLinks[random() % 5];
+		std::fseek(file, fileOffset, SEEK_SET);
+		std::fwrite(&newLink, sizeof(newLink), 1, file);
+		std::fclose(file);
+
+		TreeSnapshot<int> snapshot;
+		CHECK(snapshot.open(SNAPSHOT_PATH));
+		if (newLink != oldLink)
+			CHECK(!snapshot.verify());
+		for (int value = 0; value < 1000; value++)
+			snapshot.find(value);
+	}
+
+	//A file too short for its own header, or for the nodes the header promises, isn't opened
+	{
+		BinaryTree<int> tree;
+		for (int value : { 2, 1, 3 })
+			tree.insert(value);
+		CHECK(TreeSnapshot<int>::save(tree, SNAPSHOT_PATH));
+		std::filesystem::resize_file(SNAPSHOT_PATH, sizeof(SnapshotHeader) + sizeof(SnapshotNode<int>));
+		TreeSnapshot<int> snapshot;
+		CHECK(!snapshot.open(SNAPSHOT_PATH));
+		std::filesystem::resize_file(SNAPSHOT_PATH, 10);
+		CHECK(!snapshot.open(SNAPSHOT_PATH));
+	}
+
+	std::remove(SNAPSHOT_PATH);
+	return finishTest("SnapshotTests");
+}
@@ -0,0 +1,134 @@
+#include <iterator>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Splits random trees at random keys, changes both halves and joins them back, checking every step against std::multiset.
+/// Inserting past the end of a half after a split uses the largest node the half took over, so a stale one shows up here
+/// </summary>
+template<typename Tree>
+static void testSplitJoin(std::mt19937& random, bool isMultiset)
+{
+	for (int round = 0; round < 500; round++)
+	{
+		Tree tree(isMultiset);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 200);
+		int valueCount = (int)(random() % 150);
+		for (int i = 0; i < valueCount; i++)
+		{
+			int value = (int)(random() % valueRange);
+			tree.insert(value);
+			if (isMultiset || model.count(value) == 0)
+				model.insert(value);
+		}
+
+		//Splits anywhere from below the smallest value to above the largest
+		int key = (int)(random() % (valueRange + 2)) - 1;
+		Tree right(isMultiset);
+		tree.split(key, right);
+
+		std::multiset<int> leftModel(model.begin(), model.lower_bound(key));
+		std::multiset<int> rightModel(model.lower_bound(key), model.end());
+		CHECK(treeValues(tree) == modelValues<int>(leftModel));
+		CHECK(treeValues(right) == modelValues<int>(rightModel));
+		CHECK(isConsistent(tree) && isConsistent(right));
+
+		//Each half is changed on its own, including new largest values, before the halves are joined back
+		for (int i = 0; i < 20; i++)
+		{
+			int value = (int)(random() % (valueRange + 20));
+			if (value < key)
+			{
+				if (random() % 3 == 0)
+				{
+					tree.remove(value);
+					if (leftModel.count(value) > 0)
+						leftModel.erase(leftModel.find(value));
+				}
+				else
+				{
+					tree.insert(value);
+					if (isMultiset || leftModel.count(value) == 0)
+						leftModel.insert(value);
+				}
+			}
+			else
+			{
+				if (random() % 3 == 0)
+				{
+					right.remove(value);
+					if (rightModel.count(value) > 0)
+						rightModel.erase(rightModel.find(value));
+				}
+				else
+				{
+					right.insert(value);
+					if (isMultiset || rightModel.count(value) == 0)
+						rightModel.insert(value);
+				}
+			}
+		}
+
+		//The plain tree can also be given a hint, which starts from the largest node when it is past the end
+		if constexpr (std::is_same<Tree, BinaryTree<int>>::value)
+		{
+			TreeNode<int>* hint = nullptr;
+			for (int value = valueRange + 20; value < valueRange + 25; value++)
+			{
+				hint = right.insert(hint, value);
+				rightModel.insert(value);
+			}
+		}
+
+		CHECK(treeValues(tree) == modelValues<int>(leftModel));
+		CHECK(treeValues(right) == modelValues<int>(rightModel));
+
+		CHECK(tree.join(right));
+		leftModel.insert(rightModel.begin(), rightModel.end());
+		CHECK(right.isEmpty());
+		CHECK(treeValues(tree) == modelValues<int>(leftModel));
+		CHECK(isConsistent(tree));
+		if constexpr (std::is_same<Tree, Treap<int>>::value)
+			CHECK(isHeapOrdered(tree));
+
+		//Joining a tree whose values overlap, or that counts duplicates differently, is refused and leaves both trees as they were
+		if (!leftModel.empty())
+		{
+			Tree overlapping(isMultiset);
+			overlapping.insert(*leftModel.begin());
+			CHECK(!tree.join(overlapping));
+			CHECK(overlapping.size() == 1);
+
+			Tree otherKind(!isMultiset);
+			otherKind.insert(*leftModel.rbegin() + 1);
+			CHECK(!tree.join(otherKind));
+			CHECK(otherKind.size() == 1);
+			CHECK(!tree.join(tree));
+			CHECK(treeValues(tree) == modelValues<int>(leftModel));
+		}
+
+		//A value larger than everything goes after the joined tree's largest node
+		tree.insert(1000000);
+		leftModel.insert(1000000);
+		CHECK(treeValues(tree) == modelValues<int>(leftModel));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(26);
+	for (bool isMultiset : { false, true })
+	{
+		testSplitJoin<BinaryTree<int>>(random, isMultiset);
+		testSplitJoin<SplayTree<int>>(random, isMultiset);
+		testSplitJoin<Treap<int>>(random, isMultiset);
+	}
+
+	return finishTest("SplitJoinTests");
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+#include "../BinaryTree.h"
+#include "../TreeLog.h"
+#include "../TreeNode.h"
+#include "../TreeTraversal.h"
+
+//The tests are built in release like everything else, where assert does nothing, so they check with this instead.
+//A failed check is reported and the test carries on, so one run shows every difference it finds
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			failedCheckCount()++; \
+		} \
+	} while (false)
+
+/// <summary>
+/// Returns the number of checks that have failed so far
+/// </summary>
+inline int& failedCheckCount()
+{
+	static int count = 0;
+	return count;
+}
+
+/// <summary>
+/// Returns what the test's main should return, and says how many checks failed
+/// </summary>
+inline int finishTest(const char* name)
+{
+	if (failedCheckCount() > 0)
+		std::fprintf(stderr, "%s: %d checks failed\n", name, failedCheckCount());
+	return failedCheckCount() > 0 ? 1 : 0;
+}
+
+/// <summary>
+/// Returns every copy of every value in the tree from smallest to largest
+/// </summary>
+template<typename T>
+inline std::vector<T> treeValues(const BinaryTree<T>& tree)
+{
+	std::vector<T> values;
+	TreeTraversal<T>::inOrder(tree.getRoot(), [&](TreeNode<T>* node, size_t)
+	{
+		for (unsigned int i = 0; i < node->getCount(); i++)
+			values.push_back(node->getData());
+	});
+	return values;
+}
+
+/// <summary>
+/// Returns the values of the model the tree is checked against, in the same form as treeValues
+/// </summary>
+template<typename T, typename Set>
+inline std::vector<T> modelValues(const Set& model)
+{
+	return std::vector<T>(model.begin(), model.end());
+}
+
+/// <summary>
+/// Checks that the values are in order, every child links back to its parent, and the size and height the tree keeps are right
+/// </summary>
+template<typename T>
+inline bool isConsistent(const BinaryTree<T>& tree)
+{
+	bool isValid = !tree.getRoot() || !tree.getRoot()->getParent();
+	size_t nodeCount = 0;
+	size_t height = 0;
+	TreeNode<T>* previousNode = nullptr;
+	TreeTraversal<T>::inOrder(tree.getRoot(), [&](TreeNode<T>* node, size_t depth)
+	{
+		if (previousNode && !(previousNode->getData() < node->getData()))
+			isValid = false;
+		if ((node->hasLeft() && node->getLeft()->getParent() != node) || (node->hasRight() && node->getRight()->getParent() != node))
+			isValid = false;
+		if (node->getCount() == 0)
+			isValid = false;
+
+		previousNode = node;
+		nodeCount++;
+		height = std::max(height, depth + 1);
+	});
+
+	return isValid && tree.size() == nodeCount && tree.height() == height;
+}
+
+/// <summary>
+/// Checks that every parent has a priority at least as high as its children
+/// </summary>
+template<typename T>
+inline bool isHeapOrdered(const BinaryTree<T>& tree)
+{
+	bool isValid = true;
+	TreeTraversal<T>::preOrder(tree.getRoot(), [&](TreeNode<T>* node, size_t)
+	{
+		if ((node->hasLeft() && node->getLeft()->getPriority() > node->getPriority()) ||
+			(node->hasRight() && node->getRight()->getPriority() > node->getPriority()))
+			isValid = false;
+	});
+	return isValid;
+}
+
+/// <summary>
+/// A log that applies every change it is told about to a std::multiset, so it can be compared with the tree afterwards
+/// </summary>
+template<typename T>
+class ModelLog : public TreeLog<T>
+{
+public:
+	/// <summary>
+	/// Starts from the values already in the tree
+	/// </summary>
+	explicit ModelLog(const BinaryTree<T>& tree)
+	{
+		std::vector<T> values = treeValues(tree);
+		m_values.insert(values.begin(), values.end());
+	}
+
+	void logInsert(const T& value) override { m_values.insert(value); }
+	void logRemove(const T& value) override
+	{
+		//Removing a copy that isn't there means the log and the tree disagree
+		typename std::multiset<T>::iterator position = m_values.find(value);
+		if (position == m_values.end())
+			m_isValid = false;
+		else
+			m_values.erase(position);
+	}
+
+	/// <summary>
+	/// Returns whether or not the log only ever removed copies it had been given
+	/// </summary>
+	bool isValid() const { return m_isValid; }
+	/// <summary>
+	/// Returns every value the log says the tree holds
+	/// </summary>
+	std::vector<T> getValues() const { return std::vector<T>(m_values.begin(), m_values.end()); }
+
+private:
+	std::multiset<T> m_values;
+	bool m_isValid = true;
+};
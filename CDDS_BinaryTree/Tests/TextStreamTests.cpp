@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// A tree that keeps the number of nodes under every node, so a load that forgets to refresh a subtree shows up
+/// </summary>
+class CountingTree : public BinaryTree<int>
+{
+public:
+	explicit CountingTree(bool isMultiset) : BinaryTree<int>(isMultiset)
+	{
+		m_isAugmented = true;
+	}
+
+	/// <summary>
+	/// Returns whether or not the count kept for every node matches its subtree
+	/// </summary>
+	bool hasFreshCounts() const
+	{
+		bool isFresh = true;
+		TreeTraversal<int>::postOrder(getRoot(), [&](TreeNode<int>* node, size_t)
+		{
+			std::unordered_map<const TreeNode<int>*, size_t>::const_iterator position = m_subtreeSizes.find(node);
+			if (position == m_subtreeSizes.end() || position->second != 1 + subtreeSize(node->getLeft()) + subtreeSize(node->getRight()))
+				isFresh = false;
+		});
+		return isFresh;
+	}
+
+protected:
+	void updateNode(TreeNode<int>* node) override
+	{
+		m_subtreeSizes[node] = 1 + subtreeSize(node->getLeft()) + subtreeSize(node->getRight());
+	}
+
+private:
+	size_t subtreeSize(const TreeNode<int>* node) const
+	{
+		std::unordered_map<const TreeNode<int>*, size_t>::const_iterator position = m_subtreeSizes.find(node);
+		return node && position != m_subtreeSizes.end() ? position->second : 0;
+	}
+
+	std::unordered_map<const TreeNode<int>*, size_t> m_subtreeSizes;
+};
+
+/// <summary>
+/// Returns the smallest height a tree with this many nodes can have
+/// </summary>
+static size_t balancedHeight(size_t nodeCount)
+{
+	size_t height = 0;
+	for (; nodeCount > 0; nodeCount >>= 1)
+		height++;
+	return height;
+}
+
+/// <summary>
+/// Writes the values one per line, with the line endings and blank lines a hand-edited file might have
+/// </summary>
+static std::string writeLines(const std::vector<int>& values, std::mt19937& random)
+{
+	std::string text;
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		if (random() % 20 == 0)
+			text += random() % 2 == 0 ? "\n" : "\r\n";
+		text += std::to_string(values[i]);
+		if (i + 1 < values.size() || random() % 2 == 0)
+			text += random() % 4 == 0 ? "\r\n" : "\n";
+	}
+	return text;
+}
+
+/// <summary>
+/// Loads random files that are sorted, reversed, shuffled or sorted with a few values out of place,
+/// and checks the tree, its log and what it saves against the values that were written
+/// </summary>
+template<typename Tree>
+static void testLoad(std::mt19937& random)
+{
+	for (int round = 0; round < 300; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		int valueRange = 1 + (int)(random() % 2000);
+		std::vector<int> values((size_t)(random() % 1000));
+		for (int& value : values)
+			value = (int)(random() % valueRange) - valueRange / 2;
+
+		int order = (int)(random() % 4);
+		if (order == 0)
+			std::sort(values.begin(), values.end());
+		else if (order == 1)
+			std::sort(values.rbegin(), values.rend());
+		else if (order == 2 && !values.empty())
+		{
+			std::sort(values.begin(), values.end());
+			values[random() % values.size()] = (int)(random() % valueRange);
+		}
+
+		std::multiset<int> model;
+		for (int value : values)
+		{
+			if (isMultiset || model.count(value) == 0)
+				model.insert(value);
+		}
+
+		Tree tree(isMultiset);
+		ModelLog<int> log(tree);
+		tree.setLog(&log);
+		std::istringstream stream(writeLines(values, random));
+		CHECK(tree.loadFrom(stream));
+		tree.setLog(nullptr);
+
+		CHECK(treeValues(tree) == modelValues<int>(model));
+		CHECK(isConsistent(tree));
+		CHECK(log.isValid() && log.getValues() == modelValues<int>(model));
+		if constexpr (std::is_same<Tree, Treap<int>>::value)
+			CHECK(isHeapOrdered(tree));
+		if constexpr (std::is_same<Tree, CountingTree>::value)
+			CHECK(tree.hasFreshCounts());
+
+		//Sorted values are chained and rebalanced, so the plain trees come out as short as possible
+		if (order == 0 && !std::is_same<Tree, Treap<int>>::value)
+			CHECK(tree.height() == balancedHeight(tree.size()));
+
+		//Saving and loading again gives the same values
+		std::stringstream savedStream;
+		CHECK(tree.saveTo(savedStream));
+		Tree loaded(isMultiset);
+		CHECK(loaded.loadFrom(savedStream));
+		CHECK(treeValues(loaded) == treeValues(tree));
+		CHECK(isConsistent(loaded));
+
+		//Values loaded into a tree that already has nodes are inserted among them
+		std::istringstream moreStream(writeLines(values, random));
+		CHECK(loaded.loadFrom(moreStream));
+		std::multiset<int> doubledModel = model;
+		if (isMultiset)
+			doubledModel.insert(values.begin(), values.end());
+		CHECK(treeValues(loaded) == modelValues<int>(doubledModel));
+		CHECK(isConsistent(loaded));
+	}
+}
+
+int main()
+{
+	std::mt19937 random(32);
+	testLoad<BinaryTree<int>>(random);
+	testLoad<CountingTree>(random);
+	testLoad<Treap<int>>(random);
+
+	//A file much larger than one block, so lines are split across blocks
+	{
+		std::vector<int> values;
+		for (int i = 0; i < 200000; i++)
+			values.push_back(i * 3 - 100000);
+		std::string text = writeLines(values, random);
+		CHECK(text.size() > 4 * (1 << 16));
+
+		BinaryTree<int> tree;
+		std::istringstream stream(text);
+		CHECK(tree.loadFrom(stream));
+		CHECK(treeValues(tree) == values);
+		CHECK(tree.height() == balancedHeight(values.size()));
+		CHECK(isConsistent(tree));
+	}
+
+	//A line that isn't a value fails the load, but the values around it are still added
+	{
+		BinaryTree<int> tree;
+		std::istringstream stream("1\n2\nthree\n4\n\n5");
+		CHECK(!tree.loadFrom(stream));
+		CHECK(treeValues(tree) == std::vector<int>({ 1, 2, 4, 5 }));
+
+		std::istringstream badEnd("6\n7x");
+		CHECK(!tree.loadFrom(badEnd));
+		CHECK(treeValues(tree) == std::vector<int>({ 1, 2, 4, 5, 6 }));
+	}
+
+	//Values that aren't integers are read a whole line at a time
+	{
+		BinaryTree<std::string> tree;
+		std::istringstream stream("pear\r\napple\nfig tree\n");
+		CHECK(tree.loadFrom(stream));
+		CHECK(treeValues(tree) == std::vector<std::string>({ "apple", "fig tree", "pear" }));
+
+		std::stringstream savedStream;
+		CHECK(tree.saveTo(savedStream));
+		CHECK(savedStream.str() == "apple\nfig tree\npear\n");
+	}
+
+	return finishTest("TextStreamTests");
+}
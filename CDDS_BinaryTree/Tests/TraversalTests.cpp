@@ -0,0 +1,147 @@
+#include <cstddef>
+#include <random>
+#include <utility>
+#include <vector>
+#include "TestHelpers.h"
+
+/// <summary>
+/// The order a walk visits nodes in
+/// </summary>
+enum class WalkOrder
+{
+	Pre,
+	In,
+	Post,
+	Level
+};
+
+/// <summary>
+/// Walks the subtree without recursion and returns each value visited with its depth
+/// </summary>
+static std::vector<std::pair<int, size_t>> walk(TreeNode<int>* root, WalkOrder order)
+{
+	std::vector<std::pair<int, size_t>> visits;
+	auto visitor = [&](TreeNode<int>* node, size_t depth)
+	{
+		visits.push_back(std::pair<int, size_t>(node->getData(), depth));
+	};
+
+	switch (order)
+	{
+	case WalkOrder::Pre:
+		TreeTraversal<int>::preOrder(root, visitor);
+		break;
+	case WalkOrder::In:
+		TreeTraversal<int>::inOrder(root, visitor);
+		break;
+	case WalkOrder::Post:
+		TreeTraversal<int>::postOrder(root, visitor);
+		break;
+	default:
+		TreeTraversal<int>::levelOrder(root, visitor);
+		break;
+	}
+	return visits;
+}
+
+/// <summary>
+/// Returns what a walk of the subtree should visit, found by recursing, which is only safe for shallow trees
+/// </summary>
+static void recurse(TreeNode<int>* node, size_t depth, WalkOrder order, std::vector<std::pair<int, size_t>>& visits)
+{
+	if (!node)
+		return;
+	if (order == WalkOrder::Pre)
+		visits.push_back(std::pair<int, size_t>(node->getData(), depth));
+	recurse(node->getLeft(), depth + 1, order, visits);
+	if (order == WalkOrder::In)
+		visits.push_back(std::pair<int, size_t>(node->getData(), depth));
+	recurse(node->getRight(), depth + 1, order, visits);
+	if (order == WalkOrder::Post)
+		visits.push_back(std::pair<int, size_t>(node->getData(), depth));
+}
+
+/// <summary>
+/// Returns what a level order walk should visit, found by gathering every level by depth
+/// </summary>
+static std::vector<std::pair<int, size_t>> levels(TreeNode<int>* root)
+{
+	std::vector<std::pair<int, size_t>> preOrderVisits;
+	recurse(root, 0, WalkOrder::Pre, preOrderVisits);
+
+	//A pre-order walk visits each level from left to right, so gathering its visits one depth at a time gives the level order
+	std::vector<std::pair<int, size_t>> visits;
+	for (size_t depth = 0; visits.size() < preOrderVisits.size(); depth++)
+	{
+		for (const std::pair<int, size_t>& visit : preOrderVisits)
+		{
+			if (visit.second == depth)
+				visits.push_back(visit);
+		}
+	}
+	return visits;
+}
+
+int main()
+{
+	std::mt19937 random(39);
+
+	//Every walk of a random tree visits the same nodes at the same depths in the same order recursion would
+	for (int round = 0; round < 300; round++)
+	{
+		BinaryTree<int> tree;
+		int valueCount = (int)(random() % 200);
+		for (int i = 0; i < valueCount; i++)
+			tree.insert((int)(random() % 1000));
+
+		for (WalkOrder order : { WalkOrder::Pre, WalkOrder::In, WalkOrder::Post })
+		{
+			std::vector<std::pair<int, size_t>> expected;
+			recurse(tree.getRoot(), 0, order, expected);
+			CHECK(walk(tree.getRoot(), order) == expected);
+		}
+		CHECK(walk(tree.getRoot(), WalkOrder::Level) == levels(tree.getRoot()));
+
+		//A walk can start from any subtree, counting depth from there
+		if (tree.getRoot() && tree.getRoot()->hasRight())
+		{
+			std::vector<std::pair<int, size_t>> expected;
+			recurse(tree.getRoot()->getRight(), 0, WalkOrder::Post, expected);
+			CHECK(walk(tree.getRoot()->getRight(), WalkOrder::Post) == expected);
+		}
+	}
+
+	//A tree that has degenerated into a list a million nodes long is walked, measured and deleted without running out of stack.
+	//Adding values in order with the last node as the hint keeps building it cheap
+	{
+		const size_t chainLength = 1000000;
+		BinaryTree<int> tree;
+		TreeNode<int>* lastNode = nullptr;
+		for (size_t i = 0; i < chainLength; i++)
+			lastNode = tree.insert(lastNode, (int)i);
+		CHECK(tree.size() == chainLength);
+		CHECK(tree.height() == chainLength);
+
+		for (WalkOrder order : { WalkOrder::Pre, WalkOrder::In, WalkOrder::Post, WalkOrder::Level })
+		{
+			std::vector<std::pair<int, size_t>> visits = walk(tree.getRoot(), order);
+			bool isRightOrder = visits.size() == chainLength;
+			for (size_t i = 0; isRightOrder && i < chainLength; i++)
+			{
+				//Every node is the right child of the one before it, so only post-order visits them backwards
+				size_t position = order == WalkOrder::Post ? chainLength - 1 - i : i;
+				isRightOrder = visits[i].first == (int)position && visits[i].second == position;
+			}
+			CHECK(isRightOrder);
+		}
+		CHECK(isConsistent(tree));
+
+		//Copying and clearing the chain walk it too
+		BinaryTree<int> copy = tree.clone();
+		CHECK(copy.size() == chainLength && copy.height() == chainLength);
+		tree.clear();
+		CHECK(tree.isEmpty());
+	}
+
+	return finishTest("TraversalTests");
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "../Treap.h"
+#include "TestHelpers.h"
+
+/// <summary>
+/// Checks the treap against its model, including the heap order of its priorities
+/// </summary>
+static void checkTreap(const Treap<int>& treap, const std::multiset<int>& model)
+{
+	CHECK(treeValues(treap) == modelValues<int>(model));
+	CHECK(isConsistent(treap));
+	CHECK(isHeapOrdered(treap));
+}
+
+/// <summary>
+/// Runs random single value changes, in-place builds, splits, joins and bulk loads against std::multiset
+/// </summary>
+static void testOperations(std::mt19937& random)
+{
+	for (int round = 0; round < 300; round++)
+	{
+		bool isMultiset = random() % 2 == 0;
+		Treap<int> treap(isMultiset);
+		std::multiset<int> model;
+		int valueRange = 1 + (int)(random() % 100);
+
+		for (int step = 0; step < 200; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 8)
+			{
+			case 0:
+			case 1:
+				treap.insert(value);
+				if (isMultiset || model.count(value) == 0)
+					model.insert(value);
+				break;
+			case 2:
+				treap.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+				break;
+			case 3:
+			{
+				TreeNode<int>* node = treap.find(value);
+				if (node)
+				{
+					treap.erase(node);
+					model.erase(value);
+				}
+				break;
+			}
+			case 4:
+			{
+				//The node moves to a new place by a new priority
+				NodeHandle<int> handle = treap.extract(value);
+				if (!handle.isEmpty())
+				{
+					treap.insert(handle);
+					CHECK(handle.isEmpty());
+				}
+				break;
+			}
+			case 5:
+			{
+				//Splits, takes the largest values out of the left half and joins the halves back
+				Treap<int> right(isMultiset);
+				treap.split(value, right);
+				while (!treap.isEmpty() && random() % 2 == 0)
+				{
+					TreeNode<int>* largestNode = treap.getRoot();
+					while (largestNode->hasRight())
+						largestNode = largestNode->getRight();
+					model.erase(largestNode->getData());
+					treap.erase(largestNode);
+				}
+				CHECK(treap.join(right));
+				CHECK(right.isEmpty());
+				break;
+			}
+			case 6:
+			{
+				//A value built in place gets a priority like any other, and an existing one is never counted again
+				std::pair<TreeNode<int>*, bool> emplaced = treap.tryEmplace(value, value);
+				CHECK(emplaced.first && emplaced.first->getData() == value);
+				CHECK(emplaced.second == (model.count(value) == 0));
+				if (emplaced.second)
+					model.insert(value);
+				CHECK(isHeapOrdered(treap));
+				break;
+			}
+			default:
+			{
+				//Values larger than everything follow the largest node, whether inserted or bulk loaded into a tree with nodes
+				int largeValue = valueRange + (int)(random() % 10);
+				treap.bulkLoad({ largeValue, largeValue + 1 });
+				for (int added : { largeValue, largeValue + 1 })
+				{
+					if (isMultiset || model.count(added) == 0)
+						model.insert(added);
+				}
+				break;
+			}
+			}
+		}
+
+		checkTreap(treap, model);
+	}
+}
+
+/// <summary>
+/// Combines random treaps and checks the result, both logs and the heap order against the standard algorithms
+/// </summary>
+static void testSetOperations(std::mt19937& random)
+{
+	for (int round = 0; round < 3000; round++)
+	{
+		int valueRange = 1 + (int)(random() % 50);
+		Treap<int> treap(random() % 2 == 0);
+		Treap<int> other(random() % 2 == 0);
+		std::multiset<int> model;
+		std::multiset<int> otherModel;
+		for (Treap<int>* tree : { &treap, &other })
+		{
+			std::multiset<int>& treeModel = tree == &treap ? model : otherModel;
+			int valueCount = (int)(random() % 60);
+			for (int i = 0; i < valueCount; i++)
+			{
+				int value = (int)(random() % valueRange);
+				tree->insert(value);
+				if (tree->isMultiset() || treeModel.count(value) == 0)
+					treeModel.insert(value);
+			}
+		}
+
+		ModelLog<int> log(treap);
+		ModelLog<int> otherLog(other);
+		treap.setLog(&log);
+		other.setLog(&otherLog);
+
+		std::vector<int> expected;
+		switch (random() % 4)
+		{
+		case 0:
+			treap.unionWith(other);
+			if (treap.isMultiset())
+				std::merge(model.begin(), model.end(), otherModel.begin(), otherModel.end(), std::back_inserter(expected));
+			else
+			{
+				std::set<int> values(model.begin(), model.end());
+				values.insert(otherModel.begin(), otherModel.end());
+				expected.assign(values.begin(), values.end());
+			}
+			break;
+		case 1:
+			treap.intersect(other);
+			std::set_intersection(model.begin(), model.end(), otherModel.begin(), otherModel.end(), std::back_inserter(expected));
+			break;
+		case 2:
+			treap.difference(other);
+			std::set_difference(model.begin(), model.end(), otherModel.begin(), otherModel.end(), std::back_inserter(expected));
+			break;
+		default:
+			treap.difference(treap);
+			otherModel.clear();
+			other.clear();
+			break;
+		}
+
+		//The other tree is always left empty, and its log has to say so too
+		CHECK(treeValues(treap) == expected);
+		CHECK(isConsistent(treap) && isHeapOrdered(treap));
+		CHECK(log.isValid() && log.getValues() == expected);
+		CHECK(other.isEmpty());
+		CHECK(otherLog.isValid() && otherLog.getValues().empty());
+
+		//The largest node is found again after the nodes were moved around
+		treap.setLog(nullptr);
+		treap.insert(valueRange);
+		treap.bulkLoad({ valueRange + 1 });
+		expected.push_back(valueRange);
+		expected.push_back(valueRange + 1);
+		CHECK(treeValues(treap) == expected);
+	}
+}
+
+int main()
+{
+	std::mt19937 random(37);
+	testOperations(random);
+	testSetOperations(random);
+
+	//Removing every value left after a split used to leave the largest node pointing at a deleted node
+	{
+		Treap<int> treap;
+		for (int i = 1; i <= 10; i++)
+			treap.insert(i);
+		Treap<int> right;
+		treap.split(5, right);
+		for (int i = 1; i < 5; i++)
+			treap.remove(i);
+		treap.insert(50);
+		treap.bulkLoad({ 100 });
+		checkTreap(treap, { 50, 100 });
+		checkTreap(right, { 5, 6, 7, 8, 9, 10 });
+	}
+
+	//Building from sorted values or a stream gives every node a random priority
+	{
+		std::vector<int> values;
+		for (int i = 0; i < 1000; i++)
+			values.push_back(i / 3);
+		Treap<int> loaded(true);
+		loaded.bulkLoad(values);
+		checkTreap(loaded, std::multiset<int>(values.begin(), values.end()));
+		CHECK(loaded.height() < 40);
+
+		std::stringstream stream;
+		CHECK(loaded.saveTo(stream));
+		Treap<int> streamed(true);
+		CHECK(streamed.loadFrom(stream));
+		checkTreap(streamed, std::multiset<int>(values.begin(), values.end()));
+	}
+
+	//Values built in place are logged, and many of them in order still give a short tree
+	{
+		Treap<int> treap;
+		ModelLog<int> log(treap);
+		treap.setLog(&log);
+		std::vector<int> values;
+		for (int i = 0; i < 1000; i++)
+		{
+			CHECK(treap.tryEmplace(i, i).second);
+			values.push_back(i);
+		}
+		CHECK(!treap.tryEmplace(500, 500).second);
+		treap.setLog(nullptr);
+
+		checkTreap(treap, std::multiset<int>(values.begin(), values.end()));
+		CHECK(log.isValid() && log.getValues() == values);
+		CHECK(treap.height() < 40);
+	}
+
+	//Trees built from the same values each draw their own priorities
+	{
+		std::set<unsigned int> rootPriorities;
+		for (int i = 0; i < 8; i++)
+		{
+			Treap<int> treap;
+			treap.insert(1);
+			rootPriorities.insert(treap.getRoot()->getPriority());
+		}
+		CHECK(rootPriorities.size() > 1);
+	}
+
+	return finishTest("TreapTests");
+}
@@ -0,0 +1,210 @@
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "../TreeStats.h"
+#include "TestHelpers.h"
+
+//This file is built both with and without BINARYTREE_STATS, so the counters are checked where they exist
+//and the trees are checked to behave the same where they don't
+
+/// <summary>
+/// Makes the same random changes to every kind of tree and checks the values, so counting can't change what the trees do
+/// </summary>
+template<typename Tree>
+static void testSameResults(std::mt19937& random)
+{
+	for (int round = 0; round < 100; round++)
+	{
+		Tree tree(random() % 2 == 0);
+		std::multiset<int> model;
+		for (int step = 0; step < 200; step++)
+		{
+			int value = (int)(random() % 50);
+			if (random() % 3 == 0)
+			{
+				tree.remove(value);
+				if (model.count(value) > 0)
+					model.erase(model.find(value));
+			}
+			else
+			{
+				tree.insert(value);
+				if (tree.isMultiset() || model.count(value) == 0)
+					model.insert(value);
+			}
+		}
+		CHECK(treeValues(tree) == modelValues<int>(model));
+		CHECK(isConsistent(tree));
+	}
+}
+
+#ifdef BINARYTREE_STATS
+
+/// <summary>
+/// Counts the work of a few operations on a tree small enough to work out every comparison by hand
+/// </summary>
+static void testExactCounts()
+{
+	TreeStats::reset();
+	{
+		BinaryTree<int> tree;
+		for (int value : { 2, 1, 3 })
+			tree.insert(value);
+
+		//The first insert finds an empty tree. The second goes left from the root and the third goes right,
+		//and each compares once more to pick the side the new leaf goes on
+		TreeStatsReport report = TreeStats::read();
+		const TreeOperationStats& inserts = report.get(TreeOperation::Insert);
+		CHECK(inserts.count == 3 && inserts.nodesVisited == 2 && inserts.comparisons == 5);
+		CHECK(inserts.latency.getCount() == 3);
+		CHECK(report.allocations == 3 && report.frees == 0 && report.rotations == 0);
+
+		//Finding 3 stops after one comparison at the root and two at 3, while 1 and a missing 0 take two at each node
+		CHECK(tree.find(3) && tree.find(1) && !tree.find(0));
+		report = TreeStats::read();
+		const TreeOperationStats& finds = report.get(TreeOperation::Find);
+		CHECK(finds.count == 3 && finds.nodesVisited == 6 && finds.comparisons == 11);
+		CHECK(report.get(TreeOperation::Remove).count == 0);
+	}
+
+	//Every node made was freed when the tree went away
+	TreeStatsReport report = TreeStats::read();
+	CHECK(report.frees == 3);
+
+	TreeStats::reset();
+	report = TreeStats::read();
+	CHECK(report.get(TreeOperation::Insert).count == 0 && report.get(TreeOperation::Find).latency.getCount() == 0);
+	CHECK(report.allocations == 0 && report.frees == 0);
+}
+
+/// <summary>
+/// Checks that an operation made inside another one is counted as part of the outer one, and that splaying counts rotations
+/// </summary>
+static void testNestedOperations()
+{
+	TreeStats::reset();
+	Treap<int> treap;
+	for (int value = 0; value < 100; value++)
+		treap.insert(value);
+	treap.remove(50);
+
+	//Treap insert and remove search with find, which mustn't count as finds of their own
+	TreeStatsReport report = TreeStats::read();
+	CHECK(report.get(TreeOperation::Insert).count == 100);
+	CHECK(report.get(TreeOperation::Remove).count == 1);
+	CHECK(report.get(TreeOperation::Find).count == 0);
+	CHECK(report.get(TreeOperation::Insert).comparisons >= report.get(TreeOperation::Insert).nodesVisited);
+
+	TreeStats::reset();
+	SplayTree<int> splayTree;
+	TreeNode<int>* lastNode = nullptr;
+	for (int value = 0; value < 100; value++)
+		lastNode = splayTree.insert(value);
+	CHECK(lastNode == splayTree.getRoot());
+	splayTree.find(0);
+	report = TreeStats::read();
+	CHECK(report.rotations > 0);
+	CHECK(report.get(TreeOperation::Insert).count == 100 && report.get(TreeOperation::Find).count == 1);
+}
+
+/// <summary>
+/// Counts from several threads at once, including threads that finish before the counts are read
+/// </summary>
+static void testThreads()
+{
+	TreeStats::reset();
+	const int threadCount = 4;
+	const int insertCount = 1000;
+	std::vector<std::thread> threads;
+	for (int thread = 0; thread < threadCount; thread++)
+	{
+		threads.emplace_back([thread]()
+		{
+			BinaryTree<int> tree;
+			for (int value = 0; value < insertCount; value++)
+				tree.insert(value * threadCount + thread);
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	TreeStatsReport report = TreeStats::read();
+	CHECK(report.get(TreeOperation::Insert).count == (uint64_t)(threadCount * insertCount));
+	CHECK(report.get(TreeOperation::Insert).latency.getCount() == (uint64_t)(threadCount * insertCount));
+	CHECK(report.allocations == (uint64_t)(threadCount * insertCount) && report.frees == report.allocations);
+}
+
+/// <summary>
+/// Checks that every time falls in a bucket whose limit is at least the time and whose previous limit is below it
+/// </summary>
+static void testLatencyHistogram(std::mt19937& random)
+{
+	for (int i = 0; i < 100000; i++)
+	{
+		uint64_t nanoseconds = (uint64_t)random() >> (random() % 32);
+		size_t bucket = LatencyHistogram::getBucket(nanoseconds);
+		CHECK(bucket < LatencyHistogram::BUCKET_COUNT);
+		CHECK(nanoseconds <= LatencyHistogram::getBucketLimit(bucket));
+		if (bucket > 0)
+			CHECK(nanoseconds > LatencyHistogram::getBucketLimit(bucket - 1));
+	}
+
+	LatencyHistogram histogram;
+	CHECK(histogram.getCount() == 0 && histogram.getMean() == 0.0 && histogram.getPercentile(0.5) == 0);
+	for (uint64_t nanoseconds = 1; nanoseconds <= 1000; nanoseconds++)
+		histogram.record(nanoseconds);
+	CHECK(histogram.getCount() == 1000 && histogram.getMean() == 500.5);
+
+	//Each percentile is at least the real one and within a bucket of it
+	uint64_t median = histogram.getPercentile(0.5);
+	uint64_t tail = histogram.getPercentile(0.99);
+	CHECK(median >= 500 && median < 500 * 107 / 100);
+	CHECK(tail >= 990 && tail < 990 * 107 / 100);
+	CHECK(histogram.getPercentile(1.0) >= 1000);
+}
+
+#else
+
+//Without BINARYTREE_STATS the macros leave nothing behind but the comparison itself
+static_assert(std::is_void<decltype(TREE_STATS_VISIT())>::value, "The visit counter should compile to nothing");
+static_assert(std::is_void<decltype(TREE_STATS_ALLOCATION())>::value, "The allocation counter should compile to nothing");
+static_assert(std::is_same<decltype(TREE_STATS_COMPARE(1 < 2)), bool>::value, "A comparison should be left as it is");
+
+/// <summary>
+/// Checks that the comparison passed to the counter is still evaluated exactly once
+/// </summary>
+static void testCompiledOut()
+{
+	int evaluationCount = 0;
+	CHECK(TREE_STATS_COMPARE(++evaluationCount == 1));
+	CHECK(evaluationCount == 1);
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TREE_STATS_ROTATION();
+	TREE_STATS_FREE();
+}
+
+#endif
+
+int main()
+{
+	std::mt19937 random(46);
+	testSameResults<BinaryTree<int>>(random);
+	testSameResults<SplayTree<int>>(random);
+	testSameResults<Treap<int>>(random);
+
+#ifdef BINARYTREE_STATS
+	testExactCounts();
+	testNestedOperations();
+	testThreads();
+	testLatencyHistogram(random);
+#else
+	testCompiledOut();
+#endif
+
+	return finishTest("TreeStatsTests");
+}
@@ -0,0 +1,273 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "../SplayTree.h"
+#include "../Treap.h"
+#include "../TreeSnapshot.h"
+#include "../WriteAheadLog.h"
+#include "TestHelpers.h"
+
+static const char* SNAPSHOT_PATH = "wal_test.snapshot";
+static const char* LOG_PATH = "wal_test.log";
+static const char* CRASH_SNAPSHOT_PATH = "wal_test_crash.snapshot";
+static const char* CRASH_LOG_PATH = "wal_test_crash.log";
+
+/// <summary>
+/// Copies the file, or removes the copy if there is no file, so the copy looks like the disk at this moment
+/// </summary>
+static void copyFile(const char* path, const char* copyPath)
+{
+	std::error_code error;
+	if (std::filesystem::exists(path, error))
+		std::filesystem::copy_file(path, copyPath, std::filesystem::copy_options::overwrite_existing, error);
+	else
+		std::filesystem::remove(copyPath, error);
+}
+
+/// <summary>
+/// Opens a new tree from the files and checks it against the model
+/// </summary>
+template<typename Tree>
+static void checkRecovery(const char* snapshotPath, const char* logPath, bool isMultiset, const std::multiset<int>& model)
+{
+	Tree tree(isMultiset);
+	WriteAheadLog<int> log;
+	CHECK(log.open(tree, snapshotPath, logPath));
+	CHECK(treeValues(tree) == modelValues<int>(model));
+	CHECK(isConsistent(tree));
+	if constexpr (std::is_same<Tree, Treap<int>>::value)
+		CHECK(isHeapOrdered(tree));
+}
+
+/// <summary>
+/// Makes random changes, commits, checkpoints and restarts, checking every restart against std::multiset.
+/// A copy of the files taken at each commit stands in for the disk after a crash, and is recovered at the end of the round
+/// </summary>
+template<typename Tree>
+static void testRecovery(std::mt19937& random)
+{
+	for (int round = 0; round < 40; round++)
+	{
+		for (const char* path : { SNAPSHOT_PATH, LOG_PATH, CRASH_SNAPSHOT_PATH, CRASH_LOG_PATH })
+			std::remove(path);
+
+		bool isMultiset = random() % 2 == 0;
+		unsigned int groupSize = 1 + (unsigned int)(random() % 16);
+		std::unique_ptr<Tree> tree(new Tree(isMultiset));
+		std::unique_ptr<WriteAheadLog<int>> log(new WriteAheadLog<int>());
+		CHECK(log->open(*tree, SNAPSHOT_PATH, LOG_PATH));
+		log->setGroupSize(groupSize);
+
+		std::multiset<int> model;
+		std::multiset<int> committedModel;
+		int valueRange = 1 + (int)(random() % 100);
+
+		for (int step = 0; step < 400; step++)
+		{
+			int value = (int)(random() % valueRange);
+			switch (random() % 40)
+			{
+			case 0:
+				CHECK(log->commit());
+				committedModel = model;
+				copyFile(SNAPSHOT_PATH, CRASH_SNAPSHOT_PATH);
+				copyFile(LOG_PATH, CRASH_LOG_PATH);
+				break;
+			case 1:
+				CHECK(log->checkpoint());
+				committedModel = model;
+				copyFile(SNAPSHOT_PATH, CRASH_SNAPSHOT_PATH);
+				copyFile(LOG_PATH, CRASH_LOG_PATH);
+				break;
+			case 2:
+				//A clean restart keeps every change, committed or not
+				log.reset();
+				checkRecovery<Tree>(SNAPSHOT_PATH, LOG_PATH, isMultiset, model);
+				tree.reset(new Tree(isMultiset));
+				log.reset(new WriteAheadLog<int>());
+				CHECK(log->open(*tree, SNAPSHOT_PATH, LOG_PATH));
+				log->setGroupSize(groupSize);
+				CHECK(treeValues(*tree) == modelValues<int>(model));
+				break;
+			default:
+				if (random() % 3 == 0)
+				{
+					tree->remove(value);
+					if (model.count(value) > 0)
+						model.erase(model.find(value));
+				}
+				else
+				{
+					tree->insert(value);
+					if (isMultiset || model.count(value) == 0)
+						model.insert(value);
+				}
+				break;
+			}
+		}
+
+		//The crash copies hold what was committed, and a change that was only partly written is dropped
+		if (std::filesystem::exists(CRASH_LOG_PATH))
+		{
+			checkRecovery<Tree>(CRASH_SNAPSHOT_PATH, CRASH_LOG_PATH, isMultiset, committedModel);
+
+			FILE* crashLog = std::fopen(CRASH_LOG_PATH, "ab");
+			const char tornRecord[] = "partial";
+			std::fwrite(tornRecord, 1, sizeof(tornRecord), crashLog);
+			std::fclose(crashLog);
+			checkRecovery<Tree>(CRASH_SNAPSHOT_PATH, CRASH_LOG_PATH, isMultiset, committedModel);
+		}
+
+		log.reset();
+		checkRecovery<BinaryTree<int>>(SNAPSHOT_PATH, LOG_PATH, isMultiset, model);
+	}
+}
+
+/// <summary>
+/// Damages a checkpointed snapshot in different ways and checks that none of them can be opened
+/// </summary>
+static void testDamagedSnapshot()
+{
+	std::remove(SNAPSHOT_PATH);
+	std::remove(LOG_PATH);
+	{
+		BinaryTree<int> tree;
+		WriteAheadLog<int> log;
+		CHECK(log.open(tree, SNAPSHOT_PATH, LOG_PATH));
+		for (int value : { 50, 25, 75, 10, 30, 60, 90 })
+			tree.insert(value);
+		CHECK(log.checkpoint());
+		tree.insert(1);
+	}
+	copyFile(SNAPSHOT_PATH, CRASH_SNAPSHOT_PATH);
+	checkRecovery<BinaryTree<int>>(SNAPSHOT_PATH, LOG_PATH, false, { 1, 10, 25, 30, 50, 60, 75, 90 });
+
+	//A root that links back to itself, a child past the end of the file and a truncated file
+	const long rootLeftOffset = (long)(sizeof(SnapshotHeader) + offsetof(SnapshotNode<int>, left));
+	const long rootRightOffset = (long)(sizeof(SnapshotHeader) + offsetof(SnapshotNode<int>, right));
+	const uint32_t badLinks[] = { 0, 1000 };
+	const long badOffsets[] = { rootLeftOffset, rootRightOffset };
+	for (int i = 0; i < 3; i++)
+	{
+		copyFile(CRASH_SNAPSHOT_PATH, SNAPSHOT_PATH);
+		if (i < 2)
+		{
+			FILE* snapshot = std::fopen(SNAPSHOT_PATH, "r+b");
+			std::fseek(snapshot, badOffsets[i], SEEK_SET);
+			std::fwrite(&badLinks[i], sizeof(uint32_t), 1, snapshot);
+			std::fclose(snapshot);
+		}
+		else
+			std::filesystem::resize_file(SNAPSHOT_PATH, 10);
+
+		BinaryTree<int> tree;
+		WriteAheadLog<int> log;
+		CHECK(!log.open(tree, SNAPSHOT_PATH, LOG_PATH));
+		CHECK(tree.isEmpty());
+	}
+}
+
+/// <summary>
+/// Destroys or replaces the tree before the log is closed. The log must stop using the tree,
+/// while the changes it already logged are still kept
+/// </summary>
+static void testTreeGoneFirst()
+{
+	std::remove(SNAPSHOT_PATH);
+	std::remove(LOG_PATH);
+	{
+		WriteAheadLog<int> log;
+		{
+			Treap<int> tree;
+			CHECK(log.open(tree, SNAPSHOT_PATH, LOG_PATH));
+			for (int value : { 3, 1, 2 })
+				tree.insert(value);
+		}
+
+		//There is no tree left to snapshot, and closing the log only writes what it was told
+		CHECK(!log.checkpoint());
+		CHECK(log.commit());
+	}
+	checkRecovery<BinaryTree<int>>(SNAPSHOT_PATH, LOG_PATH, false, { 1, 2, 3 });
+
+	//A tree that is given another log detaches this one
+	{
+		BinaryTree<int> tree;
+		WriteAheadLog<int> log;
+		CHECK(log.open(tree, SNAPSHOT_PATH, LOG_PATH));
+		tree.insert(4);
+		ModelLog<int> otherLog(tree);
+		tree.setLog(&otherLog);
+		tree.insert(5);
+		CHECK(!log.checkpoint());
+		tree.setLog(nullptr);
+	}
+	checkRecovery<BinaryTree<int>>(SNAPSHOT_PATH, LOG_PATH, false, { 1, 2, 3, 4 });
+}
+
+/// <summary>
+/// Moves and swaps a logged tree, then keeps changing and checkpointing it. The log has to follow the nodes,
+/// or the checkpoint would save the emptied tree and the values would be lost on the next restart
+/// </summary>
+static void testTreeMoved()
+{
+	std::remove(SNAPSHOT_PATH);
+	std::remove(LOG_PATH);
+	{
+		WriteAheadLog<int> log;
+		Treap<int> tree;
+		CHECK(log.open(tree, SNAPSHOT_PATH, LOG_PATH));
+		tree.insert(1);
+
+		Treap<int> moved = std::move(tree);
+		CHECK(tree.getLog() == nullptr && moved.getLog() == &log);
+		moved.insert(2);
+		tree.insert(100);
+		CHECK(log.checkpoint());
+		moved.insert(3);
+
+		//Swapping hands each log the other tree, and a tree moved over another lets go of the log it had
+		Treap<int> other;
+		ModelLog<int> otherLog(other);
+		other.setLog(&otherLog);
+		other.insert(200);
+		moved.swap(other);
+		CHECK(moved.getLog() == &otherLog && other.getLog() == &log);
+		other.insert(4);
+		moved.insert(201);
+		CHECK(otherLog.getValues() == std::vector<int>({ 200, 201 }));
+
+		Treap<int> target;
+		WriteAheadLog<int> targetLog;
+		CHECK(targetLog.open(target, CRASH_SNAPSHOT_PATH, CRASH_LOG_PATH));
+		target = std::move(other);
+		CHECK(target.getLog() == &log && !targetLog.checkpoint());
+		target.insert(5);
+		CHECK(log.checkpoint());
+		target.insert(6);
+		moved.setLog(nullptr);
+	}
+	checkRecovery<BinaryTree<int>>(SNAPSHOT_PATH, LOG_PATH, false, { 1, 2, 3, 4, 5, 6 });
+}
+
+int main()
+{
+	std::mt19937 random(33);
+	testRecovery<BinaryTree<int>>(random);
+	testRecovery<SplayTree<int>>(random);
+	testRecovery<Treap<int>>(random);
+	testDamagedSnapshot();
+	testTreeGoneFirst();
+	testTreeMoved();
+
+	for (const char* path : { SNAPSHOT_PATH, LOG_PATH, CRASH_SNAPSHOT_PATH, CRASH_LOG_PATH })
+		std::remove(path);
+
+	return finishTest("WriteAheadLogTests");
+}
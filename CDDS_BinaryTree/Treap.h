@@ -0,0 +1,943 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "BinaryTree.h"
+#include "TreeNode.h"
+#include "TreeStats.h"
+#include "TreeTraversal.h"
+
+/// <summary>
+/// A tree that gives every node a random priority and keeps parents at a higher priority than their
+/// children. The random priorities keep the tree balanced with an expected height of O(log n), and
+/// let two trees be split and merged quickly, which makes union, intersection and difference cheap.
+/// Every member that adds or removes nodes is replaced here so it keeps the priorities in heap order, and the hinted
+/// insert is deleted since a hint can't say where a priority belongs. The base members aren't virtual, so a treap
+/// changed through a BinaryTree reference or pointer still holds its values in order but may lose its heap order and balance
+/// </summary>
+template<typename T>
+class Treap : public BinaryTree<T>
+{
+public:
+
+	Treap() {}
+	/// <summary>
+	/// Creates a tree that either ignores duplicate values or counts them
+	/// </summary>
+	/// <param name="isMultiset">Whether inserting a value that is already in the tree should add another copy of it</param>
+	explicit Treap(bool isMultiset) : BinaryTree<T>(isMultiset) {}
+	/// <summary>
+	/// Creates a separate copy of every node in the tree, keeping their priorities
+	/// </summary>
+	/// <returns>A new treap with the same shape and values, without a log or find cache</returns>
+	Treap<T> clone() const;
+
+	/// <summary>
+	/// Adds the value to the tree in the place its random priority calls for
+	/// </summary>
+	/// <param name="value">The new value to add to the tree</param>
+	/// <returns>The node storing the value</returns>
+	TreeNode<T>* insert(T value);
+	/// <summary>
+	/// Places a node that was extracted from this or another tree with a new random priority, without creating a new one.
+	/// If the value is already in a multiset the node's copies are added to the existing node and the
+	/// extracted node is deleted. If it is already in a set the handle keeps the node
+	/// </summary>
+	/// <param name="handle">The handle owning the node, which is left empty once the node is placed</param>
+	/// <returns>The node storing the value</returns>
+	TreeNode<T>* insert(NodeHandle<T>& handle);
+	/// <summary>
+	/// A hint is no use in a tree whose shape is set by random priorities. Use insert(value) instead
+	/// </summary>
+	TreeNode<T>* insert(TreeNode<T>* hint, T value) = delete;
+	/// <summary>
+	/// Returns the node whose value is equivalent to the key, or builds a value in place from the arguments
+	/// and places it where a new random priority calls for
+	/// </summary>
+	/// <param name="key">The key to search for, which must order the same as the value the arguments build</param>
+	/// <param name="args">The arguments passed to the value's constructor</param>
+	/// <returns>The node storing the key's value and whether or not it was just added</returns>
+	template<typename Key, typename... Args>
+	std::pair<TreeNode<T>*, bool> tryEmplace(const Key& key, Args&&... args);
+	/// <summary>
+	/// Removes the value from the tree by merging the children of its node in its place
+	/// </summary>
+	/// <param name="value">The value to remove</param>
+	void remove(T value);
+	/// <summary>
+	/// Removes the node from the tree by merging its children in its place, and deletes it
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	void erase(TreeNode<T>* node);
+	/// <summary>
+	/// Removes the node the iterator is at
+	/// </summary>
+	/// <param name="position">An iterator at a node in the tree</param>
+	/// <returns>An iterator at the node after the one removed</returns>
+	typename BinaryTree<T>::Iterator erase(typename BinaryTree<T>::Iterator position);
+	/// <summary>
+	/// Takes the node holding the value out of the tree without deleting it, along with every copy it stands for
+	/// </summary>
+	/// <param name="value">The value of the node to take out</param>
+	/// <returns>A handle owning the node, which is empty if the value isn't in the tree</returns>
+	NodeHandle<T> extract(T value);
+	/// <summary>
+	/// Takes the node out of the tree without deleting it
+	/// </summary>
+	/// <param name="node">A node in the tree</param>
+	/// <returns>A handle owning the node</returns>
+	NodeHandle<T> extract(TreeNode<T>* node);
+	/// <summary>
+	/// Moves every node of the given tree into this tree, merging them by priority.
+	/// Every value in the given tree must be greater than every value in this tree
+	/// </summary>
+	/// <param name="right">The tree whose nodes will be added after the nodes of this tree</param>
+	/// <returns>Whether or not the trees were joined. Trees whose values overlap or that count duplicates differently are left as they were</returns>
+	bool join(Treap<T>& right);
+
+	/// <summary>
+	/// Moves every value of the other tree into this tree. In a multiset the copies are added together.
+	/// Takes O(m log(n / m + 1)) time, where m is the size of the smaller tree
+	/// </summary>
+	/// <param name="other">The tree to take the values from, which is left empty</param>
+	void unionWith(Treap<T>& other);
+	/// <summary>
+	/// Keeps only the values that are also in the other tree. In a multiset the smaller count is kept
+	/// </summary>
+	/// <param name="other">The tree to compare against, which is left empty</param>
+	void intersect(Treap<T>& other);
+	/// <summary>
+	/// Removes every value that is in the other tree. In a multiset the other tree's copies are subtracted
+	/// </summary>
+	/// <param name="other">The tree holding the values to remove, which is left empty</param>
+	void difference(Treap<T>& other);
+
+	/// <summary>
+	/// Adds every value in the list to the tree. If the tree is empty and the list is sorted, the nodes are
+	/// given random priorities and linked together in O(n), with the same shape inserting them would give
+	/// </summary>
+	/// <param name="sortedValues">The values to add, from smallest to largest</param>
+	void bulkLoad(const std::vector<T>& sortedValues);
+	/// <summary>
+	/// Reads one value per line from the stream and adds them to the tree as they are read, giving every new node a
+	/// random priority. Sorted values read into an empty tree are placed along the right edge in O(1) on average, and
+	/// only the edge is kept in memory besides the nodes. Anything else is inserted one by one
+	/// </summary>
+	/// <param name="stream">The stream to read the values from</param>
+	/// <returns>Whether or not every line could be read as a value</returns>
+	bool loadFrom(std::istream& stream);
+
+private:
+	/// <summary>
+	/// Returns the next random priority
+	/// </summary>
+	unsigned int nextPriority();
+	/// <summary>
+	/// Returns a different starting state for every tree, so no two trees draw the same priorities
+	/// </summary>
+	static uint32_t makeSeed();
+	/// <summary>
+	/// Places a node that isn't in the tree yet and whose value isn't in the tree either
+	/// </summary>
+	void linkNode(TreeNode<T>* newNode);
+	/// <summary>
+	/// Takes the node out of the tree by merging its children in its place, telling the log that its copies were removed
+	/// </summary>
+	void unlinkNode(TreeNode<T>* nodeToRemove);
+	/// <summary>
+	/// Adds a value that isn't smaller than any value in the tree. The new node belongs on the right edge, and the
+	/// nodes on the edge below its priority become its left subtree. Only used while the tree is built from sorted values
+	/// </summary>
+	/// <param name="value">The value to add</param>
+	/// <param name="rightEdge">The nodes on the tree's right edge from the root down, which is kept up to date</param>
+	void appendLargest(const T& value, std::vector<TreeNode<T>*>& rightEdge);
+
+	/// <summary>
+	/// Splits a subtree into the nodes less than the value, the node equal to it and the nodes greater than it.
+	/// Splitting along a single path keeps both halves in heap order
+	/// </summary>
+	static void splitAround(TreeNode<T>* node, const T& value, TreeNode<T>*& less, TreeNode<T>*& equal, TreeNode<T>*& greater);
+	/// <summary>
+	/// Merges two subtrees whose values don't overlap, the left one holding the smaller values
+	/// </summary>
+	static TreeNode<T>* merge(TreeNode<T>* left, TreeNode<T>* right);
+
+	/// <summary>
+	/// Combines a subtree of this tree with a subtree of the other tree, telling the log about every copy added or removed
+	/// </summary>
+	TreeNode<T>* unionNodes(TreeNode<T>* first, TreeNode<T>* second);
+	TreeNode<T>* intersectNodes(TreeNode<T>* first, TreeNode<T>* second);
+	TreeNode<T>* differenceNodes(TreeNode<T>* first, TreeNode<T>* second);
+	/// <summary>
+	/// Tells the log about a subtree of the other tree that moves into this tree whole. A set keeps one copy of each value
+	/// </summary>
+	void adoptNodes(TreeNode<T>* node);
+	/// <summary>
+	/// Tells the log that every copy in the subtree is being removed
+	/// </summary>
+	void logRemoveNodes(TreeNode<T>* node);
+
+	/// <summary>
+	/// Deletes every node in the subtree
+	/// </summary>
+	static void deleteNodes(TreeNode<T>* node);
+	/// <summary>
+	/// Walks down the right edge to find the largest node again, after many nodes were moved at once
+	/// </summary>
+	void refreshLargestNode();
+
+	uint32_t m_randomState = makeSeed();
+};
+
+template<typename T>
+inline Treap<T> Treap<T>::clone() const
+{
+	Treap<T> copy(this->isMultiset());
+	this->cloneInto(copy);
+	return copy;
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::insert(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+
+	//Counts another copy if the value is already in the tree
+	TreeNode<T>* existingNode = this->findKey(value);
+	if (existingNode)
+	{
+		if (this->isMultiset())
+		{
+			if (this->getLog())
+				this->getLog()->logInsert(value);
+			existingNode->setCount(existingNode->getCount() + 1);
+		}
+		return existingNode;
+	}
+
+	if (this->getLog())
+		this->getLog()->logInsert(value);
+
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* newNode = new TreeNode<T>(value);
+	newNode->setPriority(nextPriority());
+	linkNode(newNode);
+	return newNode;
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::insert(NodeHandle<T>& handle)
+{
+	if (handle.isEmpty())
+		return nullptr;
+
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TreeNode<T>* node = handle.getNode();
+	TreeNode<T>* existingNode = this->findKey(node->getData());
+	if (existingNode)
+	{
+		//A multiset takes the copies and the extra node is no longer needed
+		if (this->isMultiset())
+		{
+			if (this->getLog())
+			{
+				for (unsigned int i = 0; i < node->getCount(); i++)
+					this->getLog()->logInsert(node->getData());
+			}
+			existingNode->setCount(existingNode->getCount() + node->getCount());
+			handle = NodeHandle<T>();
+		}
+		return existingNode;
+	}
+
+	//A set only keeps one copy of every value
+	if (!this->isMultiset())
+		node->setCount(1);
+
+	if (this->getLog())
+	{
+		for (unsigned int i = 0; i < node->getCount(); i++)
+			this->getLog()->logInsert(node->getData());
+	}
+
+	//The node may come from a tree that doesn't use priorities, so it gets a new one
+	handle.release();
+	node->setPriority(nextPriority());
+	linkNode(node);
+	return node;
+}
+
+template<typename T>
+template<typename Key, typename... Args>
+inline std::pair<TreeNode<T>*, bool> Treap<T>::tryEmplace(const Key& key, Args&&... args)
+{
+	TREE_STATS_OPERATION(TreeOperation::Insert);
+	TreeNode<T>* existingNode = this->findKey(key);
+	if (existingNode)
+		return std::pair<TreeNode<T>*, bool>(existingNode, false);
+
+	//The value is built straight into the new node
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* newNode = new TreeNode<T>(std::in_place, std::forward<Args>(args)...);
+	if (this->getLog())
+		this->getLog()->logInsert(newNode->getData());
+
+	newNode->setPriority(nextPriority());
+	linkNode(newNode);
+	return std::pair<TreeNode<T>*, bool>(newNode, true);
+}
+
+template<typename T>
+inline void Treap<T>::linkNode(TreeNode<T>* newNode)
+{
+	const T& value = newNode->getData();
+
+	//Walks down until reaching a node with a lower priority, which is where the new node belongs
+	TreeNode<T>* parentNode = nullptr;
+	TreeNode<T>* currentNode = this->getRoot();
+	while (currentNode && currentNode->getPriority() >= newNode->getPriority())
+	{
+		parentNode = currentNode;
+		TREE_STATS_VISIT();
+		currentNode = TREE_STATS_COMPARE(value < currentNode->getData()) ? currentNode->getLeft() : currentNode->getRight();
+	}
+
+	//The subtree that was there is split around the new value and becomes its children
+	TreeNode<T>* less;
+	TreeNode<T>* equal;
+	TreeNode<T>* greater;
+	splitAround(currentNode, value, less, equal, greater);
+	newNode->setLeft(less);
+	newNode->setRight(greater);
+
+	if (!parentNode)
+		this->setRoot(newNode);
+	else if (TREE_STATS_COMPARE(value < parentNode->getData()))
+		parentNode->setLeft(newNode);
+	else
+		parentNode->setRight(newNode);
+
+	if (!this->getLargestNode() || this->getLargestNode()->getData() < value)
+		this->setLargestNode(newNode);
+
+	//The nodes the split moved under the new node are one level deeper, so the height has to be measured again
+	this->adjustSize(1);
+	this->forgetHeight();
+}
+
+template<typename T>
+inline void Treap<T>::remove(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	TreeNode<T>* nodeToRemove = this->find(value);
+	if (!nodeToRemove)
+		return;
+
+	//If the node stands for more than one copy, only remove one of them
+	if (nodeToRemove->getCount() > 1)
+	{
+		if (this->getLog())
+			this->getLog()->logRemove(value);
+		nodeToRemove->setCount(nodeToRemove->getCount() - 1);
+		return;
+	}
+
+	erase(nodeToRemove);
+}
+
+template<typename T>
+inline void Treap<T>::erase(TreeNode<T>* nodeToRemove)
+{
+	if (!nodeToRemove)
+		return;
+
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	unlinkNode(nodeToRemove);
+	NodeArena<T>::destroyNode(nodeToRemove);
+}
+
+template<typename T>
+inline typename BinaryTree<T>::Iterator Treap<T>::erase(typename BinaryTree<T>::Iterator position)
+{
+	TreeNode<T>* nodeToRemove = position.getNode();
+	++position;
+	erase(nodeToRemove);
+	return position;
+}
+
+template<typename T>
+inline NodeHandle<T> Treap<T>::extract(T value)
+{
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	return extract(this->find(value));
+}
+
+template<typename T>
+inline NodeHandle<T> Treap<T>::extract(TreeNode<T>* node)
+{
+	if (!node)
+		return NodeHandle<T>();
+
+	//A node in an arena can't be owned on its own, so the handle gets a copy of it instead
+	TREE_STATS_OPERATION(TreeOperation::Remove);
+	unlinkNode(node);
+	return NodeHandle<T>(NodeArena<T>::moveOutOfArena(node));
+}
+
+template<typename T>
+inline bool Treap<T>::join(Treap<T>& right)
+{
+	if (&right == this || right.isMultiset() != this->isMultiset())
+		return false;
+	if (right.isEmpty())
+		return true;
+
+	//Finds the largest node in this tree and the smallest node in the other tree
+	TreeNode<T>* largestNode = this->getLargestNode();
+
+	TreeNode<T>* smallestNode = right.getRoot();
+	while (smallestNode->hasLeft())
+		smallestNode = smallestNode->getLeft();
+
+	//Refuse if the trees overlap, since joining them would break the ordering
+	if (largestNode && !(largestNode->getData() < smallestNode->getData()))
+		return false;
+
+	this->shareArenas(right);
+	this->takeSize(right);
+	this->forgetHeight();
+	this->setRoot(merge(this->getRoot(), right.getRoot()));
+	this->setLargestNode(right.getLargestNode());
+	right.setRoot(nullptr);
+	right.clearFindCache();
+	return true;
+}
+
+template<typename T>
+inline void Treap<T>::unionWith(Treap<T>& other)
+{
+	if (&other == this)
+		return;
+
+	//The other tree is emptied, so its own log loses every value it had
+	other.logRemoveNodes(other.getRoot());
+
+	this->shareArenas(other);
+	this->setRoot(unionNodes(this->getRoot(), other.getRoot()));
+	other.setRoot(nullptr);
+	refreshLargestNode();
+	this->forgetSize();
+	this->forgetHeight();
+	this->clearFindCache();
+	other.clearFindCache();
+}
+
+template<typename T>
+inline void Treap<T>::intersect(Treap<T>& other)
+{
+	if (&other == this)
+		return;
+
+	other.logRemoveNodes(other.getRoot());
+
+	this->shareArenas(other);
+	this->setRoot(intersectNodes(this->getRoot(), other.getRoot()));
+	other.setRoot(nullptr);
+	refreshLargestNode();
+	this->forgetSize();
+	this->forgetHeight();
+	this->clearFindCache();
+	other.clearFindCache();
+}
+
+template<typename T>
+inline void Treap<T>::difference(Treap<T>& other)
+{
+	//Removing a tree from itself leaves nothing
+	if (&other == this)
+	{
+		this->clear();
+		return;
+	}
+
+	other.logRemoveNodes(other.getRoot());
+
+	this->setRoot(differenceNodes(this->getRoot(), other.getRoot()));
+	other.setRoot(nullptr);
+	refreshLargestNode();
+	this->forgetSize();
+	this->forgetHeight();
+	this->clearFindCache();
+	other.clearFindCache();
+}
+
+template<typename T>
+inline void Treap<T>::bulkLoad(const std::vector<T>& sortedValues)
+{
+	//If the tree already has nodes or the values are out of order, they have to be inserted one by one
+	if (!this->isEmpty() || !std::is_sorted(sortedValues.begin(), sortedValues.end()))
+	{
+		for (const T& value : sortedValues)
+			insert(value);
+		return;
+	}
+
+	//Every new node is larger than the ones before it, so it belongs on the right edge of the tree so far
+	std::vector<TreeNode<T>*> rightEdge;
+	for (const T& value : sortedValues)
+		appendLargest(value, rightEdge);
+}
+
+template<typename T>
+inline bool Treap<T>::loadFrom(std::istream& stream)
+{
+	//While the values come in order, each one is placed along the right edge
+	bool isAppending = this->isEmpty();
+	std::vector<TreeNode<T>*> rightEdge;
+
+	return this->readValues(stream, [&](const T& value)
+	{
+		if (isAppending && (rightEdge.empty() || !(value < rightEdge.back()->getData())))
+			appendLargest(value, rightEdge);
+		else
+		{
+			isAppending = false;
+			insert(value);
+		}
+	});
+}
+
+template<typename T>
+inline void Treap<T>::appendLargest(const T& value, std::vector<TreeNode<T>*>& rightEdge)
+{
+	//The node added last is the largest, and always ends the right edge
+	TreeNode<T>* lastNode = rightEdge.empty() ? nullptr : rightEdge.back();
+	if (this->getLog() && (this->isMultiset() || !lastNode || lastNode->getData() < value))
+		this->getLog()->logInsert(value);
+
+	//Copies of the same value are counted on one node in a multiset
+	if (lastNode && !(lastNode->getData() < value))
+	{
+		if (this->isMultiset())
+			lastNode->setCount(lastNode->getCount() + 1);
+		return;
+	}
+
+	TREE_STATS_ALLOCATION();
+	TreeNode<T>* newNode = new TreeNode<T>(value);
+	newNode->setPriority(nextPriority());
+
+	TreeNode<T>* leftChild = nullptr;
+	while (!rightEdge.empty() && rightEdge.back()->getPriority() < newNode->getPriority())
+	{
+		leftChild = rightEdge.back();
+		rightEdge.pop_back();
+	}
+	newNode->setLeft(leftChild);
+	if (!rightEdge.empty())
+		rightEdge.back()->setRight(newNode);
+	else
+		this->setRoot(newNode);
+	rightEdge.push_back(newNode);
+
+	this->setLargestNode(newNode);
+	this->adjustSize(1);
+	this->forgetHeight();
+}
+
+template<typename T>
+inline unsigned int Treap<T>::nextPriority()
+{
+	//Xorshift, which is plenty random for balancing and costs a few instructions
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+	return m_randomState;
+}
+
+template<typename T>
+inline uint32_t Treap<T>::makeSeed()
+{
+	//The random device is only read once, after which every tree takes the next step of a shared counter
+	static std::atomic<uint64_t> nextSeed(((uint64_t)std::random_device()() << 32) | std::random_device()());
+	uint64_t seed = nextSeed.fetch_add(0x9E3779B97F4A7C15ull);
+
+	//Splitmix64 spreads the counter's bits so neighbouring trees start far apart
+	seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ull;
+	seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBull;
+	seed ^= seed >> 31;
+
+	//Xorshift would only ever return zero from zero
+	uint32_t state = (uint32_t)(seed ^ (seed >> 32));
+	return state != 0 ? state : 2463534242u;
+}
+
+template<typename T>
+inline void Treap<T>::unlinkNode(TreeNode<T>* nodeToRemove)
+{
+	if (this->getLog())
+	{
+		for (unsigned int i = 0; i < nodeToRemove->getCount(); i++)
+			this->getLog()->logRemove(nodeToRemove->getData());
+	}
+
+	if (nodeToRemove == this->getLargestNode())
+		this->setLargestNode(this->prev(nodeToRemove));
+
+	//Merging two subtrees can move nodes down as well as up, so only a node with at most one child can keep the height
+	this->adjustSize(-1);
+	if ((nodeToRemove->hasLeft() && nodeToRemove->hasRight()) || this->canLowerHeight(nodeToRemove))
+		this->forgetHeight();
+
+	//The node's children are merged by priority and take its place
+	TreeNode<T>* parentNode = nodeToRemove->getParent();
+	TreeNode<T>* replacementNode = merge(nodeToRemove->getLeft(), nodeToRemove->getRight());
+	if (!parentNode)
+		this->setRoot(replacementNode);
+	else if (parentNode->getLeft() == nodeToRemove)
+		parentNode->setLeft(replacementNode);
+	else
+		parentNode->setRight(replacementNode);
+
+	this->forgetCachedNode(nodeToRemove);
+
+	//Cuts the node's links so it can be placed somewhere else
+	nodeToRemove->setLeft(nullptr);
+	nodeToRemove->setRight(nullptr);
+	nodeToRemove->setParent(nullptr);
+}
+
+template<typename T>
+inline void Treap<T>::splitAround(TreeNode<T>* node, const T& value, TreeNode<T>*& less, TreeNode<T>*& equal, TreeNode<T>*& greater)
+{
+	TreeNode<T>* lessTail = nullptr;
+	TreeNode<T>* greaterTail = nullptr;
+	less = nullptr;
+	equal = nullptr;
+	greater = nullptr;
+
+	while (node)
+	{
+		TREE_STATS_VISIT();
+
+		//Smaller nodes and their left subtrees go to the less half
+		if (TREE_STATS_COMPARE(node->getData() < value))
+		{
+			if (lessTail)
+				lessTail->setRight(node);
+			else
+				less = node;
+			lessTail = node;
+			node = node->getRight();
+		}
+
+		//Larger nodes and their right subtrees go to the greater half
+		else if (TREE_STATS_COMPARE(value < node->getData()))
+		{
+			if (greaterTail)
+				greaterTail->setLeft(node);
+			else
+				greater = node;
+			greaterTail = node;
+			node = node->getLeft();
+		}
+
+		//The equal node's children finish off both halves
+		else
+		{
+			equal = node;
+			node = nullptr;
+			break;
+		}
+	}
+
+	//Closes off both halves, handing them the equal node's children if there was one
+	if (lessTail)
+		lessTail->setRight(equal ? equal->getLeft() : nullptr);
+	else if (equal)
+		less = equal->getLeft();
+
+	if (greaterTail)
+		greaterTail->setLeft(equal ? equal->getRight() : nullptr);
+	else if (equal)
+		greater = equal->getRight();
+
+	if (equal)
+	{
+		equal->setLeft(nullptr);
+		equal->setRight(nullptr);
+	}
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::merge(TreeNode<T>* left, TreeNode<T>* right)
+{
+	TreeNode<T>* root = nullptr;
+	TreeNode<T>* parentNode = nullptr;
+	bool isLeftChild = false;
+
+	//Walks down the right edge of the left tree and the left edge of the right tree,
+	//always linking in the node with the higher priority next
+	while (left && right)
+	{
+		TreeNode<T>* nextNode = left->getPriority() >= right->getPriority() ? left : right;
+
+		if (!parentNode)
+			root = nextNode;
+		else if (isLeftChild)
+			parentNode->setLeft(nextNode);
+		else
+			parentNode->setRight(nextNode);
+
+		//A node from the left tree gets the rest of the merge on its right, and the other way around
+		parentNode = nextNode;
+		isLeftChild = nextNode == right;
+		if (isLeftChild)
+			right = right->getLeft();
+		else
+			left = left->getRight();
+	}
+
+	//Once one side runs out, the rest of the other side is already in heap order
+	TreeNode<T>* remainingNodes = left ? left : right;
+	if (!parentNode)
+		root = remainingNodes;
+	else if (isLeftChild)
+		parentNode->setLeft(remainingNodes);
+	else
+		parentNode->setRight(remainingNodes);
+
+	return root;
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::unionNodes(TreeNode<T>* first, TreeNode<T>* second)
+{
+	if (!first)
+	{
+		adoptNodes(second);
+		return second;
+	}
+	if (!second)
+		return first;
+
+	TreeNode<T>* less;
+	TreeNode<T>* equal;
+	TreeNode<T>* greater;
+
+	//The node with the higher priority stays on top and the other subtree is split around it
+	if (first->getPriority() >= second->getPriority())
+	{
+		splitAround(second, first->getData(), less, equal, greater);
+
+		//A value this tree already has only gains copies in a multiset
+		if (equal)
+		{
+			unsigned int addedCount = this->isMultiset() ? equal->getCount() : 0;
+			first->setCount(first->getCount() + addedCount);
+			if (this->getLog())
+			{
+				for (unsigned int i = 0; i < addedCount; i++)
+					this->getLog()->logInsert(first->getData());
+			}
+			NodeArena<T>::destroyNode(equal);
+		}
+
+		first->setLeft(unionNodes(first->getLeft(), less));
+		first->setRight(unionNodes(first->getRight(), greater));
+		return first;
+	}
+
+	splitAround(first, second->getData(), less, equal, greater);
+
+	unsigned int addedCount = this->isMultiset() ? second->getCount() : 0;
+	if (equal)
+	{
+		second->setCount(equal->getCount() + addedCount);
+		NodeArena<T>::destroyNode(equal);
+	}
+	else
+	{
+		addedCount = this->isMultiset() ? addedCount : 1;
+		second->setCount(addedCount);
+	}
+
+	if (this->getLog())
+	{
+		for (unsigned int i = 0; i < addedCount; i++)
+			this->getLog()->logInsert(second->getData());
+	}
+
+	second->setLeft(unionNodes(less, second->getLeft()));
+	second->setRight(unionNodes(greater, second->getRight()));
+	return second;
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::intersectNodes(TreeNode<T>* first, TreeNode<T>* second)
+{
+	if (!first || !second)
+	{
+		logRemoveNodes(first);
+		deleteNodes(first);
+		deleteNodes(second);
+		return nullptr;
+	}
+
+	TreeNode<T>* less;
+	TreeNode<T>* equal;
+	TreeNode<T>* greater;
+	TreeNode<T>* topNode;
+	TreeNode<T>* left;
+	TreeNode<T>* right;
+	unsigned int count = 0;
+	unsigned int keptCount = 0;
+
+	//The node with the higher priority stays on top and the other subtree is split around it
+	if (first->getPriority() >= second->getPriority())
+	{
+		splitAround(second, first->getData(), less, equal, greater);
+		left = intersectNodes(first->getLeft(), less);
+		right = intersectNodes(first->getRight(), greater);
+
+		topNode = first;
+		count = first->getCount();
+		if (equal)
+		{
+			keptCount = std::min(count, equal->getCount());
+			NodeArena<T>::destroyNode(equal);
+		}
+	}
+	else
+	{
+		splitAround(first, second->getData(), less, equal, greater);
+		left = intersectNodes(less, second->getLeft());
+		right = intersectNodes(greater, second->getRight());
+
+		topNode = second;
+		if (equal)
+		{
+			count = equal->getCount();
+			keptCount = std::min(count, second->getCount());
+			NodeArena<T>::destroyNode(equal);
+		}
+	}
+
+	//Every copy of this tree's that the other tree doesn't match is removed
+	if (this->getLog())
+	{
+		for (unsigned int i = keptCount; i < count; i++)
+			this->getLog()->logRemove(topNode->getData());
+	}
+
+	//The node is kept only if both trees had it
+	if (keptCount > 0)
+	{
+		topNode->setCount(keptCount);
+		topNode->setLeft(left);
+		topNode->setRight(right);
+		return topNode;
+	}
+
+	NodeArena<T>::destroyNode(topNode);
+	return merge(left, right);
+}
+
+template<typename T>
+inline TreeNode<T>* Treap<T>::differenceNodes(TreeNode<T>* first, TreeNode<T>* second)
+{
+	if (!first || !second)
+	{
+		deleteNodes(second);
+		return first;
+	}
+
+	//The first tree's node stays on top since only its values can survive
+	TreeNode<T>* less;
+	TreeNode<T>* equal;
+	TreeNode<T>* greater;
+	splitAround(second, first->getData(), less, equal, greater);
+
+	TreeNode<T>* left = differenceNodes(first->getLeft(), less);
+	TreeNode<T>* right = differenceNodes(first->getRight(), greater);
+
+	//The node is dropped if the other tree had as many copies of it
+	if (equal)
+	{
+		unsigned int removedCount = std::min(first->getCount(), equal->getCount());
+		bool isKept = removedCount < first->getCount();
+		if (isKept)
+			first->setCount(first->getCount() - removedCount);
+		NodeArena<T>::destroyNode(equal);
+
+		if (this->getLog())
+		{
+			for (unsigned int i = 0; i < removedCount; i++)
+				this->getLog()->logRemove(first->getData());
+		}
+
+		if (!isKept)
+		{
+			NodeArena<T>::destroyNode(first);
+			return merge(left, right);
+		}
+	}
+
+	first->setLeft(left);
+	first->setRight(right);
+	return first;
+}
+
+template<typename T>
+inline void Treap<T>::refreshLargestNode()
+{
+	TreeNode<T>* largestNode = this->getRoot();
+	while (largestNode && largestNode->hasRight())
+		largestNode = largestNode->getRight();
+	this->setLargestNode(largestNode);
+}
+
+template<typename T>
+inline void Treap<T>::adoptNodes(TreeNode<T>* node)
+{
+	if (!this->getLog() && this->isMultiset())
+		return;
+
+	TreeTraversal<T>::inOrder(node, [&](TreeNode<T>* currentNode, size_t)
+	{
+		if (!this->isMultiset())
+			currentNode->setCount(1);
+
+		if (this->getLog())
+		{
+			for (unsigned int i = 0; i < currentNode->getCount(); i++)
+				this->getLog()->logInsert(currentNode->getData());
+		}
+	});
+}
+
+template<typename T>
+inline void Treap<T>::logRemoveNodes(TreeNode<T>* node)
+{
+	if (!this->getLog())
+		return;
+
+	TreeTraversal<T>::inOrder(node, [&](TreeNode<T>* currentNode, size_t)
+	{
+		for (unsigned int i = 0; i < currentNode->getCount(); i++)
+			this->getLog()->logRemove(currentNode->getData());
+	});
+}
+
+template<typename T>
+inline void Treap<T>::deleteNodes(TreeNode<T>* node)
+{
+	TreeTraversal<T>::postOrder(node, [](TreeNode<T>* currentNode, size_t)
+	{
+		NodeArena<T>::destroyNode(currentNode);
+	});
+}
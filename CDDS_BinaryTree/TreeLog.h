@@ -0,0 +1,36 @@
+#pragma once
+
+template<typename T>
+class BinaryTree;
+
+/// <summary>
+/// Receives every value added to or removed from the tree it is attached to
+/// </summary>
+template<typename T>
+class TreeLog
+{
+public:
+	virtual ~TreeLog() {}
+
+	/// <summary>
+	/// Called before a value is added to the tree
+	/// </summary>
+	/// <param name="value">The value being added</param>
+	virtual void logInsert(const T& value) = 0;
+	/// <summary>
+	/// Called before a value is removed from the tree
+	/// </summary>
+	/// <param name="value">The value being removed</param>
+	virtual void logRemove(const T& value) = 0;
+	/// <summary>
+	/// Called when the tree stops using this log, because it was destroyed or another log was set in its place.
+	/// A log that keeps a pointer to its tree must drop it here
+	/// </summary>
+	virtual void detachTree() {}
+	/// <summary>
+	/// Called when the tree's nodes are moved or swapped into another tree, which takes this log along with them.
+	/// A log that keeps a pointer to its tree must point it at the new one
+	/// </summary>
+	/// <param name="tree">The tree that now holds the nodes and uses this log</param>
+	virtual void moveTree(BinaryTree<T>&) {}
+};
@@ -1,4 +1,10 @@
 #pragma once
+#include <utility>
+
+template<typename T>
+class NodeArena;
+template<typename T>
+class NodeHandle;
 
 template<typename T>
 class TreeNode
@@ -6,6 +12,12 @@ class TreeNode
 public:
 	TreeNode() {};
 	TreeNode(T value);
+	/// <summary>
+	/// Builds the data in place from the given arguments, so it is never copied or moved
+	/// </summary>
+	/// <param name="args">The arguments passed to the data's constructor</param>
+	template<typename... Args>
+	explicit TreeNode(std::in_place_t, Args&&... args);
 	~TreeNode() {};
 
 	/// <summary>
@@ -18,9 +30,21 @@ public:
 	bool hasRight();
 
 	/// <summary>
-	/// Returns the data this node contains 
+	/// Returns the data this node contains. It can't be changed in place, since that could break the order of the tree it is in
+	/// </summary>
+	const T& getData() const;
+	/// <summary>
+	/// Returns how many copies of the data this node stands for
+	/// </summary>
+	unsigned int getCount() const;
+	/// <summary>
+	/// Returns the random priority used by trees that keep their nodes in heap order
+	/// </summary>
+	unsigned int getPriority() const;
+	/// <summary>
+	/// Returns whether or not this node lives in a NodeArena instead of having been created with new
 	/// </summary>
-	T getData();
+	bool isInArena() const;
 	/// <summary>
 	/// Gets the child to the left of this node
 	/// </summary>
@@ -31,12 +55,35 @@ public:
 	/// </summary>
 	TreeNode<T>* getRight();
 
+	/// <summary>
+	/// Gets the node this node is a child of, or nullptr if it is the root
+	/// </summary>
+	TreeNode<T>* getParent();
+
 	/// <summary>
 	/// Sets the value of the data this node is storing to be the given value
 	/// </summary>
 	/// <param name="value">The value to change the data to</param>
 	void setData(T value);
 
+	/// <summary>
+	/// Sets how many copies of the data this node stands for
+	/// </summary>
+	/// <param name="count">The new number of copies</param>
+	void setCount(unsigned int count);
+
+	/// <summary>
+	/// Sets the random priority used by trees that keep their nodes in heap order
+	/// </summary>
+	/// <param name="priority">The new priority</param>
+	void setPriority(unsigned int priority);
+
+	/// <summary>
+	/// Marks whether or not this node lives in a NodeArena. Only NodeArena should need to set this
+	/// </summary>
+	/// <param name="isInArena">Whether or not the node was made in an arena</param>
+	void setInArena(bool isInArena);
+
 	/// <summary>
 	/// Sets the left child of this node to be the given node
 	/// </summary>
@@ -49,19 +96,37 @@ public:
 	/// <param name="node">The node to set as this nodes new child</param>
 	void setRight(TreeNode<T>* node);
 
-	void draw(int x, int y, bool selected = false);
+	/// <summary>
+	/// Sets the node this node is a child of. setLeft and setRight already do this for the
+	/// child they are given, so this is only needed to clear it on a node that becomes a root
+	/// </summary>
+	/// <param name="node">The new parent, or nullptr</param>
+	void setParent(TreeNode<T>* node);
 
 private:
+	//A node outside of any tree can have its data changed or moved out by whatever owns it
+	friend class NodeArena<T>;
+	friend class NodeHandle<T>;
+
 	T m_value;
+	unsigned int m_count = 1;
+	unsigned int m_priority = 0;
+	bool m_isInArena = false;
 
-	TreeNode<T>* m_left;
-	TreeNode<T>* m_right;
+	TreeNode<T>* m_left = nullptr;
+	TreeNode<T>* m_right = nullptr;
+	TreeNode<T>* m_parent = nullptr;
 };
 
 template<typename T>
-inline TreeNode<T>::TreeNode(T value)
+inline TreeNode<T>::TreeNode(T value) : m_value(std::move(value))
+{
+}
+
+template<typename T>
+template<typename... Args>
+inline TreeNode<T>::TreeNode(std::in_place_t, Args&&... args) : m_value(std::forward<Args>(args)...)
 {
-	setData(value);
 }
 
 template<typename T>
@@ -77,11 +142,29 @@ inline bool TreeNode<T>::hasRight()
 }
 
 template<typename T>
-inline T TreeNode<T>::getData()
+inline const T& TreeNode<T>::getData() const
 {
 	return m_value;
 }
 
+template<typename T>
+inline unsigned int TreeNode<T>::getCount() const
+{
+	return m_count;
+}
+
+template<typename T>
+inline unsigned int TreeNode<T>::getPriority() const
+{
+	return m_priority;
+}
+
+template<typename T>
+inline bool TreeNode<T>::isInArena() const
+{
+	return m_isInArena;
+}
+
 template<typename T>
 inline TreeNode<T>* TreeNode<T>::getLeft()
 {
@@ -94,41 +177,54 @@ inline TreeNode<T>* TreeNode<T>::getRight()
 	return m_right;
 }
 
+template<typename T>
+inline TreeNode<T>* TreeNode<T>::getParent()
+{
+	return m_parent;
+}
+
 template<typename T>
 inline void TreeNode<T>::setData(T value)
 {
-	m_value = value;
+	m_value = std::move(value);
+}
+
+template<typename T>
+inline void TreeNode<T>::setCount(unsigned int count)
+{
+	m_count = count;
+}
+
+template<typename T>
+inline void TreeNode<T>::setPriority(unsigned int priority)
+{
+	m_priority = priority;
+}
+
+template<typename T>
+inline void TreeNode<T>::setInArena(bool isInArena)
+{
+	m_isInArena = isInArena;
 }
 
 template<typename T>
 inline void TreeNode<T>::setLeft(TreeNode<T>* node)
 {
 	m_left = node;
+	if (node)
+		node->m_parent = this;
 }
 
 template<typename T>
 inline void TreeNode<T>::setRight(TreeNode<T>* node)
 {
 	m_right = node;
+	if (node)
+		node->m_parent = this;
 }
 
 template<typename T>
-inline void TreeNode<T>::draw(int x, int y, bool selected)
+inline void TreeNode<T>::setParent(TreeNode<T>* node)
 {
-	//Creates an array to stoere the string represseination of value
-	static char buffer[10];
-
-	//Converts the value a string and soteres it in the array
-	sprintf(buffer, "%d", m_value);
-
-	//Draws the circle to represnet the node
-	DrawCircle(x, y, 30, YELLOW);
-
-	//If the node is current selcevted node change its color
-	if (selected)
-		DrawCircle(x, y, 28, BLACK);
-	DrawCircle(x, y, 28, GREEN);
-
-	//Draw the value of the node inside its circle
-	DrawText(buffer, x - 12, y - 12, 12, WHITE);
+	m_parent = node;
 }
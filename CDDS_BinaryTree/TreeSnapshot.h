@@ -0,0 +1,415 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <type_traits>
+#include <vector>
+#include "BinaryTree.h"
+#include "TreeNode.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOGDI
+#define NOGDI
+#endif
+#ifndef NOUSER
+#define NOUSER
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// The first bytes of a snapshot file
+/// </summary>
+struct SnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t nodeSize;
+	uint64_t nodeCount;
+	uint64_t logPosition;
+};
+
+/// <summary>
+/// A node as it is stored in a snapshot file. Children are linked by their index in the file
+/// </summary>
+template<typename T>
+struct SnapshotNode
+{
+	T value;
+	uint32_t count;
+	uint32_t left;
+	uint32_t right;
+};
+
+/// <summary>
+/// A read-only copy of a tree stored in a file. The nodes are written in level order so the
+/// top of the tree shares the first pages, and the file is memory mapped when opened, so it can
+/// be searched right away while the rest of the file is only read from disk as it is reached
+/// </summary>
+template<typename T>
+class TreeSnapshot
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots can only store trivially copyable values");
+
+public:
+	/// <summary>
+	/// The index used for a child that doesn't exist
+	/// </summary>
+	static const uint32_t NO_NODE = 0xFFFFFFFF;
+
+	TreeSnapshot() {}
+	~TreeSnapshot();
+
+	TreeSnapshot(const TreeSnapshot<T>&) = delete;
+	TreeSnapshot<T>& operator=(const TreeSnapshot<T>&) = delete;
+
+	/// <summary>
+	/// Writes every node of the tree to the file at the given path. The records go out through a fixed size buffer,
+	/// but walking in level order queues a pointer to every node of the widest level, so the extra memory grows with
+	/// the tree: up to about half of the nodes for a balanced tree, and only a few for a long path
+	/// </summary>
+	/// <param name="tree">The tree to write</param>
+	/// <param name="path">The path of the file to create or replace</param>
+	/// <param name="logPosition">The position in a write-ahead log that the snapshot is up to date with</param>
+	/// <returns>Whether or not the whole tree could be written</returns>
+	static bool save(const BinaryTree<T>& tree, const char* path, uint64_t logPosition = 0);
+
+	/// <summary>
+	/// Maps the snapshot file at the given path into memory so it can be searched
+	/// </summary>
+	/// <param name="path">The path of the file to open</param>
+	/// <returns>Whether or not the file is a snapshot of this type that could be mapped</returns>
+	bool open(const char* path);
+	/// <summary>
+	/// Unmaps the file that is currently open
+	/// </summary>
+	void close();
+	/// <summary>
+	/// Returns whether or not a snapshot is open
+	/// </summary>
+	bool isOpen() const;
+
+	/// <summary>
+	/// Returns how many nodes are in the snapshot
+	/// </summary>
+	uint64_t getNodeCount() const;
+	/// <summary>
+	/// Returns the position in a write-ahead log that the snapshot was saved at
+	/// </summary>
+	uint64_t getLogPosition() const;
+	/// <summary>
+	/// Returns the node stored at the given index, or nullptr if the index is past the last node. The root is at index 0
+	/// </summary>
+	/// <param name="index">The index of the node</param>
+	const SnapshotNode<T>* getNode(uint32_t index) const;
+	/// <summary>
+	/// Reads every node to check that the links form a single tree, which is what save writes: the children
+	/// of each node take the next free indices in level order. A file that was damaged or written by something
+	/// else can otherwise link nodes past the end of the file, into cycles or into the same node twice.
+	/// Opening doesn't do this, since it would read the whole file before the first lookup
+	/// </summary>
+	/// <returns>Whether or not every link is where save would have put it</returns>
+	bool verify() const;
+	/// <summary>
+	/// Finds and returns the node with the given value, or nullptr if it isn't in the snapshot.
+	/// A link that points anywhere but further into the file ends the search, so a damaged file can't loop forever
+	/// </summary>
+	/// <param name="value">The value of the node to search for</param>
+	const SnapshotNode<T>* find(const T& value) const;
+	/// <summary>
+	/// Returns how many copies of the given value are in the snapshot
+	/// </summary>
+	/// <param name="value">The value to count</param>
+	unsigned int count(const T& value) const;
+
+private:
+	const SnapshotNode<T>* m_nodes = nullptr;
+	uint64_t m_nodeCount = 0;
+	uint64_t m_logPosition = 0;
+
+	void* m_mapping = nullptr;
+	size_t m_mappingSize = 0;
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mappingHandle = NULL;
+#endif
+};
+
+/// <summary>
+/// Fills in the header of a snapshot that stores the given number of nodes
+/// </summary>
+template<typename T>
+inline SnapshotHeader makeSnapshotHeader(uint64_t nodeCount, uint64_t logPosition)
+{
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "BTSNAP1", 8);
+	header.version = 1;
+	header.nodeSize = sizeof(SnapshotNode<T>);
+	header.nodeCount = nodeCount;
+	header.logPosition = logPosition;
+	return header;
+}
+
+template<typename T>
+inline TreeSnapshot<T>::~TreeSnapshot()
+{
+	close();
+}
+
+template<typename T>
+inline bool TreeSnapshot<T>::save(const BinaryTree<T>& tree, const char* path, uint64_t logPosition)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	//Writes a header now so the nodes start in the right place, the count is filled in at the end
+	SnapshotHeader header = makeSnapshotHeader<T>(0, logPosition);
+	bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1;
+
+	//Walks the tree in level order. A child's index is known as soon as it is queued,
+	//so each node can be written straight away with the indices of its children.
+	//The queue holds up to a whole level, which is the price of keeping the top of the tree on the first pages
+	std::deque<TreeNode<T>*> nodesToWrite;
+	std::vector<SnapshotNode<T>> buffer;
+	const size_t bufferSize = 4096;
+	buffer.reserve(bufferSize);
+	uint64_t nextIndex = 0;
+	uint64_t nodeCount = 0;
+
+	if (tree.getRoot())
+	{
+		nodesToWrite.push_back(tree.getRoot());
+		nextIndex = 1;
+	}
+
+	while (succeeded && !nodesToWrite.empty())
+	{
+		TreeNode<T>* currentNode = nodesToWrite.front();
+		nodesToWrite.pop_front();
+
+		SnapshotNode<T> record;
+		memset(&record, 0, sizeof(record));
+		record.value = currentNode->getData();
+		record.count = currentNode->getCount();
+		record.left = NO_NODE;
+		record.right = NO_NODE;
+
+		if (currentNode->hasLeft())
+		{
+			record.left = (uint32_t)nextIndex++;
+			nodesToWrite.push_back(currentNode->getLeft());
+		}
+		if (currentNode->hasRight())
+		{
+			record.right = (uint32_t)nextIndex++;
+			nodesToWrite.push_back(currentNode->getRight());
+		}
+
+		//Stop if the tree has more nodes than the indices can address
+		if (nextIndex > NO_NODE)
+			succeeded = false;
+
+		buffer.push_back(record);
+		nodeCount++;
+
+		//Writes the buffer once it is full
+		if (buffer.size() == bufferSize)
+		{
+			succeeded = succeeded && fwrite(buffer.data(), sizeof(SnapshotNode<T>), buffer.size(), file) == buffer.size();
+			buffer.clear();
+		}
+	}
+
+	if (succeeded && !buffer.empty())
+		succeeded = fwrite(buffer.data(), sizeof(SnapshotNode<T>), buffer.size(), file) == buffer.size();
+
+	//Goes back and writes the real node count
+	if (succeeded)
+	{
+		header = makeSnapshotHeader<T>(nodeCount, logPosition);
+		succeeded = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+	}
+
+	succeeded = fclose(file) == 0 && succeeded;
+	return succeeded;
+}
+
+template<typename T>
+inline bool TreeSnapshot<T>::open(const char* path)
+{
+	close();
+
+#ifdef _WIN32
+	m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(SnapshotHeader))
+	{
+		close();
+		return false;
+	}
+	m_mappingSize = (size_t)fileSize.QuadPart;
+
+	m_mappingHandle = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mappingHandle)
+		m_mapping = MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+	int file = ::open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileInfo;
+	if (fstat(file, &fileInfo) != 0 || fileInfo.st_size < (off_t)sizeof(SnapshotHeader))
+	{
+		::close(file);
+		return false;
+	}
+	m_mappingSize = (size_t)fileInfo.st_size;
+
+	//The mapping stays valid after the file is closed
+	m_mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED, file, 0);
+	::close(file);
+	if (m_mapping == MAP_FAILED)
+		m_mapping = nullptr;
+
+	//Lookups jump around the file, so reading ahead would only waste memory
+	if (m_mapping)
+		madvise(m_mapping, m_mappingSize, MADV_RANDOM);
+#endif
+
+	if (!m_mapping)
+	{
+		close();
+		return false;
+	}
+
+	//Checks that the file is a snapshot of this type of node and isn't cut short
+	const SnapshotHeader* header = (const SnapshotHeader*)m_mapping;
+	SnapshotHeader expected = makeSnapshotHeader<T>(header->nodeCount, header->logPosition);
+	if (memcmp(header, &expected, sizeof(SnapshotHeader)) != 0 ||
+		header->nodeCount > (m_mappingSize - sizeof(SnapshotHeader)) / sizeof(SnapshotNode<T>))
+	{
+		close();
+		return false;
+	}
+
+	m_nodeCount = header->nodeCount;
+	m_logPosition = header->logPosition;
+	m_nodes = (const SnapshotNode<T>*)((const char*)m_mapping + sizeof(SnapshotHeader));
+	return true;
+}
+
+template<typename T>
+inline void TreeSnapshot<T>::close()
+{
+#ifdef _WIN32
+	if (m_mapping)
+		UnmapViewOfFile(m_mapping);
+	if (m_mappingHandle)
+		CloseHandle(m_mappingHandle);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_mappingHandle = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_mapping)
+		munmap(m_mapping, m_mappingSize);
+#endif
+
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+	m_logPosition = 0;
+}
+
+template<typename T>
+inline bool TreeSnapshot<T>::isOpen() const
+{
+	return m_nodes != nullptr;
+}
+
+template<typename T>
+inline uint64_t TreeSnapshot<T>::getNodeCount() const
+{
+	return m_nodeCount;
+}
+
+template<typename T>
+inline uint64_t TreeSnapshot<T>::getLogPosition() const
+{
+	return m_logPosition;
+}
+
+template<typename T>
+inline const SnapshotNode<T>* TreeSnapshot<T>::getNode(uint32_t index) const
+{
+	return index < m_nodeCount ? &m_nodes[index] : nullptr;
+}
+
+template<typename T>
+inline bool TreeSnapshot<T>::verify() const
+{
+	//Every node but the root must have been given its index by a node before it
+	uint64_t nextIndex = m_nodeCount > 0 ? 1 : 0;
+	for (uint64_t i = 0; i < m_nodeCount; i++)
+	{
+		if (i > 0 && i >= nextIndex)
+			return false;
+
+		const SnapshotNode<T>& node = m_nodes[i];
+		if (node.left != NO_NODE && node.left != nextIndex++)
+			return false;
+		if (node.right != NO_NODE && node.right != nextIndex++)
+			return false;
+	}
+
+	return nextIndex == m_nodeCount;
+}
+
+template<typename T>
+inline const SnapshotNode<T>* TreeSnapshot<T>::find(const T& value) const
+{
+	uint32_t currentIndex = m_nodeCount > 0 ? 0 : NO_NODE;
+
+	//Follows the links down the tree the same way the tree itself is searched
+	while (currentIndex != NO_NODE)
+	{
+		const SnapshotNode<T>& currentNode = m_nodes[currentIndex];
+
+		uint32_t childIndex;
+		if (currentNode.value < value)
+			childIndex = currentNode.right;
+		else if (value < currentNode.value)
+			childIndex = currentNode.left;
+		else
+			return &currentNode;
+
+		//Children always come after their parent in level order, so any other link is damaged
+		if (childIndex != NO_NODE && (childIndex <= currentIndex || childIndex >= m_nodeCount))
+			return nullptr;
+		currentIndex = childIndex;
+	}
+
+	return nullptr;
+}
+
+template<typename T>
+inline unsigned int TreeSnapshot<T>::count(const T& value) const
+{
+	const SnapshotNode<T>* node = find(value);
+	return node ? node->count : 0;
+}
@@ -0,0 +1,443 @@
+#pragma once
+
+//Counters for the work the trees do, which are only compiled in when BINARYTREE_STATS is defined.
+//Without it every TREE_STATS macro expands to an empty statement, or to the bare comparison for TREE_STATS_COMPARE,
+//so the trees are exactly as fast as if the counters weren't there
+
+#ifdef BINARYTREE_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// The operations whose comparisons, visited nodes and latency are counted separately
+/// </summary>
+enum class TreeOperation
+{
+	Insert,
+	Find,
+	Remove
+};
+
+/// <summary>
+/// Counts how many times took each length of time, keeping 16 buckets for every power of two so each
+/// bucket is within about 6% of the times it holds, from one nanosecond up to several hours
+/// </summary>
+class LatencyHistogram
+{
+public:
+	static constexpr size_t SUB_BUCKET_BITS = 4;
+	static constexpr size_t SUB_BUCKET_COUNT = (size_t)1 << SUB_BUCKET_BITS;
+	static constexpr size_t LARGEST_POWER = 44;
+	static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + (LARGEST_POWER - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+	/// <summary>
+	/// Returns the bucket that counts the given time
+	/// </summary>
+	/// <param name="nanoseconds">The time to count</param>
+	static size_t getBucket(uint64_t nanoseconds);
+	/// <summary>
+	/// Returns the longest time the bucket counts
+	/// </summary>
+	/// <param name="bucket">The bucket to get the time of</param>
+	static uint64_t getBucketLimit(size_t bucket);
+
+	/// <summary>
+	/// Counts a time
+	/// </summary>
+	/// <param name="nanoseconds">How long something took</param>
+	void record(uint64_t nanoseconds);
+	/// <summary>
+	/// Adds times that were counted somewhere else
+	/// </summary>
+	/// <param name="bucketCounts">How many times fell in each bucket</param>
+	/// <param name="totalNanoseconds">The sum of the times being added</param>
+	void add(const std::vector<uint64_t>& bucketCounts, uint64_t totalNanoseconds);
+
+	/// <summary>
+	/// Returns the number of times counted
+	/// </summary>
+	uint64_t getCount() const;
+	/// <summary>
+	/// Returns the average time, or 0 if nothing was counted
+	/// </summary>
+	double getMean() const;
+	/// <summary>
+	/// Returns a time that the given fraction of the counted times were no longer than
+	/// </summary>
+	/// <param name="fraction">The fraction of times, such as 0.99 for the 99th percentile</param>
+	uint64_t getPercentile(double fraction) const;
+
+private:
+	std::vector<uint64_t> m_buckets = std::vector<uint64_t>(BUCKET_COUNT, 0);
+	uint64_t m_count = 0;
+	uint64_t m_totalNanoseconds = 0;
+};
+
+/// <summary>
+/// The counts for one kind of operation
+/// </summary>
+struct TreeOperationStats
+{
+	uint64_t count = 0;
+	uint64_t comparisons = 0;
+	uint64_t nodesVisited = 0;
+	LatencyHistogram latency;
+};
+
+/// <summary>
+/// The counts of every thread added together
+/// </summary>
+struct TreeStatsReport
+{
+	TreeOperationStats operations[3];
+	uint64_t rotations = 0;
+	uint64_t allocations = 0;
+	uint64_t frees = 0;
+
+	/// <summary>
+	/// Returns the counts for one kind of operation
+	/// </summary>
+	const TreeOperationStats& get(TreeOperation operation) const { return operations[(size_t)operation]; }
+};
+
+/// <summary>
+/// Where the trees count their work. Each thread counts into its own counters, so counting never waits on a lock,
+/// and read adds the counters of every thread together, including threads that have already finished.
+/// Comparisons and visited nodes are only counted while an operation is running on the thread, and an
+/// operation that starts inside another one is counted as part of the outer one
+/// </summary>
+class TreeStats
+{
+public:
+	/// <summary>
+	/// Times an operation for as long as it exists, and has the comparisons and visited nodes counted against it
+	/// </summary>
+	class OperationScope
+	{
+	public:
+		explicit OperationScope(TreeOperation operation);
+		~OperationScope();
+
+		OperationScope(const OperationScope&) = delete;
+		OperationScope& operator=(const OperationScope&) = delete;
+
+	private:
+		bool m_isOutermost = false;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	/// <summary>
+	/// Adds the counters of every thread together
+	/// </summary>
+	static TreeStatsReport read();
+	/// <summary>
+	/// Sets every counter back to 0. Counts made by other threads at the same time may be lost
+	/// </summary>
+	static void reset();
+
+	static void countComparison();
+	static void countVisit();
+	static void countRotation();
+	static void countAllocation();
+	static void countFree();
+
+private:
+	static constexpr size_t OPERATION_COUNT = 3;
+
+	/// <summary>
+	/// The counters of one thread. Only the thread itself adds to them, so they don't need atomic adds,
+	/// but they are atomic so that other threads can read them while they change
+	/// </summary>
+	struct ThreadCounters
+	{
+		ThreadCounters();
+		~ThreadCounters();
+
+		std::atomic<uint64_t> operationCounts[OPERATION_COUNT];
+		std::atomic<uint64_t> comparisons[OPERATION_COUNT];
+		std::atomic<uint64_t> nodesVisited[OPERATION_COUNT];
+		std::atomic<uint64_t> totalNanoseconds[OPERATION_COUNT];
+		std::atomic<uint64_t> latencyBuckets[OPERATION_COUNT][LatencyHistogram::BUCKET_COUNT];
+		std::atomic<uint64_t> rotations;
+		std::atomic<uint64_t> allocations;
+		std::atomic<uint64_t> frees;
+
+		//The operation running on the thread, or -1 if there isn't one
+		int currentOperation = -1;
+	};
+
+	/// <summary>
+	/// Every thread that has counted something, and the counts of the threads that have finished
+	/// </summary>
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<ThreadCounters*> threads;
+		TreeStatsReport finishedThreads;
+	};
+
+	static ThreadCounters& getThreadCounters();
+	static Registry& getRegistry();
+	static void increment(std::atomic<uint64_t>& counter, uint64_t amount = 1);
+	static void addTo(TreeStatsReport& report, const ThreadCounters& counters);
+};
+
+inline size_t LatencyHistogram::getBucket(uint64_t nanoseconds)
+{
+	//Small times get a bucket each
+	if (nanoseconds < SUB_BUCKET_COUNT)
+		return (size_t)nanoseconds;
+
+	//Larger times are sorted by their highest bit, then by the bits just below it
+	size_t power = SUB_BUCKET_BITS;
+	while (power < 63 && (nanoseconds >> (power + 1)) != 0)
+		power++;
+	if (power > LARGEST_POWER)
+		return BUCKET_COUNT - 1;
+
+	size_t subBucket = (size_t)(nanoseconds >> (power - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+	return SUB_BUCKET_COUNT + (power - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT + subBucket;
+}
+
+inline uint64_t LatencyHistogram::getBucketLimit(size_t bucket)
+{
+	if (bucket < SUB_BUCKET_COUNT)
+		return bucket;
+
+	size_t power = (bucket - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT + SUB_BUCKET_BITS;
+	size_t subBucket = (bucket - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT;
+	uint64_t bucketWidth = (uint64_t)1 << (power - SUB_BUCKET_BITS);
+	return (SUB_BUCKET_COUNT + subBucket) * bucketWidth + bucketWidth - 1;
+}
+
+inline void LatencyHistogram::record(uint64_t nanoseconds)
+{
+	m_buckets[getBucket(nanoseconds)]++;
+	m_count++;
+	m_totalNanoseconds += nanoseconds;
+}
+
+inline void LatencyHistogram::add(const std::vector<uint64_t>& bucketCounts, uint64_t totalNanoseconds)
+{
+	for (size_t bucket = 0; bucket < BUCKET_COUNT && bucket < bucketCounts.size(); bucket++)
+	{
+		m_buckets[bucket] += bucketCounts[bucket];
+		m_count += bucketCounts[bucket];
+	}
+	m_totalNanoseconds += totalNanoseconds;
+}
+
+inline uint64_t LatencyHistogram::getCount() const
+{
+	return m_count;
+}
+
+inline double LatencyHistogram::getMean() const
+{
+	return m_count == 0 ? 0.0 : (double)m_totalNanoseconds / (double)m_count;
+}
+
+inline uint64_t LatencyHistogram::getPercentile(double fraction) const
+{
+	if (m_count == 0)
+		return 0;
+
+	//Finds the first bucket that brings the running count up to the fraction
+	uint64_t target = (uint64_t)(fraction * (double)m_count);
+	if (target < 1)
+		target = 1;
+
+	uint64_t runningCount = 0;
+	for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+	{
+		runningCount += m_buckets[bucket];
+		if (runningCount >= target)
+			return getBucketLimit(bucket);
+	}
+	return getBucketLimit(BUCKET_COUNT - 1);
+}
+
+inline TreeStats::OperationScope::OperationScope(TreeOperation operation)
+{
+	ThreadCounters& counters = getThreadCounters();
+	if (counters.currentOperation >= 0)
+		return;
+
+	m_isOutermost = true;
+	counters.currentOperation = (int)operation;
+	increment(counters.operationCounts[(size_t)operation]);
+	m_start = std::chrono::steady_clock::now();
+}
+
+inline TreeStats::OperationScope::~OperationScope()
+{
+	if (!m_isOutermost)
+		return;
+
+	uint64_t nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+	ThreadCounters& counters = getThreadCounters();
+	size_t operation = (size_t)counters.currentOperation;
+	increment(counters.latencyBuckets[operation][LatencyHistogram::getBucket(nanoseconds)]);
+	increment(counters.totalNanoseconds[operation], nanoseconds);
+	counters.currentOperation = -1;
+}
+
+inline TreeStatsReport TreeStats::read()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	TreeStatsReport report = registry.finishedThreads;
+	for (const ThreadCounters* counters : registry.threads)
+		addTo(report, *counters);
+	return report;
+}
+
+inline void TreeStats::reset()
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	registry.finishedThreads = TreeStatsReport();
+	for (ThreadCounters* counters : registry.threads)
+	{
+		for (size_t operation = 0; operation < OPERATION_COUNT; operation++)
+		{
+			counters->operationCounts[operation].store(0, std::memory_order_relaxed);
+			counters->comparisons[operation].store(0, std::memory_order_relaxed);
+			counters->nodesVisited[operation].store(0, std::memory_order_relaxed);
+			counters->totalNanoseconds[operation].store(0, std::memory_order_relaxed);
+			for (std::atomic<uint64_t>& bucket : counters->latencyBuckets[operation])
+				bucket.store(0, std::memory_order_relaxed);
+		}
+		counters->rotations.store(0, std::memory_order_relaxed);
+		counters->allocations.store(0, std::memory_order_relaxed);
+		counters->frees.store(0, std::memory_order_relaxed);
+	}
+}
+
+inline void TreeStats::countComparison()
+{
+	ThreadCounters& counters = getThreadCounters();
+	if (counters.currentOperation >= 0)
+		increment(counters.comparisons[counters.currentOperation]);
+}
+
+inline void TreeStats::countVisit()
+{
+	ThreadCounters& counters = getThreadCounters();
+	if (counters.currentOperation >= 0)
+		increment(counters.nodesVisited[counters.currentOperation]);
+}
+
+inline void TreeStats::countRotation()
+{
+	increment(getThreadCounters().rotations);
+}
+
+inline void TreeStats::countAllocation()
+{
+	increment(getThreadCounters().allocations);
+}
+
+inline void TreeStats::countFree()
+{
+	increment(getThreadCounters().frees);
+}
+
+inline TreeStats::ThreadCounters::ThreadCounters()
+{
+	for (size_t operation = 0; operation < OPERATION_COUNT; operation++)
+	{
+		operationCounts[operation].store(0, std::memory_order_relaxed);
+		comparisons[operation].store(0, std::memory_order_relaxed);
+		nodesVisited[operation].store(0, std::memory_order_relaxed);
+		totalNanoseconds[operation].store(0, std::memory_order_relaxed);
+		for (std::atomic<uint64_t>& bucket : latencyBuckets[operation])
+			bucket.store(0, std::memory_order_relaxed);
+	}
+	rotations.store(0, std::memory_order_relaxed);
+	allocations.store(0, std::memory_order_relaxed);
+	frees.store(0, std::memory_order_relaxed);
+
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back(this);
+}
+
+inline TreeStats::ThreadCounters::~ThreadCounters()
+{
+	//The thread's counts are kept after it finishes
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	addTo(registry.finishedThreads, *this);
+	for (size_t i = 0; i < registry.threads.size(); i++)
+	{
+		if (registry.threads[i] == this)
+		{
+			registry.threads[i] = registry.threads.back();
+			registry.threads.pop_back();
+			break;
+		}
+	}
+}
+
+inline TreeStats::ThreadCounters& TreeStats::getThreadCounters()
+{
+	static thread_local ThreadCounters counters;
+	return counters;
+}
+
+inline TreeStats::Registry& TreeStats::getRegistry()
+{
+	static Registry registry;
+	return registry;
+}
+
+inline void TreeStats::increment(std::atomic<uint64_t>& counter, uint64_t amount)
+{
+	//Only the owning thread writes, so a plain load and store is enough and is cheaper than an atomic add
+	counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void TreeStats::addTo(TreeStatsReport& report, const ThreadCounters& counters)
+{
+	for (size_t operation = 0; operation < OPERATION_COUNT; operation++)
+	{
+		TreeOperationStats& stats = report.operations[operation];
+		stats.count += counters.operationCounts[operation].load(std::memory_order_relaxed);
+		stats.comparisons += counters.comparisons[operation].load(std::memory_order_relaxed);
+		stats.nodesVisited += counters.nodesVisited[operation].load(std::memory_order_relaxed);
+
+		std::vector<uint64_t> bucketCounts(LatencyHistogram::BUCKET_COUNT);
+		for (size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; bucket++)
+			bucketCounts[bucket] = counters.latencyBuckets[operation][bucket].load(std::memory_order_relaxed);
+		stats.latency.add(bucketCounts, counters.totalNanoseconds[operation].load(std::memory_order_relaxed));
+	}
+	report.rotations += counters.rotations.load(std::memory_order_relaxed);
+	report.allocations += counters.allocations.load(std::memory_order_relaxed);
+	report.frees += counters.frees.load(std::memory_order_relaxed);
+}
+
+#define TREE_STATS_OPERATION(operation) TreeStats::OperationScope treeStatsScope(operation)
+#define TREE_STATS_COMPARE(comparison) (TreeStats::countComparison(), (comparison))
+#define TREE_STATS_VISIT() TreeStats::countVisit()
+#define TREE_STATS_ROTATION() TreeStats::countRotation()
+#define TREE_STATS_ALLOCATION() TreeStats::countAllocation()
+#define TREE_STATS_FREE() TreeStats::countFree()
+
+#else
+
+#define TREE_STATS_OPERATION(operation) ((void)0)
+#define TREE_STATS_COMPARE(comparison) (comparison)
+#define TREE_STATS_VISIT() ((void)0)
+#define TREE_STATS_ROTATION() ((void)0)
+#define TREE_STATS_ALLOCATION() ((void)0)
+#define TREE_STATS_FREE() ((void)0)
+
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+template<typename T>
+class TreeNode;
+
+/// <summary>
+/// Walks every node of a subtree without recursion, so even a tree that has degenerated into a
+/// long list can be walked without running out of stack. Pre-order, in-order and post-order step
+/// between nodes by following child and parent links, so they don't allocate anything.
+/// The visitor is called with each node and its depth, the root being at depth 0.
+/// The visitor must not relink the tree while it is being walked
+/// </summary>
+template<typename T>
+class TreeTraversal
+{
+public:
+	/// <summary>
+	/// Visits every node before the nodes below it, left subtree first
+	/// </summary>
+	/// <param name="root">The top of the subtree to walk</param>
+	/// <param name="visitor">Called with every node and its depth</param>
+	template<typename Visitor>
+	static void preOrder(TreeNode<T>* root, Visitor&& visitor);
+	/// <summary>
+	/// Visits every node from the smallest value to the largest
+	/// </summary>
+	/// <param name="root">The top of the subtree to walk</param>
+	/// <param name="visitor">Called with every node and its depth</param>
+	template<typename Visitor>
+	static void inOrder(TreeNode<T>* root, Visitor&& visitor);
+	/// <summary>
+	/// Visits every node after the nodes below it, left subtree first.
+	/// The next node is found before each visit, so the visitor may delete the node it is given
+	/// </summary>
+	/// <param name="root">The top of the subtree to walk</param>
+	/// <param name="visitor">Called with every node and its depth</param>
+	template<typename Visitor>
+	static void postOrder(TreeNode<T>* root, Visitor&& visitor);
+	/// <summary>
+	/// Visits every node one level at a time from the top, each level from left to right.
+	/// This is the only walk that allocates, keeping a queue as wide as the widest level
+	/// </summary>
+	/// <param name="root">The top of the subtree to walk</param>
+	/// <param name="visitor">Called with every node and its depth</param>
+	template<typename Visitor>
+	static void levelOrder(TreeNode<T>* root, Visitor&& visitor);
+
+private:
+	/// <summary>
+	/// Goes down from the node to the first node a post-order walk visits, preferring left children
+	/// </summary>
+	/// <param name="node">The node to start from</param>
+	/// <param name="depth">The depth of the node, which is updated to the depth of the node returned</param>
+	static TreeNode<T>* findFirstPostOrder(TreeNode<T>* node, size_t& depth);
+};
+
+template<typename T>
+template<typename Visitor>
+inline void TreeTraversal<T>::preOrder(TreeNode<T>* root, Visitor&& visitor)
+{
+	TreeNode<T>* currentNode = root;
+	size_t depth = 0;
+
+	while (currentNode)
+	{
+		visitor(currentNode, depth);
+
+		//Goes down to the first child if there is one
+		if (currentNode->hasLeft() || currentNode->hasRight())
+		{
+			currentNode = currentNode->hasLeft() ? currentNode->getLeft() : currentNode->getRight();
+			depth++;
+			continue;
+		}
+
+		//Otherwise climbs until reaching a parent whose right subtree hasn't been visited yet
+		TreeNode<T>* nextNode = nullptr;
+		while (currentNode != root)
+		{
+			TreeNode<T>* parentNode = currentNode->getParent();
+			if (parentNode->getLeft() == currentNode && parentNode->hasRight())
+			{
+				nextNode = parentNode->getRight();
+				break;
+			}
+
+			currentNode = parentNode;
+			depth--;
+		}
+		currentNode = nextNode;
+	}
+}
+
+template<typename T>
+template<typename Visitor>
+inline void TreeTraversal<T>::inOrder(TreeNode<T>* root, Visitor&& visitor)
+{
+	TreeNode<T>* currentNode = root;
+	size_t depth = 0;
+
+	//Starts at the smallest value
+	while (currentNode && currentNode->hasLeft())
+	{
+		currentNode = currentNode->getLeft();
+		depth++;
+	}
+
+	while (currentNode)
+	{
+		visitor(currentNode, depth);
+
+		//The next value is the smallest one in the right subtree if there is one
+		if (currentNode->hasRight())
+		{
+			currentNode = currentNode->getRight();
+			depth++;
+			while (currentNode->hasLeft())
+			{
+				currentNode = currentNode->getLeft();
+				depth++;
+			}
+			continue;
+		}
+
+		//Otherwise it is the first parent reached from its left side
+		TreeNode<T>* nextNode = nullptr;
+		while (currentNode != root)
+		{
+			TreeNode<T>* parentNode = currentNode->getParent();
+			depth--;
+			if (parentNode->getLeft() == currentNode)
+			{
+				nextNode = parentNode;
+				break;
+			}
+			currentNode = parentNode;
+		}
+		currentNode = nextNode;
+	}
+}
+
+template<typename T>
+template<typename Visitor>
+inline void TreeTraversal<T>::postOrder(TreeNode<T>* root, Visitor&& visitor)
+{
+	size_t depth = 0;
+	TreeNode<T>* currentNode = root ? findFirstPostOrder(root, depth) : nullptr;
+
+	while (currentNode)
+	{
+		//Works out where to go next before the visitor sees the node
+		TreeNode<T>* nextNode = nullptr;
+		size_t nextDepth = 0;
+		if (currentNode != root)
+		{
+			TreeNode<T>* parentNode = currentNode->getParent();
+
+			//After a left subtree comes the parent's right subtree, and after that the parent itself
+			if (parentNode->getLeft() == currentNode && parentNode->hasRight())
+			{
+				nextDepth = depth;
+				nextNode = findFirstPostOrder(parentNode->getRight(), nextDepth);
+			}
+			else
+			{
+				nextNode = parentNode;
+				nextDepth = depth - 1;
+			}
+		}
+
+		visitor(currentNode, depth);
+		currentNode = nextNode;
+		depth = nextDepth;
+	}
+}
+
+template<typename T>
+template<typename Visitor>
+inline void TreeTraversal<T>::levelOrder(TreeNode<T>* root, Visitor&& visitor)
+{
+	if (!root)
+		return;
+
+	//Keeps the nodes of one level while the nodes of the next level are gathered
+	std::vector<TreeNode<T>*> levelNodes;
+	std::vector<TreeNode<T>*> nextLevelNodes;
+	levelNodes.push_back(root);
+	size_t depth = 0;
+
+	while (!levelNodes.empty())
+	{
+		for (TreeNode<T>* node : levelNodes)
+		{
+			visitor(node, depth);
+			if (node->hasLeft())
+				nextLevelNodes.push_back(node->getLeft());
+			if (node->hasRight())
+				nextLevelNodes.push_back(node->getRight());
+		}
+
+		levelNodes.swap(nextLevelNodes);
+		nextLevelNodes.clear();
+		depth++;
+	}
+}
+
+template<typename T>
+inline TreeNode<T>* TreeTraversal<T>::findFirstPostOrder(TreeNode<T>* node, size_t& depth)
+{
+	while (node->hasLeft() || node->hasRight())
+	{
+		node = node->hasLeft() ? node->getLeft() : node->getRight();
+		depth++;
+	}
+	return node;
+}
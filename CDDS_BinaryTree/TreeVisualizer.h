@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include "raylib.h"
+#include "BinaryTree.h"
+#include "TreeNode.h"
+#include "TreeTraversal.h"
+
+/// <summary>
+/// Draws a tree with raylib. The tree only offers its root and the traversals, so the container
+/// itself doesn't depend on any graphics library and only programs that draw include this
+/// </summary>
+template<typename T>
+class TreeVisualizer
+{
+public:
+	/// <summary>
+	/// Draws every node and the lines between them, highlighting the selected node
+	/// </summary>
+	/// <param name="tree">The tree to draw</param>
+	/// <param name="selected">The node to highlight, or nullptr</param>
+	static void draw(const BinaryTree<T>& tree, TreeNode<T>* selected = nullptr);
+	/// <summary>
+	/// Draws a single node as a circle with its value inside
+	/// </summary>
+	/// <param name="node">The node to draw</param>
+	/// <param name="x">The horizontal centre of the circle</param>
+	/// <param name="y">The vertical centre of the circle</param>
+	/// <param name="selected">Whether or not to highlight the node</param>
+	static void drawNode(TreeNode<T>* node, int x, int y, bool selected = false);
+};
+
+template<typename T>
+inline void TreeVisualizer<T>::draw(const BinaryTree<T>& tree, TreeNode<T>* selected)
+{
+	//Below this depth the nodes are drawn on top of their parents, so their positions don't need to be kept
+	const size_t depthLimit = 16;
+	int xByDepth[depthLimit];
+	TreeNode<T>* nodeByDepth[depthLimit];
+
+	//Draws every line first and every node second so no line is drawn over a node
+	for (int pass = 0; pass < 2; pass++)
+	{
+		TreeTraversal<T>::preOrder(tree.getRoot(), [&](TreeNode<T>* node, size_t depth)
+		{
+			int x = 400;
+			int y = 40 + 80 * (int)depth;
+
+			//The parent is the last node visited one level up, and the spacing halves on every level
+			if (depth > 0)
+			{
+				size_t parentDepth = std::min(depth - 1, depthLimit - 1);
+				int horizontalSpacing = depth < depthLimit ? 400 >> depth : 0;
+				if (node->getData() < nodeByDepth[parentDepth]->getData())
+					x = xByDepth[parentDepth] - horizontalSpacing;
+				else
+					x = xByDepth[parentDepth] + horizontalSpacing;
+
+				if (pass == 0)
+					DrawLine(xByDepth[parentDepth], y - 80, x, y, RED);
+			}
+
+			if (depth < depthLimit)
+			{
+				xByDepth[depth] = x;
+				nodeByDepth[depth] = node;
+			}
+
+			if (pass == 1)
+				drawNode(node, x, y, (selected == node));
+		});
+	}
+}
+
+template<typename T>
+inline void TreeVisualizer<T>::drawNode(TreeNode<T>* node, int x, int y, bool selected)
+{
+	//Converts the value to a string, which is long enough for any int
+	char buffer[12];
+	snprintf(buffer, sizeof(buffer), "%d", (int)node->getData());
+
+	//Draws the circle to represent the node
+	DrawCircle(x, y, 30, YELLOW);
+
+	//If the node is the current selected node change its color
+	if (selected)
+		DrawCircle(x, y, 28, BLACK);
+	DrawCircle(x, y, 28, GREEN);
+
+	//Draw the value of the node inside its circle
+	DrawText(buffer, x - 12, y - 12, 12, WHITE);
+}
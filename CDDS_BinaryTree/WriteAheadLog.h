@@ -0,0 +1,443 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "BinaryTree.h"
+#include "TreeLog.h"
+#include "TreeNode.h"
+#include "TreeSnapshot.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// A single change as it is stored in the log file
+/// </summary>
+template<typename T>
+struct LogRecord
+{
+	uint64_t position;
+	uint32_t operation;
+	uint32_t checksum;
+	T value;
+};
+
+/// <summary>
+/// Makes a tree survive restarts. Every insert and remove is written to a log file, and the
+/// log is replayed on top of the latest snapshot when the tree is opened again.
+/// Changes are written in groups so one flush to disk covers many of them
+/// </summary>
+template<typename T>
+class WriteAheadLog : public TreeLog<T>
+{
+	static_assert(std::is_trivially_copyable<T>::value, "The log can only store trivially copyable values");
+
+public:
+	enum Operation
+	{
+		INSERT = 1,
+		REMOVE = 2
+	};
+
+	WriteAheadLog() {}
+	~WriteAheadLog();
+
+	WriteAheadLog(const WriteAheadLog<T>&) = delete;
+	WriteAheadLog<T>& operator=(const WriteAheadLog<T>&) = delete;
+
+	/// <summary>
+	/// Restores the tree from the snapshot and the changes logged after it, then attaches
+	/// this log to the tree. A change that was only partly written when the process stopped is cut off the file.
+	/// The values go through the tree's own bulkLoad, insert and remove, so a tree that places its nodes its own way is rebuilt the same way.
+	/// The tree must either outlive the log or be destroyed first, which detaches the log
+	/// </summary>
+	/// <param name="tree">The tree to restore, which should be empty</param>
+	/// <param name="snapshotPath">The path of the snapshot file</param>
+	/// <param name="logPath">The path of the log file</param>
+	/// <returns>Whether or not the snapshot, if there is one, could be read, a partly written change cut off and the log file opened for writing</returns>
+	template<typename Tree>
+	bool open(Tree& tree, const char* snapshotPath, const char* logPath);
+	/// <summary>
+	/// Writes any waiting changes, detaches from the tree and closes the log file
+	/// </summary>
+	void close();
+
+	/// <summary>
+	/// Sets how many changes are gathered before they are written and flushed to disk together
+	/// </summary>
+	/// <param name="groupSize">The number of changes in a group</param>
+	void setGroupSize(unsigned int groupSize);
+	/// <summary>
+	/// Returns the position of the last change that was logged
+	/// </summary>
+	uint64_t getPosition() const;
+
+	/// <summary>
+	/// Writes the waiting changes to the log file and flushes it to disk
+	/// </summary>
+	/// <returns>Whether or not the changes reached the disk</returns>
+	bool commit();
+	/// <summary>
+	/// Saves a snapshot of the tree and empties the log, so the next restart only replays what comes after it.
+	/// The log is only emptied once the new snapshot is known to be on disk under its final name
+	/// </summary>
+	/// <returns>Whether or not the snapshot was saved and the log emptied. A log whose tree is gone can't checkpoint</returns>
+	bool checkpoint();
+
+	void logInsert(const T& value) override;
+	void logRemove(const T& value) override;
+	/// <summary>
+	/// Forgets the tree, which stopped using this log. Changes already logged can still be committed
+	/// </summary>
+	void detachTree() override;
+	/// <summary>
+	/// Follows the tree's nodes into the tree they were moved to, so checkpoints save that tree
+	/// </summary>
+	void moveTree(BinaryTree<T>& tree) override;
+
+private:
+	/// <summary>
+	/// Adds a change to the group waiting to be written
+	/// </summary>
+	void append(Operation operation, const T& value);
+	/// <summary>
+	/// Reads the log file and applies every complete change after the snapshot to the tree
+	/// </summary>
+	/// <returns>The number of bytes at the start of the file that hold complete changes</returns>
+	template<typename Tree>
+	uint64_t replay(Tree& tree, uint64_t snapshotPosition);
+	/// <summary>
+	/// Applies a logged change through the tree's own insert or remove. Trees whose insert and remove take
+	/// something else, such as the ends of an interval, store their values the way the base tree does
+	/// </summary>
+	template<typename Tree>
+	static auto replayInsert(Tree& tree, const T& value, int) -> decltype(tree.insert(value), void()) { tree.insert(value); }
+	template<typename Tree>
+	static void replayInsert(Tree& tree, const T& value, long) { tree.BinaryTree<T>::insert(value); }
+	template<typename Tree>
+	static auto replayRemove(Tree& tree, const T& value, int) -> decltype(tree.remove(value), void()) { tree.remove(value); }
+	template<typename Tree>
+	static void replayRemove(Tree& tree, const T& value, long) { tree.BinaryTree<T>::remove(value); }
+
+	/// <summary>
+	/// Returns the checksum of a record, not counting its checksum field
+	/// </summary>
+	static uint32_t checksum(LogRecord<T> record);
+	/// <summary>
+	/// Flushes the file and waits for the operating system to write it to disk
+	/// </summary>
+	static bool syncFile(FILE* file);
+	/// <summary>
+	/// Waits for the operating system to write the directory holding the file to disk, so a rename into it is kept
+	/// </summary>
+	static bool syncDirectory(const std::string& path);
+
+	BinaryTree<T>* m_tree = nullptr;
+	FILE* m_file = nullptr;
+	std::string m_snapshotPath;
+	std::string m_logPath;
+
+	std::vector<LogRecord<T>> m_pendingRecords;
+	unsigned int m_groupSize = 64;
+	uint64_t m_position = 0;
+};
+
+template<typename T>
+inline WriteAheadLog<T>::~WriteAheadLog()
+{
+	close();
+}
+
+template<typename T>
+template<typename Tree>
+inline bool WriteAheadLog<T>::open(Tree& tree, const char* snapshotPath, const char* logPath)
+{
+	static_assert(std::is_base_of<BinaryTree<T>, Tree>::value, "The log can only restore a tree of the values it stores");
+
+	close();
+	m_snapshotPath = snapshotPath;
+	m_logPath = logPath;
+	m_position = 0;
+
+	//Detaches any log while restoring so the restored changes aren't logged again
+	tree.setLog(nullptr);
+
+	//Loads the snapshot, walking its nodes in order so the tree can be bulk loaded. Every node is read
+	//anyway, so the links are checked first and a damaged snapshot is never followed
+	TreeSnapshot<T> snapshot;
+	std::error_code error;
+	if (std::filesystem::exists(m_snapshotPath, error))
+	{
+		//Replaying the log without the snapshot it follows would silently lose everything before it
+		if (!snapshot.open(snapshotPath) || !snapshot.verify())
+			return false;
+
+		std::vector<T> values;
+		std::vector<uint32_t> pendingIndices;
+		uint32_t currentIndex = snapshot.getNodeCount() > 0 ? 0 : TreeSnapshot<T>::NO_NODE;
+
+		while (currentIndex != TreeSnapshot<T>::NO_NODE || !pendingIndices.empty())
+		{
+			while (currentIndex != TreeSnapshot<T>::NO_NODE)
+			{
+				pendingIndices.push_back(currentIndex);
+				currentIndex = snapshot.getNode(currentIndex)->left;
+			}
+
+			const SnapshotNode<T>& node = *snapshot.getNode(pendingIndices.back());
+			pendingIndices.pop_back();
+			for (uint32_t i = 0; i < node.count; i++)
+				values.push_back(node.value);
+			currentIndex = node.right;
+		}
+
+		tree.bulkLoad(values);
+		m_position = snapshot.getLogPosition();
+	}
+
+	//Replays the changes made since the snapshot and cuts off a change that was only partly written
+	m_tree = &tree;
+	uint64_t validBytes = replay(tree, m_position);
+	if (std::filesystem::exists(m_logPath, error) && std::filesystem::file_size(m_logPath, error) > validBytes)
+	{
+		//New changes appended after a torn one would be dropped by the next replay along with it
+		std::filesystem::resize_file(m_logPath, validBytes, error);
+		if (error)
+		{
+			m_tree = nullptr;
+			return false;
+		}
+	}
+
+	m_file = fopen(logPath, "ab");
+	if (!m_file)
+	{
+		m_tree = nullptr;
+		return false;
+	}
+
+	tree.setLog(this);
+	return true;
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::close()
+{
+	if (m_file)
+	{
+		commit();
+		fclose(m_file);
+		m_file = nullptr;
+	}
+
+	if (m_tree && m_tree->getLog() == this)
+		m_tree->setLog(nullptr);
+	m_tree = nullptr;
+	m_pendingRecords.clear();
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::setGroupSize(unsigned int groupSize)
+{
+	m_groupSize = groupSize > 0 ? groupSize : 1;
+}
+
+template<typename T>
+inline uint64_t WriteAheadLog<T>::getPosition() const
+{
+	return m_position;
+}
+
+template<typename T>
+inline bool WriteAheadLog<T>::commit()
+{
+	if (!m_file)
+		return false;
+	if (m_pendingRecords.empty())
+		return true;
+
+	//Writes the whole group at once and pays for a single flush to disk
+	bool succeeded = fwrite(m_pendingRecords.data(), sizeof(LogRecord<T>), m_pendingRecords.size(), m_file) == m_pendingRecords.size();
+	succeeded = syncFile(m_file) && succeeded;
+	m_pendingRecords.clear();
+	return succeeded;
+}
+
+template<typename T>
+inline bool WriteAheadLog<T>::checkpoint()
+{
+	if (!m_file || !m_tree || !commit())
+		return false;
+
+	//Writes the snapshot next to the old one and flushes it before replacing the old one,
+	//so there is always a complete snapshot on disk
+	std::string temporaryPath = m_snapshotPath + ".tmp";
+	if (!TreeSnapshot<T>::save(*m_tree, temporaryPath.c_str(), m_position))
+		return false;
+
+	FILE* snapshotFile = fopen(temporaryPath.c_str(), "r+b");
+	bool succeeded = snapshotFile && syncFile(snapshotFile);
+	if (snapshotFile)
+		fclose(snapshotFile);
+
+	std::error_code error;
+	if (succeeded)
+		std::filesystem::rename(temporaryPath, m_snapshotPath, error);
+	if (!succeeded || error)
+		return false;
+
+	//Until the rename itself is on disk, a crash can bring back the old snapshot, which needs the whole log
+	if (!syncDirectory(m_snapshotPath))
+		return false;
+
+	//Empties the log. If the process stops before this, the changes up to the snapshot's position are skipped on replay
+	fclose(m_file);
+	m_file = fopen(m_logPath.c_str(), "wb");
+	return m_file && syncFile(m_file);
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::logInsert(const T& value)
+{
+	append(INSERT, value);
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::logRemove(const T& value)
+{
+	append(REMOVE, value);
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::moveTree(BinaryTree<T>& tree)
+{
+	m_tree = &tree;
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::detachTree()
+{
+	m_tree = nullptr;
+}
+
+template<typename T>
+inline void WriteAheadLog<T>::append(Operation operation, const T& value)
+{
+	LogRecord<T> record;
+	memset(&record, 0, sizeof(record));
+	record.position = ++m_position;
+	record.operation = operation;
+	record.value = value;
+	record.checksum = checksum(record);
+	m_pendingRecords.push_back(record);
+
+	if (m_pendingRecords.size() >= m_groupSize)
+		commit();
+}
+
+template<typename T>
+template<typename Tree>
+inline uint64_t WriteAheadLog<T>::replay(Tree& tree, uint64_t snapshotPosition)
+{
+	FILE* file = fopen(m_logPath.c_str(), "rb");
+	if (!file)
+		return 0;
+
+	std::vector<LogRecord<T>> buffer(4096);
+	uint64_t validBytes = 0;
+	uint64_t previousPosition = 0;
+	bool isValid = true;
+
+	while (isValid)
+	{
+		size_t recordsRead = fread(buffer.data(), sizeof(LogRecord<T>), buffer.size(), file);
+		if (recordsRead == 0)
+			break;
+
+		for (size_t i = 0; i < recordsRead && isValid; i++)
+		{
+			const LogRecord<T>& record = buffer[i];
+
+			//Stops at the first record that was torn or is out of order
+			isValid = record.checksum == checksum(record) && record.position > previousPosition &&
+				(record.operation == INSERT || record.operation == REMOVE);
+			if (!isValid)
+				break;
+
+			//Changes already in the snapshot are skipped
+			if (record.position > snapshotPosition)
+			{
+				if (record.operation == INSERT)
+					replayInsert(tree, record.value, 0);
+				else
+					replayRemove(tree, record.value, 0);
+			}
+
+			if (record.position > m_position)
+				m_position = record.position;
+			previousPosition = record.position;
+			validBytes += sizeof(LogRecord<T>);
+		}
+	}
+
+	fclose(file);
+	return validBytes;
+}
+
+template<typename T>
+inline uint32_t WriteAheadLog<T>::checksum(LogRecord<T> record)
+{
+	record.checksum = 0;
+
+	//FNV-1a over every byte of the record
+	const unsigned char* bytes = (const unsigned char*)&record;
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(record); i++)
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+template<typename T>
+inline bool WriteAheadLog<T>::syncFile(FILE* file)
+{
+	if (fflush(file) != 0)
+		return false;
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+template<typename T>
+inline bool WriteAheadLog<T>::syncDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	//A directory can't be flushed through the C runtime, and NTFS journals the rename itself
+	(void)path;
+	return true;
+#else
+	std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	if (directory.empty())
+		directory = ".";
+
+	int directoryFile = ::open(directory.c_str(), O_RDONLY);
+	if (directoryFile < 0)
+		return false;
+	bool succeeded = fsync(directoryFile) == 0;
+	succeeded = ::close(directoryFile) == 0 && succeeded;
+	return succeeded;
+#endif
+}
@@ -5,6 +5,7 @@
 #include "raygui.h"
 #include "BinaryTree.h"
 #include "TreeNode.h"
+#include "TreeVisualizer.h"
 
 int main(int argc, char* argv[])
 {
@@ -19,7 +20,7 @@ int main(int argc, char* argv[])
     //--------------------------------------------------------------------------------------
 
     //initialize binary tree
-    BinaryTree<int> binaryTree = BinaryTree<int>();
+    BinaryTree<int> binaryTree;
     TreeNode<int>* selectedNode = nullptr;
     int valueBoxValue = 0;
     bool valueBoxEditMode = false;
@@ -51,7 +52,7 @@ int main(int argc, char* argv[])
         }
 
         // draw the binary tree
-        binaryTree.draw(selectedNode);
+        TreeVisualizer<int>::draw(binaryTree, selectedNode);
         EndDrawing();
         //----------------------------------------------------------------------------------
     }
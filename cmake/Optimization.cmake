@@ -0,0 +1,49 @@
+#Build settings for measuring performance. They apply to every target, so the library's headers are
+#optimised the same way in whichever program includes them
+
+#Profilers need frame pointers to walk the stack without debug information, which RelWithDebInfo exists for
+if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+	add_compile_options($<$<CONFIG:RelWithDebInfo>:-fno-omit-frame-pointer>)
+endif()
+
+if(BINARYTREE_ENABLE_LTO)
+	include(CheckIPOSupported)
+	check_ipo_supported(RESULT isLtoSupported OUTPUT ltoOutput LANGUAGES CXX)
+	if(isLtoSupported)
+		set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+		message(STATUS "Link time optimisation is on")
+	else()
+		message(WARNING "Link time optimisation isn't supported by this compiler: ${ltoOutput}")
+	endif()
+endif()
+
+#A profile guided build takes two configures: GENERATE, then running the instrumented programs on a
+#representative workload, then USE in the same build directory so the profiles match the objects
+if(BINARYTREE_PGO STREQUAL "GENERATE")
+	if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+		file(MAKE_DIRECTORY "${BINARYTREE_PGO_DIR}")
+		add_compile_options(-fprofile-generate=${BINARYTREE_PGO_DIR})
+		add_link_options(-fprofile-generate=${BINARYTREE_PGO_DIR})
+		message(STATUS "Instrumented binaries will write profiles to ${BINARYTREE_PGO_DIR}")
+	else()
+		message(WARNING "Profile guided optimisation is only set up for GCC and Clang")
+	endif()
+elseif(BINARYTREE_PGO STREQUAL "USE")
+	if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+		#Profiles from a workload that skipped some functions shouldn't be treated as errors
+		add_compile_options(-fprofile-use=${BINARYTREE_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+		add_link_options(-fprofile-use=${BINARYTREE_PGO_DIR})
+	elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+		#Clang writes raw profiles, which have to be merged with llvm-profdata into default.profdata first
+		set(profileData "${BINARYTREE_PGO_DIR}/default.profdata")
+		if(NOT EXISTS "${profileData}")
+			message(FATAL_ERROR "Merge the raw profiles first: llvm-profdata merge -o ${profileData} ${BINARYTREE_PGO_DIR}/*.profraw")
+		endif()
+		add_compile_options(-fprofile-use=${profileData} -Wno-profile-instr-unprofiled)
+		add_link_options(-fprofile-use=${profileData})
+	else()
+		message(WARNING "Profile guided optimisation is only set up for GCC and Clang")
+	endif()
+elseif(NOT BINARYTREE_PGO STREQUAL "OFF")
+	message(FATAL_ERROR "BINARYTREE_PGO must be OFF, GENERATE or USE, not ${BINARYTREE_PGO}")
+endif()